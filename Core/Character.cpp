@@ -100,6 +100,8 @@ void Character::setState(ReducedCharacterStateArray* state, int start, bool hack
 	root->state.orientation = rs.getOrientation();
 	root->state.velocity = rs.getVelocity();
 	root->state.angularVelocity = rs.getAngularVelocity();
+	//the other bodies are marked as modified when their joint constraints are fixed below
+	root->state.markModified();
 
 	//now each joint introduces one more rigid body, so we'll only record its state relative to its parent.
 	//we are assuming here that each joint is revolute!!!
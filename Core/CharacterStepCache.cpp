@@ -0,0 +1,73 @@
+#include "CharacterStepCache.h"
+
+CharacterStepCache::CharacterStepCache(Character* ch){
+	character = ch;
+	valid = false;
+	jointsValid = false;
+	footForceContacts = NULL;
+}
+
+CharacterStepCache::~CharacterStepCache(void){
+}
+
+/**
+	This method is used to compute the heading and the COM position and velocity from the current state of the character. The foot forces
+	are computed on demand.
+*/
+void CharacterStepCache::refresh(){
+	heading = character->getHeading();
+	com = character->getCOM();
+	comVelocity = character->getCOMVelocity();
+
+	footForceContacts = NULL;
+	feet.clear();
+	footForces.clear();
+
+	valid = true;
+}
+
+/**
+	This method is used to compute the relative orientations and angular velocities of the joints from the current state of the character.
+*/
+void CharacterStepCache::refreshJoints(){
+	int jointCount = character->getJointCount();
+	jointQRel.resize(jointCount);
+	jointWRel.resize(jointCount);
+	for (int i=0;i<jointCount;i++){
+		character->getRelativeOrientation(i, &jointQRel[i]);
+		character->getRelativeAngularVelocity(i, &jointWRel[i]);
+	}
+
+	jointsValid = true;
+}
+
+/**
+	This method is used to look up the net ground force on the foot (and its toes), as computed from the contacts cfs. It returns false
+	if that force is not known yet, in which case it should be computed and stored with setForceOnFoot.
+*/
+bool CharacterStepCache::getForceOnFoot(RigidBody* foot, DynamicArray<ContactPoint>* cfs, Vector3d* force) const {
+	if (!valid || cfs != footForceContacts)
+		return false;
+	for (uint i=0;i<feet.size();i++){
+		if (feet[i] == foot){
+			*force = footForces[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+	This method is used to store the net ground force on the foot (and its toes), as computed from the contacts cfs.
+*/
+void CharacterStepCache::setForceOnFoot(RigidBody* foot, DynamicArray<ContactPoint>* cfs, const Vector3d& force){
+	if (!valid)
+		return;
+	if (cfs != footForceContacts){
+		footForceContacts = cfs;
+		feet.clear();
+		footForces.clear();
+	}
+	feet.push_back(foot);
+	footForces.push_back(force);
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Utils/Utils.h>
+#include <MathLib/Vector3d.h>
+#include <MathLib/Point3d.h>
+#include <MathLib/Quaternion.h>
+#include <Physics/ContactPoint.h>
+#include "Character.h"
+
+/**
+	This class is used to share the quantities that are derived from the state of a character between all the controllers that act on it
+	during the same step: the heading, the COM position and velocity, the relative orientations and angular velocities of the joints, and
+	the net ground forces on the feet. A CompositeController refreshes it before it runs its controllers, so that these are computed once
+	per step rather than once per controller, and invalidates it afterwards, so that a controller that is used on its own outside of the
+	composite never reads stale values. The joints are only needed to compute the torques, so they are refreshed separately from the rest.
+*/
+class CharacterStepCache{
+private:
+	//this is the character the quantities are computed for
+	Character* character;
+	//this is true between a refresh and the following invalidate
+	bool valid;
+	//and this is true between a refresh of the joints and the following invalidate
+	bool jointsValid;
+
+	Quaternion heading;
+	Vector3d com;
+	Vector3d comVelocity;
+
+	//the relative orientation of each joint, and its relative angular velocity, in parent coordinates
+	DynamicArray<Quaternion> jointQRel;
+	DynamicArray<Vector3d> jointWRel;
+
+	//the net ground force on the feet that were asked for so far, and the list of contacts they were computed from
+	DynamicArray<ContactPoint>* footForceContacts;
+	DynamicArray<RigidBody*> feet;
+	DynamicArray<Vector3d> footForces;
+
+public:
+	CharacterStepCache(Character* ch);
+	~CharacterStepCache(void);
+
+	/**
+		This method is used to compute the heading and the COM position and velocity from the current state of the character. The foot
+		forces are computed on demand.
+	*/
+	void refresh();
+
+	/**
+		This method is used to compute the relative orientations and angular velocities of the joints from the current state of the character.
+	*/
+	void refreshJoints();
+
+	/**
+		This method is used to mark the cached quantities as out of date, until the next refresh.
+	*/
+	inline void invalidate(){
+		valid = false;
+		jointsValid = false;
+	}
+
+	inline bool isValid() const {
+		return valid;
+	}
+
+	inline bool areJointsValid() const {
+		return jointsValid;
+	}
+
+	/**
+		These methods return the cached quantities. They can only be used when the cache is valid, and the joints when they are valid.
+	*/
+	inline const Quaternion& getHeading() const {
+		return heading;
+	}
+
+	inline Vector3d getCOM() const {
+		return com;
+	}
+
+	inline const Vector3d& getCOMVelocity() const {
+		return comVelocity;
+	}
+
+	inline const Quaternion& getRelativeOrientation(int jIndex) const {
+		return jointQRel[jIndex];
+	}
+
+	inline const Vector3d& getRelativeAngularVelocity(int jIndex) const {
+		return jointWRel[jIndex];
+	}
+
+	/**
+		This method is used to look up the net ground force on the foot (and its toes), as computed from the contacts cfs. It returns false
+		if that force is not known yet, in which case it should be computed and stored with setForceOnFoot.
+	*/
+	bool getForceOnFoot(RigidBody* foot, DynamicArray<ContactPoint>* cfs, Vector3d* force) const;
+
+	/**
+		This method is used to store the net ground force on the foot (and its toes), as computed from the contacts cfs.
+	*/
+	void setForceOnFoot(RigidBody* foot, DynamicArray<ContactPoint>* cfs, const Vector3d& force);
+};
+
+/**
+	This class invalidates a step cache when it goes out of scope, so that the cache does not stay valid when a controller throws an error.
+*/
+class CharacterStepCacheScope{
+private:
+	CharacterStepCache* cache;
+public:
+	CharacterStepCacheScope(CharacterStepCache* cache){
+		this->cache = cache;
+	}
+
+	~CharacterStepCacheScope(void){
+		cache->invalidate();
+	}
+};
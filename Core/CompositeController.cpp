@@ -2,7 +2,7 @@
 #include <Core/ConUtils.h>
 #include <Core/SimBiController.h>
 
-CompositeController::CompositeController(Character* ch, char* input) : Controller(ch){
+CompositeController::CompositeController(Character* ch, char* input) : Controller(ch), stepCache(ch){
 
 	synchronizeControllers = false;
 	//create space for the torques we will be using...
@@ -34,6 +34,7 @@ CompositeController::CompositeController(Character* ch, char* input) : Controlle
 				//add a new controller
 				con = new SimBiController(character);
 				con->loadFromFile(trim(line));
+				con->setStepCache(&stepCache);
 				controllers.push_back(con);
 				break;
 			case CON_NOT_IMPORTANT:
@@ -69,6 +70,9 @@ CompositeController::CompositeController(Character* ch, char* input) : Controlle
 }
 
 CompositeController::~CompositeController(void){
+	//the controllers may outlive the collection, but the cache does not
+	for (uint i=0;i<controllers.size();i++)
+		controllers[i]->setStepCache(NULL);
 }
 
 /**
@@ -91,6 +95,11 @@ void CompositeController::computeTorques(DynamicArray<ContactPoint> *cfs){
 	if (primaryController == NULL)
 		throwError("A primary controller needs to always be selected for a composite controller!");
 
+	//the state of the character is computed once, for both controllers. The cache is invalidated however this method is left
+	stepCache.refresh();
+	stepCache.refreshJoints();
+	CharacterStepCacheScope cacheScope(&stepCache);
+
 	//but it shouldn't be a big deal if the secondary one is not chosen
 	if (secondaryController == NULL || synchronizeControllers == false){
 		//if we don't synchronize the controllers, then we won't interpolate either, since it doesn't make sense to interpolate between
@@ -152,20 +161,28 @@ int CompositeController::advanceInTime(double dt, DynamicArray<ContactPoint> *cf
 	//If the primary decides that it should switch to the next state, then we will force all the other controllers switch to the next state as well. 
 	//Otherwise, we will just update their phi's so that they are all in phase
 
+	//the world has moved since the torques were computed, so the state of the character is computed again, once for all the controllers.
+	//Only the heading and the COM are needed here, not the joints
+	stepCache.refresh();
+	CharacterStepCacheScope cacheScope(&stepCache);
+
 	int stateIndex;
 	//advance in time the main controller, and see if it decides it should switch stance/FSM state
 	bool newFSMState = ((stateIndex = primaryController->advanceInTime(primaryController->states[primaryController->FSMStateIndex]->stateTime * dtOverT, cfs)) != -1);
+	bool bodyTouchedTheGround = primaryController->isBodyInContactWithTheGround();
 	
 	//now take care of all the other controllers
 	for (uint i=0; i<controllers.size();i++){
-		controllers[i]->updateDAndV();
+		//the controllers that are not used only need their phase and stance bookkeeping - d and v are updated when they compute torques
+		if (isControllerActive(i))
+			controllers[i]->updateDAndV();
 		//make sure we skip the controller that we just advanced in time above
 		if (controllers[i] == primaryController)
 			continue;
 
 		//even if we're not synchronizing the FSMState/phi of the controllers, we will still make sure that the stance/groundContact is the same
 		//for all the controllers
-		controllers[i]->bodyTouchedTheGround = primaryController->isBodyInContactWithTheGround();
+		controllers[i]->bodyTouchedTheGround = bodyTouchedTheGround;
 		if (synchronizeControllers == false){
 			controllers[i]->setStance(primaryController->stance);
 			continue;
@@ -211,3 +228,34 @@ void CompositeController::setControllerState(const CompositeControllerState &cs)
 		controllers[i]->setControllerState(cs.controllerStates[i]);
 }
 
+/**
+	This method is used to append the state of the controller, and of all the controllers in the collection, to the binary buffer.
+*/
+void CompositeController::saveState(BinaryBuffer* buffer){
+	Controller::saveState(buffer);
+	buffer->writeInt(primaryControllerIndex);
+	buffer->writeInt(secondaryControllerIndex);
+	buffer->writeValue(interpValue);
+	buffer->writeValue(synchronizeControllers);
+
+	buffer->writeInt(controllers.size());
+	for (uint i=0;i<controllers.size();i++)
+		controllers[i]->saveState(buffer);
+}
+
+/**
+	This method is used to restore the state of the controller, and of all the controllers in the collection, from the binary buffer.
+*/
+void CompositeController::restoreState(BinaryBuffer* buffer){
+	Controller::restoreState(buffer);
+	primaryControllerIndex = buffer->readInt();
+	secondaryControllerIndex = buffer->readInt();
+	buffer->readValue(&interpValue);
+	buffer->readValue(&synchronizeControllers);
+
+	if (buffer->readInt() != (int)controllers.size())
+		throwError("The saved state does not match the number of controllers in the collection.");
+	for (uint i=0;i<controllers.size();i++)
+		controllers[i]->restoreState(buffer);
+}
+
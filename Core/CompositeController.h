@@ -1,6 +1,7 @@
 #pragma once
 #include <Core/Controller.h>
 #include <Core/SimBiController.h>
+#include <Core/CharacterStepCache.h>
 #include <Physics/ContactPoint.h>
 
 
@@ -48,6 +49,17 @@ protected:
 	double interpValue;
 	//if this variable is set to true, then all the controllers in the collection will be synchronized (in terms of stance, phase, and FSM state switches).
 	bool synchronizeControllers;
+	//this is where the controllers in the collection read the state of the character from, so that it is only computed once per step
+	CharacterStepCache stepCache;
+
+	/**
+		This method returns true if the ith controller is the primary one, or the secondary one when its torques are blended in.
+	*/
+	inline bool isControllerActive(int i){
+		if (i == primaryControllerIndex)
+			return true;
+		return synchronizeControllers && i == secondaryControllerIndex;
+	}
 public:
 	//pass as a parameter the character that the torques will be applied to, and also the file that has the list of
 	//simbicon controllers to be used
@@ -68,7 +80,8 @@ public:
 	/**
 		This method is used to advance the controller in time. It takes in a list of the contact points, since they might be
 		used to determine when to transition to a new state. This method returns -1 if the controller does not advance to a new state,
-		or the index of the state that it transitions to otherwise.
+		or the index of the state that it transitions to otherwise. Only the active controllers have their d and v updated: the others
+		just follow the phase, FSM state and stance of the primary one, and update d and v the next time they compute torques.
 	*/
 	int advanceInTime(double dt, DynamicArray<ContactPoint> *cfs);
 
@@ -108,6 +121,16 @@ public:
 	*/
 	void setControllerState(const CompositeControllerState &cs);
 
+	/**
+		This method is used to append the state of the controller, and of all the controllers in the collection, to the binary buffer.
+	*/
+	virtual void saveState(BinaryBuffer* buffer);
+
+	/**
+		This method is used to restore the state of the controller, and of all the controllers in the collection, from the binary buffer.
+	*/
+	virtual void restoreState(BinaryBuffer* buffer);
+
 	/**
 		this method returns the phase of the locomotion cycle
 	*/
@@ -64,4 +64,28 @@ void Controller::resetTorques(){
 		torques[i] = Vector3d(0,0,0);
 }
 
+/**
+	This method is used to append the state of the controller to the binary buffer.
+*/
+void Controller::saveState(BinaryBuffer* buffer){
+	buffer->writeInt(torques.size());
+	for (uint i=0;i<torques.size();i++)
+		buffer->writeValue(torques[i]);
+	buffer->writeInt(oldTorques.size());
+	for (uint i=0;i<oldTorques.size();i++)
+		buffer->writeValue(oldTorques[i]);
+}
 
+/**
+	This method is used to restore the state of the controller from the binary buffer, reading from its current position.
+*/
+void Controller::restoreState(BinaryBuffer* buffer){
+	if (buffer->readInt() != (int)torques.size())
+		throwError("The saved controller state does not match the number of joints of the character.");
+	for (uint i=0;i<torques.size();i++)
+		buffer->readValue(&torques[i]);
+	//no old torques means that the torques were never applied
+	oldTorques.resize(buffer->readInt());
+	for (uint i=0;i<oldTorques.size();i++)
+		buffer->readValue(&oldTorques[i]);
+}
@@ -42,6 +42,13 @@ public:
 		return character;
 	}
 
+	/**
+		Returns the world that the controlled character lives in, or NULL if the character was not added to a world yet.
+	*/
+	World* getWorld() const {
+		return character->getWorld();
+	}
+
 	virtual void performPreTasks(double dt, DynamicArray<ContactPoint> *cfs) {
 		computeTorques(cfs);
 		applyTorques();
@@ -65,5 +72,16 @@ public:
 	*/
 	void resetTorques();
 
+	/**
+		This method is used to append the state of the controller to the binary buffer. The base class saves the torques, which
+		are needed to limit how fast the torques change at the next step. Controllers that have more state should extend this.
+	*/
+	virtual void saveState(BinaryBuffer* buffer);
+
+	/**
+		This method is used to restore the state of the controller from the binary buffer, reading from its current position.
+	*/
+	virtual void restoreState(BinaryBuffer* buffer);
+
 
 };
@@ -13,6 +13,7 @@
 #include "BalanceFeedback.h"
 #include "SimBiConState.h"
 #include "Controller.h"
+#include "PDTorqueBatch.h"
 #include "PoseController.h"
 #include "SimBiController.h"
 #include "IKVMCController.h"
@@ -21,6 +22,8 @@
 #include "TurnController.h"
 #include "DuckController.h"
 #include "TwoLinkIK.h"
+#include "RolloutBatch.h"
+#include "SimulationClock.h"
 %}
 
 // SWIG compiler does not support VC++ declspec
@@ -38,6 +41,9 @@
 
 %feature("director") Controller::performPreTasks;
 %feature("director") Controller::performPostTasks;
+%feature("director") RolloutFactory;
+// called concurrently from the threads of the pool, so it can only be overridden in C++
+%feature("nodirector") RolloutFactory::hasFailed;
 %apply SWIGTYPE *DISOWN { RigidBody* rigidBody_disown };
 %apply SWIGTYPE *DISOWN { ArticulatedFigure* articulatedFigure_disown };
 %apply SWIGTYPE *DISOWN { Character* character_disown };
@@ -57,6 +63,7 @@
 %include "BalanceFeedback.h"
 %include "SimBiConState.h"
 %include "Controller.h"
+%include "PDTorqueBatch.h"
 %include "PoseController.h"
 %include "SimBiController.h"
 %include "IKVMCController.h"
@@ -65,6 +72,8 @@
 %include "TurnController.h"
 %include "DuckController.h"
 %include "TwoLinkIK.h"
+%include "RolloutBatch.h"
+%include "SimulationClock.h"
 
 %inline %{
 #include <Core/CoreDll.h>
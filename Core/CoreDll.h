@@ -1,7 +1,11 @@
 #pragma once
 
 #ifndef CORE_DECLSPEC
-	#ifdef CORE_EXPORTS
+	#if defined(HEADLESS)
+		//the headless build links everything statically
+		#define CORE_DECLSPEC
+		#define CORE_TEMPLATE(x)
+	#elif defined(CORE_EXPORTS)
 		#define CORE_DECLSPEC    __declspec(dllexport) 
 		#define CORE_TEMPLATE(x) template class __declspec(dllexport) x;
 	#else
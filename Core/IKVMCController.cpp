@@ -12,6 +12,8 @@ IKVMCController::IKVMCController(Character* b) : SimBiController(b){
 	rKneeIndex = character->getJointIndex("rKnee");
 	lAnkleIndex = character->getJointIndex("lAnkle");
 	rAnkleIndex = character->getJointIndex("rAnkle");
+	lBackIndex = character->getJointIndex("pelvis_lowerback");
+	mBackIndex = character->getJointIndex("lowerback_torso");
 
 	velDSagittal = 0;
 	velDCoronal = 0;
@@ -263,11 +265,9 @@ void IKVMCController::computeLegTorques(int ankleIndex, int kneeIndex, int hipIn
 	//the torque on the stance hip is cancelled out, so pass it in as a torque that the root wants to see!
 	ffRootTorque -= r.crossProductWith(fA);
 
-	int lBackIndex = character->getJointIndex("pelvis_lowerback");
 	r.setToVectorBetween(character->joints[lBackIndex]->child->getWorldCoordinates(character->joints[lBackIndex]->cJPos), p);
 	torques[lBackIndex] += r.crossProductWith(fA) / 10;
 
-	int mBackIndex = character->getJointIndex("lowerback_torso");
 	r.setToVectorBetween(character->joints[mBackIndex]->child->getWorldCoordinates(character->joints[mBackIndex]->cJPos), p);
 	torques[mBackIndex] += r.crossProductWith(fA) / 10;
 }
@@ -276,9 +276,6 @@ void IKVMCController::COMJT(DynamicArray<ContactPoint> *cfs){
 	//applying a force at the COM induces the force f. The equivalent torques are given by the J' * f, where J' is
 	// dp/dq, where p is the COM.
 
-	int lBackIndex = character->getJointIndex("pelvis_lowerback");
-	int mBackIndex = character->getJointIndex("lowerback_torso");
-
 	double m = 0;
 	ArticulatedRigidBody* tibia = character->joints[stanceAnkleIndex]->parent;
 	ArticulatedRigidBody* femur = character->joints[stanceKneeIndex]->parent;
@@ -397,6 +394,19 @@ void IKVMCController::getForceInfoOn(RigidBody* rb, DynamicArray<ContactPoint> *
 	*heelForce = false;
 	*toeForce = false;
 	Point3d tmpP;
+
+	//the contact index of the world knows which contacts involve the foot, so the other ones don't need to be looked at
+	ContactIndex* index = getContactIndexFor(cfs);
+	if (index != NULL){
+		collectFootContacts(index, rb, cfs);
+		for (uint i=0;i<footContacts.size();i++){
+			tmpP = rb->getLocalCoordinates((*cfs)[footContacts[i]].cp);
+			if (tmpP.z < 0) *heelForce = true;
+			if (tmpP.z > 0) *toeForce = true;
+		}
+		return;
+	}
+
 	for (uint i=0;i<cfs->size();i++){
 		if (haveRelationBetween((*cfs)[i].rb1, rb) || haveRelationBetween((*cfs)[i].rb2, rb)){
 			tmpP = rb->getLocalCoordinates((*cfs)[i].cp);
@@ -57,6 +57,8 @@ private:
 	int swingKneeIndex;
 	Joint *swingKnee, *swingHip;
 	int lKneeIndex, rKneeIndex, lAnkleIndex, rAnkleIndex;
+	//the joints of the back, which get part of the virtual forces
+	int lBackIndex, mBackIndex;
 	//keep track of the stance ankle, stance knee and stance hip
 	int stanceAnkleIndex, stanceKneeIndex, swingAnkleIndex;
 	//this is a controller that we will be using to compute gravity-cancelling torques
@@ -0,0 +1,172 @@
+#include "PDTorqueBatch.h"
+#include "PoseController.h"
+#include <MathLib/MathLib.h>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PD_BATCH_SSE2
+#endif
+
+/**
+	The kernels are written once, for a lane type L that is either a double, or two doubles in an SSE2 register. These are the few
+	operations they need, for both types.
+*/
+static inline void load(const double* p, double& x) { x = *p; }
+static inline void store(double* p, double x) { *p = x; }
+static inline double add(double a, double b) { return a + b; }
+static inline double sub(double a, double b) { return a - b; }
+static inline double mul(double a, double b) { return a * b; }
+static inline double vmin(double a, double b) { return (a < b)?(a):(b); }
+static inline double vmax(double a, double b) { return (a > b)?(a):(b); }
+static inline void splat(double value, double& x) { x = value; }
+
+#ifdef PD_BATCH_SSE2
+static inline void load(const double* p, __m128d& x) { x = _mm_loadu_pd(p); }
+static inline void store(double* p, __m128d x) { _mm_storeu_pd(p, x); }
+static inline __m128d add(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+static inline __m128d sub(__m128d a, __m128d b) { return _mm_sub_pd(a, b); }
+static inline __m128d mul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+static inline __m128d vmin(__m128d a, __m128d b) { return _mm_min_pd(a, b); }
+static inline __m128d vmax(__m128d a, __m128d b) { return _mm_max_pd(a, b); }
+static inline void splat(double value, __m128d& x) { x = _mm_set1_pd(value); }
+#endif
+
+PDTorqueBatch::PDTorqueBatch(void){
+	count = 0;
+}
+
+PDTorqueBatch::~PDTorqueBatch(void){
+}
+
+/**
+	This method removes all the joints from the batch. The memory is kept, so that the batch can be filled again at every step.
+*/
+void PDTorqueBatch::clear(){
+	count = 0;
+	qs.clear(); qx.clear(); qy.clear(); qz.clear();
+	qds.clear(); qdx.clear(); qdy.clear(); qdz.clear();
+	dwx.clear(); dwy.clear(); dwz.clear();
+	kp.clear(); kd.clear(); strength.clear(); maxAbsTorque.clear();
+	scaleX.clear(); scaleY.clear(); scaleZ.clear();
+}
+
+/**
+	This method adds a joint to the batch, with the same parameters as PoseController::computePDTorque, and returns the index
+	its torque can be read back from once the batch is computed.
+*/
+int PDTorqueBatch::addJoint(const Quaternion& qRel, const Quaternion& qRelD, const Vector3d& wRel, const Vector3d& wRelD, const ControlParams& cParams){
+	qs.push_back(qRel.s); qx.push_back(qRel.v.x); qy.push_back(qRel.v.y); qz.push_back(qRel.v.z);
+	qds.push_back(qRelD.s); qdx.push_back(qRelD.v.x); qdy.push_back(qRelD.v.y); qdz.push_back(qRelD.v.z);
+	dwx.push_back(wRelD.x - wRel.x); dwy.push_back(wRelD.y - wRel.y); dwz.push_back(wRelD.z - wRel.z);
+	kp.push_back(cParams.kp); kd.push_back(cParams.kd); strength.push_back(cParams.strength); maxAbsTorque.push_back(cParams.maxAbsTorque);
+	scaleX.push_back(cParams.scale.x); scaleY.push_back(cParams.scale.y); scaleZ.push_back(cParams.scale.z);
+	return count++;
+}
+
+/**
+	This method computes qErr = qRel' * qRelD, the rotation from the desired child frame to the current one.
+*/
+template <class L> void PDTorqueBatch::computeErrorQuaternions(int i){
+	L s, x, y, z, ds, dx, dy, dz;
+	load(&qs[i], s); load(&qx[i], x); load(&qy[i], y); load(&qz[i], z);
+	load(&qds[i], ds); load(&qdx[i], dx); load(&qdy[i], dy); load(&qdz[i], dz);
+
+	//(s, -v) * (ds, dv) = (s*ds + v.dv, s*dv - ds*v - v x dv)
+	store(&es[i], add(add(mul(s, ds), mul(x, dx)), add(mul(y, dy), mul(z, dz))));
+	store(&ex[i], sub(sub(mul(s, dx), mul(ds, x)), sub(mul(y, dz), mul(z, dy))));
+	store(&ey[i], sub(sub(mul(s, dy), mul(ds, y)), sub(mul(z, dx), mul(x, dz))));
+	store(&ez[i], sub(sub(mul(s, dz), mul(ds, z)), sub(mul(x, dy), mul(y, dx))));
+}
+
+/**
+	This method adds the damping term to the proportional one, then scales and limits the torque in child coordinates, and finally
+	expresses it in parent coordinates. It is the same sequence of operations as computePDTorque and scaleAndLimitTorque, except that
+	the proportional term, which starts out in child coordinates, is never rotated to the parent frame and back.
+*/
+template <class L> void PDTorqueBatch::computeLimitedTorques(int i){
+	L s, x, y, z;
+	load(&qs[i], s); load(&qx[i], x); load(&qy[i], y); load(&qz[i], z);
+	L minusOne;
+	splat(-1, minusOne);
+
+	//the damping term, in parent coordinates
+	L ux, uy, uz, gain;
+	load(&kd[i], gain);
+	gain = mul(gain, minusOne);
+	load(&dwx[i], ux); load(&dwy[i], uy); load(&dwz[i], uz);
+	ux = mul(ux, gain); uy = mul(uy, gain); uz = mul(uz, gain);
+
+	//rotate it into child coordinates with qRel': t = u*s + u x v, and the result is v*(u.v) + t*s + t x v
+	L tx = add(mul(ux, s), sub(mul(uy, z), mul(uz, y)));
+	L ty = add(mul(uy, s), sub(mul(uz, x), mul(ux, z)));
+	L tz = add(mul(uz, s), sub(mul(ux, y), mul(uy, x)));
+	L dot = add(add(mul(ux, x), mul(uy, y)), mul(uz, z));
+	L cx = add(add(mul(x, dot), mul(tx, s)), sub(mul(ty, z), mul(tz, y)));
+	L cy = add(add(mul(y, dot), mul(ty, s)), sub(mul(tz, x), mul(tx, z)));
+	L cz = add(add(mul(z, dot), mul(tz, s)), sub(mul(tx, y), mul(ty, x)));
+
+	//the proportional term is qErr.v, scaled by the factor that was computed for it
+	L f, e;
+	load(&factor[i], f);
+	load(&ex[i], e); cx = add(cx, mul(e, f));
+	load(&ey[i], e); cy = add(cy, mul(e, f));
+	load(&ez[i], e); cz = add(cz, mul(e, f));
+
+	//apply the strength, scale the torque along the main axes, and limit it
+	L st, maxT, sc, lim;
+	load(&strength[i], st);
+	load(&maxAbsTorque[i], maxT);
+	load(&scaleX[i], sc); lim = mul(sc, maxT);
+	cx = vmin(vmax(mul(mul(cx, st), sc), mul(lim, minusOne)), lim);
+	load(&scaleY[i], sc); lim = mul(sc, maxT);
+	cy = vmin(vmax(mul(mul(cy, st), sc), mul(lim, minusOne)), lim);
+	load(&scaleZ[i], sc); lim = mul(sc, maxT);
+	cz = vmin(vmax(mul(mul(cz, st), sc), mul(lim, minusOne)), lim);
+
+	//and rotate it back into parent coordinates with qRel: t = c*s + v x c, and the result is v*(c.v) + t*s + v x t
+	tx = add(mul(cx, s), sub(mul(y, cz), mul(z, cy)));
+	ty = add(mul(cy, s), sub(mul(z, cx), mul(x, cz)));
+	tz = add(mul(cz, s), sub(mul(x, cy), mul(y, cx)));
+	dot = add(add(mul(cx, x), mul(cy, y)), mul(cz, z));
+	store(&torqueX[i], add(add(mul(x, dot), mul(tx, s)), sub(mul(y, tz), mul(z, ty))));
+	store(&torqueY[i], add(add(mul(y, dot), mul(ty, s)), sub(mul(z, tx), mul(x, tz))));
+	store(&torqueZ[i], add(add(mul(z, dot), mul(tz, s)), sub(mul(x, ty), mul(y, tx))));
+}
+
+/**
+	This method computes the torques of all the joints in the batch.
+*/
+void PDTorqueBatch::compute(){
+	if (count == 0)
+		return;
+	es.resize(count); ex.resize(count); ey.resize(count); ez.resize(count); factor.resize(count);
+	torqueX.resize(count); torqueY.resize(count); torqueZ.resize(count);
+
+	int i = 0;
+#ifdef PD_BATCH_SSE2
+	for (;i+1<count;i+=2)
+		computeErrorQuaternions<__m128d>(i);
+#endif
+	for (;i<count;i++)
+		computeErrorQuaternions<double>(i);
+
+	//qErr.v is the axis of rotation scaled by sin(theta), but we want it scaled by theta instead. There is no SSE2 version of asin, so this
+	//part is done one joint at a time. The sign of qErr.s takes care of q and -q representing the same orientation.
+	for (i=0;i<count;i++){
+		double sinTheta = sqrt(ex[i] * ex[i] + ey[i] * ey[i] + ez[i] * ez[i]);
+		if (sinTheta > 1)
+			sinTheta = 1;
+		if (IS_ZERO(sinTheta))
+			factor[i] = 0;
+		else
+			factor[i] = 1/sinTheta * 2 * asin(sinTheta) * (-kp[i]) * SGN(es[i]);
+	}
+
+	i = 0;
+#ifdef PD_BATCH_SSE2
+	for (;i+1<count;i+=2)
+		computeLimitedTorques<__m128d>(i);
+#endif
+	for (;i<count;i++)
+		computeLimitedTorques<double>(i);
+}
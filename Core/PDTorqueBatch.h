@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Utils/Utils.h>
+#include <MathLib/Vector3d.h>
+#include <MathLib/Quaternion.h>
+
+class ControlParams;
+
+/**
+	This class is used to compute the PD torques of many joints at once. The inputs of every joint (the current and desired relative
+	orientations, the relative angular velocities and the gains) are packed into one array per component, so that the PD law and the torque
+	limits can be applied to several joints at a time with SSE2. The joints do not need to belong to the same character: the controllers of
+	a crowd can all add their joints to the same batch, and compute them together.
+
+	The torques are the same as the ones PoseController::computePDTorque returns, up to round-off.
+*/
+class PDTorqueBatch{
+private:
+	//the number of joints in the batch
+	int count;
+
+	//the current relative orientation of the child in the parent frame, and its desired value
+	DynamicArray<double> qs, qx, qy, qz;
+	DynamicArray<double> qds, qdx, qdy, qdz;
+	//the desired relative angular velocity minus the current one, in parent coordinates
+	DynamicArray<double> dwx, dwy, dwz;
+	//the gains, the strength and the torque limits
+	DynamicArray<double> kp, kd, strength, maxAbsTorque;
+	DynamicArray<double> scaleX, scaleY, scaleZ;
+
+	//the rotation from the desired to the current child frame, and the factor its axis is scaled by to get the proportional torque
+	DynamicArray<double> es, ex, ey, ez, factor;
+	//and the results, in parent coordinates
+	DynamicArray<double> torqueX, torqueY, torqueZ;
+
+	/**
+		These are the two vectorizable parts of the PD law, for the joints i (and i+1, when L holds two values).
+	*/
+	template <class L> void computeErrorQuaternions(int i);
+	template <class L> void computeLimitedTorques(int i);
+
+public:
+	PDTorqueBatch(void);
+	~PDTorqueBatch(void);
+
+	/**
+		This method removes all the joints from the batch. The memory is kept, so that the batch can be filled again at every step.
+	*/
+	void clear();
+
+	/**
+		This method adds a joint to the batch, with the same parameters as PoseController::computePDTorque, and returns the index
+		its torque can be read back from once the batch is computed.
+	*/
+	int addJoint(const Quaternion& qRel, const Quaternion& qRelD, const Vector3d& wRel, const Vector3d& wRelD, const ControlParams& cParams);
+
+	/**
+		This method computes the torques of all the joints in the batch.
+	*/
+	void compute();
+
+	/**
+		Returns the torque of the ith joint of the batch, expressed in the coordinate frame of the parent.
+	*/
+	inline Vector3d getTorque(int i) const {
+		return Vector3d(torqueX[i], torqueY[i], torqueZ[i]);
+	}
+
+	/**
+		Returns the number of joints in the batch.
+	*/
+	inline int getJointCount() const {
+		return count;
+	}
+};
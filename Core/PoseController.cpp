@@ -4,6 +4,7 @@
 #include <Utils/Utils.h>
 
 PoseController::PoseController(Character* ch) : Controller(ch){
+	stepCache = NULL;
 
 	//copy the current state of the character into the desired pose - makes sure that it's the correct size
 	ch->getState(&desiredPose);
@@ -108,17 +109,33 @@ void PoseController::scaleAndLimitTorque(Vector3d* torque, ControlParams* cParam
 	This method is used to compute the torques that are to be applied at the next step.
 */
 void PoseController::computeTorques(DynamicArray<ContactPoint> *cfs){
-	Quaternion qRelD;
-	Vector3d relAngVelD;
-
-	Quaternion qRel;
-	Vector3d wRel;
+	pdBatch.clear();
+	addTorquesToPDBatch(&pdBatch);
+	pdBatch.compute();
+	readTorquesFromPDBatch(pdBatch);
+}
 
+/**
+	This method adds the controlled joints of the character to the batch that is passed in as a parameter. The controllers of many
+	characters can add their joints to the same batch, so that all their PD torques are computed at once.
+*/
+void PoseController::addTorquesToPDBatch(PDTorqueBatch* batch){
 	ReducedCharacterState rs(&desiredPose);
+	bool useCache = (stepCache != NULL && stepCache->areJointsValid());
 
+	pdBatchIndices.resize(jointCount);
 	for (int i=0;i<jointCount;i++){
+		pdBatchIndices[i] = -1;
 		if (controlParams[i].controlled == true){
 
+			//when the targets are expressed in the parent frame, the current relative orientation and angular velocity are the same
+			//for every controller of the character, so they can come from the cache
+			if (useCache && controlParams[i].relToFrame == false){
+				pdBatchIndices[i] = batch->addJoint(stepCache->getRelativeOrientation(i), rs.getJointRelativeOrientation(i), 
+													stepCache->getRelativeAngularVelocity(i), rs.getJointRelativeAngVelocity(i), controlParams[i]);
+				continue;
+			}
+
 			RigidBody* parentRB = character->getJoint(i)->getParent();
 			RigidBody* childRB = character->getJoint(i)->getChild();
 			Quaternion parentQworld = parentRB->getOrientation().getComplexConjugate();			
@@ -142,12 +159,11 @@ void PoseController::computeTorques(DynamicArray<ContactPoint> *cfs){
 
 			Quaternion parentQframe = parentQworld * frameQworld.getComplexConjugate();
 
-			torques[i] = computePDTorque(parentQframe * currentOrientationInFrame, 
-										 parentQframe * desiredOrientationInFrame, 
-										 parentQframe.rotate(currentRelativeAngularVelocityInFrame), 
-										 parentQframe.rotate(desiredRelativeAngularVelocityInFrame), 
-										 &controlParams[i]);
-			torques[i] = parentRB->getWorldCoordinates(torques[i]);
+			pdBatchIndices[i] = batch->addJoint(parentQframe * currentOrientationInFrame, 
+												parentQframe * desiredOrientationInFrame, 
+												parentQframe.rotate(currentRelativeAngularVelocityInFrame), 
+												parentQframe.rotate(desiredRelativeAngularVelocityInFrame), 
+												controlParams[i]);
 
 /*
 			if (controlParams[i].relToCharFrame == false){
@@ -165,11 +181,22 @@ void PoseController::computeTorques(DynamicArray<ContactPoint> *cfs){
 			}
 */
 
+		}
+	}
+}
+
+/**
+	This method reads the torques of the joints that were added to the batch back, and expresses them in world coordinates.
+*/
+void PoseController::readTorquesFromPDBatch(const PDTorqueBatch& batch){
+	for (int i=0;i<jointCount;i++){
+		if (pdBatchIndices[i] >= 0){
+			//the torque is expressed in parent coordinates, so we need to convert it to world coords now
+			torques[i] = character->getJoint(i)->getParent()->getWorldCoordinates(batch.getTorque(pdBatchIndices[i]));
 		}else{
 			torques[i].setValues(0,0,0);
-		} 
+		}
 	}
-
 }
 
 
@@ -3,6 +3,8 @@
 #include <Utils/Utils.h>
 #include <Core/Controller.h>
 #include "Character.h"
+#include "PDTorqueBatch.h"
+#include "CharacterStepCache.h"
 
 
 
@@ -137,6 +139,15 @@ protected:
 	//this is the array of joint properties used to specify the 
 	DynamicArray<ControlParams> controlParams;
 
+	//this is the batch the PD torques are computed in, when the controller is used on its own
+	PDTorqueBatch pdBatch;
+	//and this is the index of each joint in the batch it was last added to, or -1 if the joint is not controlled
+	DynamicArray<int> pdBatchIndices;
+
+	//if this is not NULL and it is valid, the quantities that are derived from the state of the character are read from it instead of
+	//being computed again. It is shared with the other controllers of a CompositeController, which owns it.
+	CharacterStepCache* stepCache;
+
 	/**
 		This method is used to parse the information passed in the string. This class knows how to read lines
 		that have the name of a joint, followed by a list of the pertinent parameters. If this assumption is not held,
@@ -181,6 +192,13 @@ public:
 		return controlParams.size();
 	}
 
+	/**
+		This method is used to set the cache that this controller reads the state of the character from. The cache is not owned by the controller.
+	*/
+	void setStepCache(CharacterStepCache* cache) {
+		stepCache = cache;
+	}
+
 	/**
 		This method is used to compute the torques, based on the current and desired poses
 	*/
@@ -193,6 +211,18 @@ public:
 	*/
 	static Vector3d computePDTorque(const Quaternion& qRel, const Quaternion& qRelD, const Vector3d& wRel, const Vector3d& wRelD, ControlParams* pdParams);
 
+	/**
+		This method adds the controlled joints of the character to the batch that is passed in as a parameter. The controllers of many
+		characters can add their joints to the same batch, so that all their PD torques are computed at once. Once the batch is computed,
+		readTorquesFromPDBatch must be called to get the torques back.
+	*/
+	void addTorquesToPDBatch(PDTorqueBatch* batch);
+
+	/**
+		This method reads the torques of the joints that were added to the batch back, and expresses them in world coordinates.
+	*/
+	void readTorquesFromPDBatch(const PDTorqueBatch& batch);
+
 	/**
 		This method is used to scale and apply joint limits to the torque that is passed in as a parameter. The orientation that transforms 
 		the torque from the coordinate frame that it is currently stored in, to the coordinate frame of the 'child' to which the torque is 
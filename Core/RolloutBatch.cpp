@@ -0,0 +1,169 @@
+#include "RolloutBatch.h"
+#include "SimGlobals.h"
+#include <Utils/ThreadPool.h>
+
+/**
+	This is the job that the thread pool runs - one item per rollout.
+*/
+class RolloutBatchJob : public ParallelJob {
+private:
+	RolloutBatch* batch;
+public:
+	RolloutBatchJob(RolloutBatch* batch){
+		this->batch = batch;
+	}
+
+	virtual void execute(int itemIndex, int workerIndex){
+		batch->simulateRollout(itemIndex);
+	}
+};
+
+/**
+	Constructor. The factory is not owned by the batch, it has to outlive it.
+*/
+RolloutBatch::RolloutBatch(RolloutFactory* factory, int rolloutCount){
+	if (factory == NULL)
+		throwError("A rollout batch needs a factory to create its rollouts.");
+	if (rolloutCount <= 0)
+		throwError("A rollout batch needs at least one rollout.");
+	this->factory = factory;
+	this->rolloutCount = rolloutCount;
+	this->horizon = 10;
+	this->dt = SimGlobals::dt;
+	this->stopOnFailure = true;
+	this->pool = NULL;
+	this->threadCount = 0;
+	this->engine = World::getDefaultEngine();
+
+	statuses.resize(rolloutCount, ROLLOUT_NOT_RUN);
+	stepCounts.resize(rolloutCount, 0);
+	transitionCounts.resize(rolloutCount, 0);
+	simulatedTimes.resize(rolloutCount, 0);
+	distancesTraveled.resize(rolloutCount, 0);
+}
+
+/**
+	Destructor
+*/
+RolloutBatch::~RolloutBatch(void){
+	destroyRollouts();
+	delete pool;
+}
+
+/**
+	This method is used to set the number of threads that the rollouts are simulated on. Use 0 for one thread per processor.
+*/
+void RolloutBatch::setThreadCount(int threadCount){
+	if (threadCount == this->threadCount)
+		return;
+	this->threadCount = threadCount;
+	//the pool will be created again, with the right number of threads, the next time the batch is run
+	delete pool;
+	pool = NULL;
+}
+
+/**
+	This method is used to delete the worlds and the controllers of the previous run.
+*/
+void RolloutBatch::destroyRollouts(){
+	//the controllers go first, since they refer to characters that are owned by the worlds
+	for (uint i=0;i<controllers.size();i++)
+		delete controllers[i];
+	controllers.clear();
+	for (uint i=0;i<worlds.size();i++)
+		delete worlds[i];
+	worlds.clear();
+}
+
+/**
+	This method is used to create the worlds and the controllers of all the rollouts, using the factory.
+*/
+void RolloutBatch::createRollouts(){
+	for (int i=0;i<rolloutCount;i++){
+		World* world = World::createWorld(engine);
+		worlds.push_back(world);
+		SimBiController* controller = factory->createRollout(i, world);
+		if (controller == NULL)
+			throwError("The rollout factory did not return a controller for rollout %d.", i);
+		controllers.push_back(controller);
+		if (controller->getWorld() != world)
+			throwError("The character of rollout %d was not loaded into the world of the rollout.", i);
+	}
+}
+
+/**
+	This method is used to simulate rollout i until it completes or fails. This is called from the threads of the pool.
+*/
+void RolloutBatch::simulateRollout(int i){
+	World* world = worlds[i];
+	SimBiController* controller = controllers[i];
+	DynamicArray<ContactPoint>* cfs = world->getContactForces();
+
+	int maxStepCount = (int)(horizon / dt + 0.5);
+	int stepCount = 0, transitionCount = 0;
+	int status = ROLLOUT_COMPLETED;
+
+	Vector3d startCOM = controller->getCharacter()->getCOM();
+	Vector3d endCOM = startCOM;
+
+	//the errors that are thrown while simulating can't make it back to the caller, so they are turned into a status instead
+	try{
+		for (stepCount=0;stepCount<maxStepCount;){
+			controller->performPreTasks(dt, cfs);
+			world->advanceInTime(dt);
+			if (controller->performPostTasks(dt, cfs))
+				transitionCount++;
+			stepCount++;
+
+			if (stopOnFailure && factory->hasFailed(i, controller)){
+				status = ROLLOUT_FAILED;
+				break;
+			}
+		}
+		endCOM = controller->getCharacter()->getCOM();
+	}catch(...){
+		status = ROLLOUT_ERROR;
+	}
+
+	//only the horizontal displacement counts
+	Vector3d displacement = endCOM - startCOM;
+	displacement.y = 0;
+
+	statuses[i] = status;
+	stepCounts[i] = stepCount;
+	transitionCounts[i] = transitionCount;
+	simulatedTimes[i] = stepCount * dt;
+	distancesTraveled[i] = displacement.length();
+}
+
+/**
+	This method is used to create all the rollouts and simulate them. The rollouts of the previous run, if any, are discarded first.
+*/
+void RolloutBatch::run(){
+	destroyRollouts();
+	for (int i=0;i<rolloutCount;i++){
+		statuses[i] = ROLLOUT_NOT_RUN;
+		stepCounts[i] = transitionCounts[i] = 0;
+		simulatedTimes[i] = distancesTraveled[i] = 0;
+	}
+
+	//the factory may call into Python, so the rollouts are all created from this thread before the workers get going
+	createRollouts();
+
+	if (pool == NULL)
+		pool = new ThreadPool(threadCount);
+
+	RolloutBatchJob job(this);
+	pool->run(rolloutCount, &job);
+}
+
+/**
+	Returns the number of rollouts that ended with the given status.
+*/
+int RolloutBatch::getStatusCount(int status){
+	int count = 0;
+	for (uint i=0;i<statuses.size();i++)
+		if (statuses[i] == status)
+			count++;
+	return count;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <Utils/Utils.h>
+#include <Physics/World.h>
+#include <Core/SimBiController.h>
+
+class ThreadPool;
+
+/**
+	A rollout factory is the template that a RolloutBatch is built from: it knows how to populate a fresh world with the environment
+	and the character, and how to create the controller that drives the character. The rollout index is passed in so that every
+	instance can be set up with its own parameters.
+*/
+class RolloutFactory {
+public:
+	RolloutFactory(void){}
+	virtual ~RolloutFactory(void){}
+
+	/**
+		This method is used to load the environment and the character of rollout rolloutIndex into the world that is passed in, and to
+		return the controller that acts on the character. It is always called from the thread that runs the batch, one rollout at a time.
+		The batch takes ownership of the controller - a controller that is created from Python must be disowned (controller.thisown = 0).
+		The controller itself is stepped on the threads of the pool, so it cannot be a Python controller.
+	*/
+	virtual SimBiController* createRollout(int rolloutIndex, World* world) = 0;
+
+	/**
+		This method is used to decide if rollout rolloutIndex has failed, in which case it is stopped early. By default, a rollout fails
+		as soon as the body of the character touches the ground. This is called concurrently from the threads of the pool.
+	*/
+	virtual bool hasFailed(int rolloutIndex, SimBiController* controller){
+		return controller->isBodyInContactWithTheGround();
+	}
+};
+
+/*-------------------------------------------------------------------------------------------------------------------------------------------*
+ * This class is used to simulate many instances of the same setup at once, for instance to evaluate a number of variations of a         *
+ * controller. Each rollout lives in its own World, and the rollouts are stepped in parallel on a work-stealing thread pool, either        *
+ * for a fixed horizon or until they fail. The results are stored in compact arrays, with one entry per rollout.                           *
+ *                                                                                                                                         *
+ * ODE shares the colliders of its triangle meshes (TriMeshCDP) between all the worlds, so the collisions against triangle meshes are      *
+ * serialized by ODEWorld, and do not scale with the number of threads. The rest of the simulation runs fully in parallel.                 *
+ *-------------------------------------------------------------------------------------------------------------------------------------------*/
+class RolloutBatch {
+friend class RolloutBatchJob;
+public:
+	//these are the possible outcomes of a rollout
+	enum RolloutStatus {
+		ROLLOUT_NOT_RUN = 0,
+		ROLLOUT_COMPLETED,
+		ROLLOUT_FAILED,
+		ROLLOUT_ERROR
+	};
+
+private:
+	//this is the template the rollouts are created from - the batch does not own it
+	RolloutFactory* factory;
+	//the number of rollouts in the batch
+	int rolloutCount;
+	//the simulated time after which a rollout is considered completed
+	double horizon;
+	//the time step used to advance the simulation
+	double dt;
+	//if this is true, a rollout stops as soon as the factory reports that it has failed
+	bool stopOnFailure;
+	//the thread pool the rollouts are stepped on
+	ThreadPool* pool;
+	//the number of threads the pool is created with (0 means one per processor)
+	int threadCount;
+
+	//the physics engine the worlds of the rollouts are simulated with (one of the World::PhysicsEngine values)
+	int engine;
+	//the worlds and the controllers of the rollouts, one of each per rollout
+	DynamicArray<World*> worlds;
+	DynamicArray<SimBiController*> controllers;
+
+	//the metrics that are collected, one entry per rollout
+	DynamicArray<int> statuses;
+	DynamicArray<int> stepCounts;
+	DynamicArray<int> transitionCounts;
+	DynamicArray<double> simulatedTimes;
+	DynamicArray<double> distancesTraveled;
+
+	/**
+		This method is used to delete the worlds and the controllers of the previous run.
+	*/
+	void destroyRollouts();
+
+	/**
+		This method is used to create the worlds and the controllers of all the rollouts, using the factory.
+	*/
+	void createRollouts();
+
+	/**
+		This method is used to simulate rollout i until it completes or fails. This is called from the threads of the pool.
+	*/
+	void simulateRollout(int i);
+
+public:
+	/**
+		Constructor. The factory is not owned by the batch, it has to outlive it.
+	*/
+	RolloutBatch(RolloutFactory* factory, int rolloutCount);
+
+	/**
+		Destructor
+	*/
+	~RolloutBatch(void);
+
+	/**
+		This method is used to set the simulated time after which a rollout is considered completed.
+	*/
+	inline void setHorizon(double horizon){
+		this->horizon = horizon;
+	}
+
+	inline double getHorizon(){
+		return horizon;
+	}
+
+	/**
+		This method is used to set the time step of the simulation. By default, SimGlobals::dt is used.
+	*/
+	inline void setTimeStep(double dt){
+		this->dt = dt;
+	}
+
+	/**
+		This method is used to specify whether a rollout stops as soon as it fails, or keeps going until the horizon.
+	*/
+	inline void setStopOnFailure(bool stopOnFailure){
+		this->stopOnFailure = stopOnFailure;
+	}
+
+	/**
+		This method is used to set the number of threads that the rollouts are simulated on. Use 0 for one thread per processor.
+	*/
+	void setThreadCount(int threadCount);
+
+	/**
+		This method is used to select the physics engine (one of the World::PhysicsEngine values) that the worlds of the rollouts are created
+		with. By default, it is the engine of the default world (see World::setDefaultEngine). It takes effect the next time the batch is run.
+	*/
+	inline void setEngine(int engine){
+		this->engine = engine;
+	}
+
+	inline int getEngine(){
+		return engine;
+	}
+
+	/**
+		This method is used to create all the rollouts and simulate them. The rollouts of the previous run, if any, are discarded first.
+		It returns once all the rollouts have completed or failed.
+	*/
+	void run();
+
+	inline int getRolloutCount(){
+		return rolloutCount;
+	}
+
+	/**
+		Returns the world of rollout i, as it was at the end of the last run (NULL if the batch was not run yet).
+	*/
+	inline World* getWorld(int i){
+		if (i<0 || (uint)i>=worlds.size())
+			return NULL;
+		return worlds[i];
+	}
+
+	/**
+		Returns the controller of rollout i, as it was at the end of the last run (NULL if the batch was not run yet).
+	*/
+	inline SimBiController* getController(int i){
+		if (i<0 || (uint)i>=controllers.size())
+			return NULL;
+		return controllers[i];
+	}
+
+	/**
+		Returns the outcome of rollout i (one of the RolloutStatus values).
+	*/
+	inline int getStatus(int i){
+		return statuses[i];
+	}
+
+	/**
+		Returns the number of simulation steps that were taken by rollout i.
+	*/
+	inline int getStepCount(int i){
+		return stepCounts[i];
+	}
+
+	/**
+		Returns the number of FSM state transitions (i.e. steps taken by the character) of rollout i.
+	*/
+	inline int getTransitionCount(int i){
+		return transitionCounts[i];
+	}
+
+	/**
+		Returns the amount of time that rollout i was simulated for.
+	*/
+	inline double getSimulatedTime(int i){
+		return simulatedTimes[i];
+	}
+
+	/**
+		Returns the horizontal distance between the initial and the final center of mass of the character of rollout i.
+	*/
+	inline double getDistanceTraveled(int i){
+		return distancesTraveled[i];
+	}
+
+	/**
+		These methods return the metrics of all the rollouts at once.
+	*/
+	inline DynamicArray<double>* getSimulatedTimes(){
+		return &simulatedTimes;
+	}
+
+	inline DynamicArray<double>* getDistancesTraveled(){
+		return &distancesTraveled;
+	}
+
+	/**
+		Returns the number of rollouts that ended with the given status.
+	*/
+	int getStatusCount(int status);
+};
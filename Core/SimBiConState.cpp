@@ -72,6 +72,7 @@ void TrajectoryComponent::updateComponent(SimBiController* con, Joint* j, Trajec
 	}
 	result.simplify_catmull_rom( 0.005 );
 	baseTraj.copy( result );
+	baseTable.bake( baseTraj, SimGlobals::trajectoryTableResolution );
 }
 
 
@@ -159,6 +160,7 @@ void TrajectoryComponent::readTrajectoryComponent(FILE* f){
 		switch (lineType) {
 			case CON_TRAJ_COMPONENT_END:
 				//we're done...
+				bakeTrajectories();
 				return;
 				break;
 			case CON_COMMENT:
@@ -277,7 +279,8 @@ void Trajectory::readTrajectory(FILE* f){
 				SimBiConState::readTrajectory1d(f, strengthTraj, CON_STRENGTH_TRAJECTORY_END );
 				break;
 			case CON_TRAJECTORY_END:
-				//we're done...
+				//we're done... the components were baked as they were read
+				strengthTable.bake( strengthTraj, SimGlobals::trajectoryTableResolution );
 				return;
 				break;
 			case CON_CHAR_FRAME_RELATIVE:
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <MathLib/Trajectory.h>
+#include <MathLib/BakedTrajectory.h>
 #include <Core/BalanceFeedback.h>
 #include <Utils/Utils.h>
 #include <MathLib/Vector3d.h>
@@ -68,6 +69,14 @@ public:
 	//this is the base value for the trajectory
 	double offset;
 
+private:
+	//the lookup tables the trajectories above are baked into
+	BakedTrajectory1d baseTable;
+	BakedTrajectory1d dScaleTable;
+	BakedTrajectory1d vScaleTable;
+
+public:
+
 	/**
 		Some public constants
 	*/
@@ -78,7 +87,7 @@ public:
 	/**
 		default constructor
 	*/
-	TrajectoryComponent(){
+	TrajectoryComponent() : dScaleTable(BakedTrajectory1d::LINEAR), vScaleTable(BakedTrajectory1d::LINEAR) {
 		rotationAxis = Vector3d();
 		reverseAngleOnLeftStance = false;
 		reverseAngleOnRightStance = false;
@@ -146,6 +155,7 @@ public:
 
 	inline void setBaseTrajectory( const Trajectory1d& traj ) {
 		baseTraj.copy( traj );
+		baseTable.bake( baseTraj, SimGlobals::trajectoryTableResolution );
 		notifyObservers();
 	}
 	inline const Trajectory1d& getBaseTrajectory() const {
@@ -154,6 +164,7 @@ public:
 
 	inline void setVTrajScale( const Trajectory1d& traj ) {
 		vTrajScale.copy( traj );
+		vScaleTable.bake( vTrajScale, SimGlobals::trajectoryTableResolution );
 		notifyObservers();
 	}
 	inline const Trajectory1d& getVTrajScale() const {
@@ -162,12 +173,23 @@ public:
 
 	inline void setDTrajScale( const Trajectory1d& traj ) {
 		dTrajScale.copy( traj );
+		dScaleTable.bake( dTrajScale, SimGlobals::trajectoryTableResolution );
 		notifyObservers();
 	}
 	inline const Trajectory1d& getDTrajScale() const {
 		return dTrajScale;
 	}
 
+	/**
+		This method is used to bake the trajectories of this component into lookup tables of SimGlobals::trajectoryTableResolution samples.
+		The setters above do it whenever they change a trajectory, and so does loading the component from a file.
+	*/
+	void bakeTrajectories(){
+		baseTable.bake( baseTraj, SimGlobals::trajectoryTableResolution );
+		dScaleTable.bake( dTrajScale, SimGlobals::trajectoryTableResolution );
+		vScaleTable.bake( vTrajScale, SimGlobals::trajectoryTableResolution );
+	}
+
 
 	/**
 		this method is used to evaluate the trajectory at a given point phi, knowing the stance of the character, 
@@ -179,17 +201,17 @@ public:
 		double scale = 1;
 		//this d.z should really be d dotted with some axis - probably the same as the feedback one...
 		if (dTrajScale.getKnotCount() > 0)
-			scale *= dTrajScale.evaluate_linear(d.z);
+			scale *= dScaleTable.evaluate(dTrajScale, d.z);
 
 		//this v.z should really be v dotted with some axis - probably the same as the feedback one...
 		if (vTrajScale.getKnotCount() > 0)
-			scale *= vTrajScale.evaluate_linear(v.z);
+			scale *= vScaleTable.evaluate(vTrajScale, v.z);
 
 		if (bareTrajectory == true)
 			scale = 1;
 
 		if (baseTraj.getKnotCount() > 0)
-			baseAngle += baseTraj.evaluate_catmull_rom(phi) * scale;
+			baseAngle += baseTable.evaluate(baseTraj, phi) * scale;
 
 		if (stance == LEFT_STANCE && reverseAngleOnLeftStance)
 			baseAngle = -baseAngle;
@@ -380,6 +402,12 @@ public:
 	//this is the trajectory for the strength of the joing.
 	Trajectory1d strengthTraj;
 
+private:
+	//the lookup table the strength trajectory is baked into
+	BakedTrajectory1d strengthTable;
+
+public:
+
 	/**
 		default constructor
 	*/
@@ -399,6 +427,7 @@ public:
 
 	inline void setStrengthTrajectory( const Trajectory1d& traj ) {
 		strengthTraj.copy( traj );
+		strengthTable.bake( strengthTraj, SimGlobals::trajectoryTableResolution );
 		notifyObservers();
 	}
 
@@ -455,7 +484,16 @@ public:
 	*/
 	inline double evaluateStrength(double phiToUse) {
 		if( strengthTraj.getKnotCount() == 0 ) return 1.0;
-		return strengthTraj.evaluate_catmull_rom( phiToUse );
+		return strengthTable.evaluate( strengthTraj, phiToUse );
+	}
+
+	/**
+		This method is used to bake the strength trajectory and the trajectories of all the components into lookup tables.
+	*/
+	void bakeTrajectories(){
+		strengthTable.bake( strengthTraj, SimGlobals::trajectoryTableResolution );
+		for (uint i=0;i<components.size();i++)
+			components[i]->bakeTrajectories();
 	}
 
 	/**
@@ -684,6 +722,15 @@ public:
 		return NULL;
 	}
 
+	/**
+		This method is used to bake all the trajectories of this state into lookup tables of SimGlobals::trajectoryTableResolution samples.
+		It only needs to be called when the resolution is changed after the state was loaded.
+	*/
+	void bakeTrajectories(){
+		for (uint i=0;i<sTraj.size();i++)
+			sTraj[i]->bakeTrajectories();
+	}
+
 	inline void setDTrajX( Trajectory1d* traj1d_disown ) {
 		if( dTrajX != NULL ) delete dTrajX;
 		dTrajX = traj1d_disown;
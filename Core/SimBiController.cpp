@@ -25,6 +25,7 @@
 #include <Utils/Utils.h>
 #include "SimGlobals.h"
 #include "ConUtils.h"
+#include <algorithm>
 
 SimBiController::SimBiController(Character* b) : PoseController(b){
 	if (b == NULL)
@@ -131,6 +132,42 @@ void SimBiController::setControllerState(const SimBiControllerState &cs){
 	this->bodyTouchedTheGround = cs.bodyGroundContact;
 }
 
+/**
+	This method is used to append the state of the controller to the binary buffer.
+*/
+void SimBiController::saveState(BinaryBuffer* buffer){
+	PoseController::saveState(buffer);
+	buffer->writeInt(stance);
+	buffer->writeValue(phi);
+	buffer->writeInt(FSMStateIndex);
+	buffer->writeValue(bodyTouchedTheGround);
+
+	buffer->writeValue(characterFrame);
+	buffer->writeValue(comPosition);
+	buffer->writeValue(comVelocity);
+	buffer->writeValue(d);
+	buffer->writeValue(v);
+	buffer->writeValue(doubleStanceCOMError);
+}
+
+/**
+	This method is used to restore the state of the controller from the binary buffer, reading from its current position.
+*/
+void SimBiController::restoreState(BinaryBuffer* buffer){
+	PoseController::restoreState(buffer);
+	setStance(buffer->readInt());
+	buffer->readValue(&phi);
+	FSMStateIndex = buffer->readInt();
+	buffer->readValue(&bodyTouchedTheGround);
+
+	buffer->readValue(&characterFrame);
+	buffer->readValue(&comPosition);
+	buffer->readValue(&comVelocity);
+	buffer->readValue(&d);
+	buffer->readValue(&v);
+	buffer->readValue(&doubleStanceCOMError);
+}
+
 /**
 	This method should be called when the controller transitions to this state.
 */
@@ -146,6 +183,13 @@ void SimBiController::transitionToState(int stateIndex){
 	This method returns the net force on the body rb, acting from the ground
 */
 Vector3d SimBiController::getForceOn(RigidBody* rb, DynamicArray<ContactPoint> *cfs){
+	//the index sums the forces in the same order as the loop below, so the results are the same
+	ContactIndex* index = getContactIndexFor(cfs);
+	if (index != NULL){
+		int i = index->getBodyIndex(rb);
+		return (i >= 0)?(index->getForce(i)):(Vector3d());
+	}
+
 	Vector3d fNet = Vector3d();
 	for (uint i=0;i<cfs->size();i++){
 		if ((*cfs)[i].rb1 == rb)
@@ -160,6 +204,60 @@ Vector3d SimBiController::getForceOn(RigidBody* rb, DynamicArray<ContactPoint> *
 
 
 
+/**
+	This method returns the contact index of the world of the character if it was built from the contact points that are passed in.
+*/
+ContactIndex* SimBiController::getContactIndexFor(DynamicArray<ContactPoint> *cfs){
+	World* world = getWorld();
+	if (world == NULL || !world->getContactIndex()->isBuiltFrom(cfs))
+		return NULL;
+	return world->getContactIndex();
+}
+
+/**
+	This method is used to collect the indices of the contact points of the foot and of its children (toes), in increasing order.
+*/
+void SimBiController::collectFootContacts(ContactIndex* index, RigidBody* foot, DynamicArray<ContactPoint> *cfs){
+	footContacts.clear();
+	ArticulatedRigidBody* arb = (ArticulatedRigidBody*)foot;
+	int partCount = 1 + arb->cJoints.size();
+	for (int p=0;p<partCount;p++){
+		RigidBody* part = (p == 0)?(foot):(arb->cJoints[p-1]->child);
+		int b = index->getBodyIndex(part);
+		if (b < 0)
+			continue;
+		for (int k=0;k<index->getContactCount(b);k++){
+			int c = index->getContact(b, k);
+			//a contact between two parts of the foot was already listed with the part that comes first
+			RigidBody* other = ((*cfs)[c].rb1 == part)?((*cfs)[c].rb2):((*cfs)[c].rb1);
+			bool listed = false;
+			for (int q=0;q<p && !listed;q++)
+				listed = (other == ((q == 0)?(foot):(arb->cJoints[q-1]->child)));
+			if (!listed)
+				footContacts.push_back(c);
+		}
+	}
+	//the contacts are processed in the order of the full list, so that the sums come out exactly the same
+	if (partCount > 1)
+		std::sort(footContacts.begin(), footContacts.end());
+}
+
+/**
+	This method returns true if any contact involves an articulated body, and neither of its bodies is a foot.
+*/
+bool SimBiController::checkBodyTouchedTheGround(DynamicArray<ContactPoint> *cfs){
+	//this asks about every articulated body of the world, not only the ones of the character, so the contact index doesn't help here
+	for (uint i=0;i<cfs->size();i++){
+		//if neither of the bodies involved are articulated, it means they are just props so we can ignore them
+		if ((*cfs)[i].rb1->isArticulated() == false && (*cfs)[i].rb2->isArticulated() == false)
+			continue;
+		if (isFoot((*cfs)[i].rb1) || isFoot((*cfs)[i].rb2))
+			continue;
+		return true;
+	}
+	return false;
+}
+
 /**
 	check to see if rb is the same as whichBody or any of its children
 */
@@ -227,12 +325,19 @@ bool SimBiController::isStanceFoot(RigidBody* rb){
 	This method returns the net force on the body rb, acting from the ground
 */
 Vector3d SimBiController::getForceOnFoot(RigidBody* foot, DynamicArray<ContactPoint> *cfs){
-	Vector3d fNet = getForceOn(foot, cfs);
+	Vector3d fNet;
+	if (stepCache != NULL && stepCache->getForceOnFoot(foot, cfs, &fNet))
+		return fNet;
+
+	fNet = getForceOn(foot, cfs);
 
 	//we will also look at all children of the foot that is passed in (to take care of toes).
 	for (uint i=0;i<((ArticulatedRigidBody*)foot)->cJoints.size();i++){
 		fNet += getForceOn(((ArticulatedRigidBody*)foot)->cJoints[i]->child, cfs);
 	}
+
+	if (stepCache != NULL)
+		stepCache->setForceOnFoot(foot, cfs, fNet);
 	return fNet;
 }
 
@@ -253,18 +358,8 @@ int SimBiController::advanceInTime(double dt, DynamicArray<ContactPoint> *cfs){
 		return -1;
 	}
 
-	bodyTouchedTheGround = false;
 	//see if anything else other than the feet touch the ground...
-	for (uint i=0;i<cfs->size();i++){
-		//if neither of the bodies involved are articulated, it means they are just props so we can ignore them
-		if ((*cfs)[i].rb1->isArticulated() == false && (*cfs)[i].rb2->isArticulated() == false)
-			continue;
-			
-		if (isFoot((*cfs)[i].rb1) || isFoot((*cfs)[i].rb2))
-			continue;
-
-		bodyTouchedTheGround = true;
-	}
+	bodyTouchedTheGround = checkBodyTouchedTheGround(cfs);
 
 	//advance the phase of the controller
 	this->phi += dt/states[FSMStateIndex]->getStateTime();
@@ -382,8 +477,13 @@ void SimBiController::updateTrackingPose(ReducedCharacterStateArray& trackingPos
 	This method is used to return a pointer to a rigid body, based on its name and the current stance of the character
 */
 RigidBody* SimBiController::getRBBySymbolicName(char* sName){
-	RigidBody* result;
-	char resolvedName[100];
+	return getRBBySymbolicHandle(getSymbolicNameHandle(sName));
+}
+
+/**
+	This method writes the name of the rigid body that the symbolic name stands for in the given stance to resolvedName.
+*/
+void SimBiController::resolveSymbolicName(const char* sName, int stance, char* resolvedName){
 	//deal with the SWING/STANCE_XXX' case
 	if (strncmp(sName , "SWING_", strlen("SWING_"))==0){
 		strcpy(resolvedName+1, sName + strlen("SWING_"));
@@ -400,17 +500,61 @@ RigidBody* SimBiController::getRBBySymbolicName(char* sName){
 				resolvedName[0] = 'r';
 	}else
 		strcpy(resolvedName, sName);
+}
 
-	result = character->getARBByName(resolvedName);
+/**
+	This method resolves the symbolic name of a rigid body (SWING_XXX, STANCE_XXX or a plain name) for both stances, and returns a handle
+	that getRBBySymbolicHandle turns into the rigid body for the current stance, without looking at the name again.
+*/
+int SimBiController::getSymbolicNameHandle(const char* sName){
+	int handle = symbolicNames.find(sName);
+	if (handle >= 0)
+		return handle;
 
-	if (result == NULL)
-		throwError("Could not find RB \'%s\\%s\'\n", resolvedName, sName);
+	char resolvedName[100];
+	resolveSymbolicName(sName, LEFT_STANCE, resolvedName);
+	leftStanceRBs.push_back(character->getARBByName(resolvedName));
+	resolveSymbolicName(sName, RIGHT_STANCE, resolvedName);
+	rightStanceRBs.push_back(character->getARBByName(resolvedName));
+	return symbolicNames.add(sName);
+}
 
-	return result;
+/**
+	This method returns the rigid body that the symbolic name with the given handle stands for in the current stance.
+*/
+RigidBody* SimBiController::getRBBySymbolicHandle(int handle){
+	if (handle < 0 || handle >= symbolicNames.getCount())
+		throwError("Invalid symbolic name handle: %d", handle);
 
+	RigidBody* result = (stance == LEFT_STANCE)?(leftStanceRBs[handle]):(rightStanceRBs[handle]);
+
+	if (result == NULL){
+		char resolvedName[100];
+		resolveSymbolicName(symbolicNames.getName(handle), stance, resolvedName);
+		throwError("Could not find RB \'%s\\%s\'\n", resolvedName, symbolicNames.getName(handle));
+	}
+
+	return result;
 }
 
 
+/**
+	This method is used to add the contact point to the toe or to the heel summary of the foot, depending on which half of the foot it is in.
+*/
+void SimBiController::addToeOrHeelContact(const ContactPoint& c, RigidBody* foot, Vector3d* toeForce, Point3d* toePos, int* toeCount, Vector3d* heelForce, Point3d* heelPos, int* heelCount){
+	//need to determine if this is a heel or the toe...
+	Point3d localPoint = foot->getLocalCoordinates(c.cp);
+	if (localPoint.z > 0){
+		*toeForce += c.f;
+		*toePos += c.cp;
+		(*toeCount)++;
+	}else{
+		*heelForce += c.f;
+		*heelPos += c.cp;
+		(*heelCount)++;
+	}
+}
+
 /**
 	This method is used to compute the distribution of forces between the two feet
 */
@@ -438,40 +582,29 @@ void SimBiController::computeToeAndHeelForces(DynamicArray<ContactPoint> *cfs){
 
 	int swingToeCount = 0, stanceToeCount = 0, swingHeelCount = 0, stanceHeelCount = 0;
 
-	for (uint i=0;i<cfs->size();i++){
-		if (isStanceFoot((*cfs)[i].rb1) || isStanceFoot((*cfs)[i].rb2)){
-			//need to determine if this is a heel or the toe...
-			Point3d localPoint = stanceFoot->getLocalCoordinates((*cfs)[i].cp);
-			if (localPoint.z > 0){
-				forceStanceToe += (*cfs)[i].f;
-				toeStancePos += (*cfs)[i].cp;
-				stanceToeCount++;
-				stanceToeInContact = true;
-			}else{
-				forceStanceHeel += (*cfs)[i].f;
-				heelStancePos += (*cfs)[i].cp;
-				stanceHeelCount++;
-				stanceHeelInContact = true;
-			}
-		}
-
-		if (isSwingFoot((*cfs)[i].rb1) || isSwingFoot((*cfs)[i].rb2)){
-			//need to determine if this is a heel or the toe...
-			Point3d localPoint = swingFoot->getLocalCoordinates((*cfs)[i].cp);
-			if (localPoint.z > 0){
-				forceSwingToe += (*cfs)[i].f;
-				toeSwingPos += (*cfs)[i].cp;
-				swingToeCount++;
-				swingToeInContact = true;
-			}else{
-				forceSwingHeel += (*cfs)[i].f;
-				heelSwingPos += (*cfs)[i].cp;
-				swingHeelCount++;
-				swingHeelInContact = true;
-			}
+	ContactIndex* index = getContactIndexFor(cfs);
+	if (index != NULL){
+		//only the contacts of the feet need to be looked at
+		collectFootContacts(index, stanceFoot, cfs);
+		for (uint i=0;i<footContacts.size();i++)
+			addToeOrHeelContact((*cfs)[footContacts[i]], stanceFoot, &forceStanceToe, &toeStancePos, &stanceToeCount, &forceStanceHeel, &heelStancePos, &stanceHeelCount);
+		collectFootContacts(index, swingFoot, cfs);
+		for (uint i=0;i<footContacts.size();i++)
+			addToeOrHeelContact((*cfs)[footContacts[i]], swingFoot, &forceSwingToe, &toeSwingPos, &swingToeCount, &forceSwingHeel, &heelSwingPos, &swingHeelCount);
+	}else{
+		for (uint i=0;i<cfs->size();i++){
+			if (isStanceFoot((*cfs)[i].rb1) || isStanceFoot((*cfs)[i].rb2))
+				addToeOrHeelContact((*cfs)[i], stanceFoot, &forceStanceToe, &toeStancePos, &stanceToeCount, &forceStanceHeel, &heelStancePos, &stanceHeelCount);
+			if (isSwingFoot((*cfs)[i].rb1) || isSwingFoot((*cfs)[i].rb2))
+				addToeOrHeelContact((*cfs)[i], swingFoot, &forceSwingToe, &toeSwingPos, &swingToeCount, &forceSwingHeel, &heelSwingPos, &swingHeelCount);
 		}
 	}
 
+	stanceToeInContact = stanceToeCount > 0;
+	stanceHeelInContact = stanceHeelCount > 0;
+	swingToeInContact = swingToeCount > 0;
+	swingHeelInContact = swingHeelCount > 0;
+
 	if (stanceToeCount > 0)
 		toeStancePos /= stanceToeCount;
 
@@ -518,7 +651,7 @@ void SimBiController::evaluateJointTargets(){
 	Vector3d force, torque;
 
 	// First compute external forces
-	characterFrame = character->getHeading();
+	characterFrame = (stepCache != NULL && stepCache->isValid())?(stepCache->getHeading()):(character->getHeading());
 	for (int i=0;i<curState->getExternalForceCount();i++){
 		ExternalForce* ef = curState->sExternalForces[i];
 		ArticulatedRigidBody* arb = ef->getARB(stance);
@@ -704,11 +837,17 @@ void SimBiController::computeHipTorques(const Quaternion& qRootD, double stanceH
 	This method is used to obtain the d and v parameters, using the current postural information of the biped
 */
 void SimBiController::updateDAndV(){
-	characterFrame = character->getHeading();
+	if (stepCache != NULL && stepCache->isValid()){
+		characterFrame = stepCache->getHeading();
+		comPosition = stepCache->getCOM();
+		comVelocity = stepCache->getCOMVelocity();
+	}else{
+		characterFrame = character->getHeading();
 
-	comPosition = character->getCOM();
+		comPosition = character->getCOM();
 
-	comVelocity = character->getCOMVelocity();
+		comVelocity = character->getCOMVelocity();
+	}
 
 	d = Vector3d(stanceFoot->getCMPosition(), comPosition);
 	//d is now in world coord frame, so we'll represent it in the 'character frame'
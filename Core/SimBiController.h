@@ -25,6 +25,7 @@
 
 #include "PoseController.h"
 #include <Utils/Utils.h>
+#include <Utils/NameIndex.h>
 #include <Physics/RigidBody.h>
 #include "SimBiConState.h"
 
@@ -143,6 +144,20 @@ protected:
 	bool haveToeAndHeelInformation;
 	void computeToeAndHeelForces(DynamicArray<ContactPoint> *cfs);
 
+	//this array is used to collect the contacts of one foot, from the contact index of the world - it keeps its memory from one step to the next
+	DynamicArray<int> footContacts;
+
+	//these are the symbolic names of rigid bodies (SWING_XXX, STANCE_XXX or plain names) that were resolved so far, and the rigid
+	//bodies they stand for in each stance
+	NameIndex symbolicNames;
+	DynamicArray<RigidBody*> leftStanceRBs;
+	DynamicArray<RigidBody*> rightStanceRBs;
+
+	/**
+		This method writes the name of the rigid body that the symbolic name stands for in the given stance to resolvedName.
+	*/
+	static void resolveSymbolicName(const char* sName, int stance, char* resolvedName);
+
 
 	//the phase parameter, phi must have values between 0 and 1, and it indicates the progress through the current state.
 	double phi;
@@ -179,6 +194,28 @@ protected:
 	*/
 	void transitionToState(int stateIndex);
 
+	/**
+		This method returns the contact index of the world of the character if it was built from the contact points that are passed in,
+		or NULL if it wasn't, in which case the contact points need to be scanned instead.
+	*/
+	ContactIndex* getContactIndexFor(DynamicArray<ContactPoint> *cfs);
+
+	/**
+		This method is used to collect, in the footContacts array, the indices of the contact points of the foot and of its children (toes),
+		in increasing order. Each contact point is only listed once.
+	*/
+	void collectFootContacts(ContactIndex* index, RigidBody* foot, DynamicArray<ContactPoint> *cfs);
+
+	/**
+		This method is used to add the contact point to the toe or to the heel summary of the foot, depending on which half of the foot it is in.
+	*/
+	void addToeOrHeelContact(const ContactPoint& c, RigidBody* foot, Vector3d* toeForce, Point3d* toePos, int* toeCount, Vector3d* heelForce, Point3d* heelPos, int* heelCount);
+
+	/**
+		This method returns true if any contact involves an articulated body, and neither of its bodies is a foot.
+	*/
+	bool checkBodyTouchedTheGround(DynamicArray<ContactPoint> *cfs);
+
 	/**
 		This method returns the net force on the body rb, acting from the ground
 	*/
@@ -236,6 +273,17 @@ protected:
 	RigidBody* getRBBySymbolicName(char* sName);
 
 public:
+	/**
+		This method resolves the symbolic name of a rigid body (SWING_XXX, STANCE_XXX or a plain name) for both stances, and returns a handle
+		that getRBBySymbolicHandle turns into the rigid body for the current stance, without looking at the name again.
+	*/
+	int getSymbolicNameHandle(const char* sName);
+
+	/**
+		This method returns the rigid body that the symbolic name with the given handle stands for in the current stance.
+	*/
+	RigidBody* getRBBySymbolicHandle(int handle);
+
 	//keep a copy of the initial character state, starting stance and file that contains the character's initial state
 	int startingState;
 	int startingStance;
@@ -329,6 +377,15 @@ public:
 		notifyObservers();
 	}
 
+	/**
+		This method bakes the trajectories of all the states into lookup tables again. It should be called after
+		SimGlobals::trajectoryTableResolution is changed, since the tables are otherwise only baked when the trajectories are set.
+	*/
+	void bakeTrajectories() {
+		for (uint i=0;i<states.size();i++)
+			states[i]->bakeTrajectories();
+	}
+
 	/**
 		This method is used to compute the torques that are to be applied at the next step.
 	*/
@@ -375,6 +432,17 @@ public:
 		structure
 	*/
 	void setControllerState(const SimBiControllerState &cs);
+
+	/**
+		This method is used to append the state of the controller to the binary buffer. On top of what SimBiControllerState holds,
+		the quantities that are computed at the end of a step and used at the beginning of the next one (d, v, etc) are saved as well.
+	*/
+	virtual void saveState(BinaryBuffer* buffer);
+
+	/**
+		This method is used to restore the state of the controller from the binary buffer, reading from its current position.
+	*/
+	virtual void restoreState(BinaryBuffer* buffer);
 	
 	/**
 		This method loads all the pertinent information regarding the simbicon controller from a file.
@@ -20,6 +20,7 @@ double SimGlobals::targetPosX = 0;
 double SimGlobals::targetPosZ = 0;
 
 int SimGlobals::constraintSoftness = 1;
+int SimGlobals::trajectoryTableResolution = 0;
 int SimGlobals::CGIterCount = 0;
 int SimGlobals::linearizationCount = 1;
 
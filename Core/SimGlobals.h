@@ -20,6 +20,7 @@ public:
 	//and this is the desired time interval for each simulation timestep (does not apply to animations that are played back).
 	static double dt;
 
+	//this is the world that is used by default by the controllers - the default world (World::instance()) unless specified otherwise
 	static World* activeRbEngine;
 
 	//temp..
@@ -32,6 +33,10 @@ public:
 
 	static int constraintSoftness;
 
+	//the number of samples the trajectories of the controller states are baked into (see BakedTrajectory1d). 0 means that the trajectories
+	//are evaluated directly. It is used when the states are loaded or edited, so it should be set before the controllers are loaded.
+	static int trajectoryTableResolution;
+
 	static int CGIterCount;
 	static int linearizationCount;
 
@@ -65,8 +70,12 @@ public:
 
 	inline static World* getRBEngine(){
 		if (activeRbEngine == NULL)
-			activeRbEngine = new ODEWorld();
+			activeRbEngine = &World::instance();
 		return activeRbEngine;
 	}
 
+	inline static void setRBEngine(World* world){
+		activeRbEngine = world;
+	}
+
 };
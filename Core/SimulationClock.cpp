@@ -0,0 +1,180 @@
+#include "SimulationClock.h"
+#include "SimGlobals.h"
+
+/**
+	Constructor. If no world is given, the active world of SimGlobals is used.
+*/
+SimulationClock::SimulationClock(World* world){
+	if (world == NULL)
+		world = SimGlobals::getRBEngine();
+	this->world = world;
+	this->dt = SimGlobals::dt;
+	this->accumulator = 0;
+	this->maxStepCount = 100;
+	this->lastStepCount = 0;
+	this->simulatedTime = 0;
+}
+
+/**
+	Destructor
+*/
+SimulationClock::~SimulationClock(void){
+}
+
+/**
+	This method is used to add a controller to the list of controllers that are run at every step.
+*/
+void SimulationClock::addController(Controller* controller){
+	if (controller == NULL)
+		throwError("Cannot add a NULL controller to a simulation clock.");
+	controllers.push_back(controller);
+	transitioned.push_back(0);
+}
+
+/**
+	This method is used to remove all the controllers from the clock.
+*/
+void SimulationClock::clearControllers(){
+	controllers.clear();
+	transitioned.clear();
+}
+
+/**
+	This method is used to set the fixed time step of the simulation.
+*/
+void SimulationClock::setTimeStep(double dt){
+	if (dt <= 0)
+		throwError("The time step of the simulation must be positive.");
+	if (dt == this->dt)
+		return;
+	this->dt = dt;
+	accumulator = 0;
+}
+
+/**
+	This method is used to remember where the rigid bodies are before a step is taken.
+*/
+void SimulationClock::savePreviousState(){
+	RBStateStore* store = world->getStateStore();
+	int n = store->getBodyCount() * RB_STATE_STORE_STRIDE;
+	previousPositions.resize(n);
+	previousOrientations.resize(n);
+	if (n > 0){
+		memcpy(&previousPositions[0], store->getPositionData(), store->getDataSize());
+		memcpy(&previousOrientations[0], store->getOrientationData(), store->getDataSize());
+	}
+}
+
+/**
+	This method is used to take exactly one step, regardless of the accumulator.
+*/
+void SimulationClock::step(){
+	savePreviousState();
+
+	DynamicArray<ContactPoint>* cfs = world->getContactForces();
+	for (uint i=0;i<controllers.size();i++)
+		controllers[i]->performPreTasks(dt, cfs);
+	world->advanceInTime(dt);
+	for (uint i=0;i<controllers.size();i++)
+		if (controllers[i]->performPostTasks(dt, cfs))
+			transitioned[i] = 1;
+
+	simulatedTime += dt;
+
+	RBStateStore* store = world->getStateStore();
+	steppedVersions.resize(store->getBodyCount());
+	for (int i=0;i<store->getBodyCount();i++)
+		steppedVersions[i] = store->getVersion(i);
+}
+
+/**
+	This method is used to advance the simulation by the given amount of time. Returns the number of fixed steps that were taken.
+*/
+int SimulationClock::advance(double interval){
+	for (uint i=0;i<transitioned.size();i++)
+		transitioned[i] = 0;
+
+	accumulator += interval;
+	lastStepCount = 0;
+	while (accumulator >= dt && lastStepCount < maxStepCount){
+		step();
+		accumulator -= dt;
+		lastStepCount++;
+	}
+	//we're too far behind - don't try to catch up
+	if (accumulator >= dt)
+		accumulator = 0;
+
+	return lastStepCount;
+}
+
+/**
+	This method is used to drop the time that was accumulated, and to forget the previous state of the bodies.
+*/
+void SimulationClock::reset(){
+	accumulator = 0;
+	previousPositions.clear();
+	previousOrientations.clear();
+	steppedVersions.clear();
+}
+
+/**
+	Returns true if the ith rigid body can be interpolated between the previous and the current state.
+*/
+bool SimulationClock::canInterpolate(int i, RBStateStore* store){
+	//the body was not there before the last step, or it was moved since
+	if ((uint)i >= steppedVersions.size() || (uint)((i+1) * RB_STATE_STORE_STRIDE) > previousPositions.size())
+		return false;
+	return store->getVersion(i) == steppedVersions[i];
+}
+
+/**
+	Returns the interpolated position of the ith rigid body, given the current states of the bodies.
+*/
+Point3d SimulationClock::getInterpolatedPosition(RBStateStore* store, int i){
+	Point3d current = store->getPosition(i);
+	if (!canInterpolate(i, store))
+		return current;
+	const double* p = &previousPositions[i * RB_STATE_STORE_STRIDE];
+	double t = getInterpolationFactor();
+	return Point3d(p[0] + (current.x - p[0]) * t, p[1] + (current.y - p[1]) * t, p[2] + (current.z - p[2]) * t);
+}
+
+/**
+	Returns the interpolated orientation of the ith rigid body, given the current states of the bodies.
+*/
+Quaternion SimulationClock::getInterpolatedOrientation(RBStateStore* store, int i){
+	Quaternion current = store->getOrientation(i);
+	if (!canInterpolate(i, store))
+		return current;
+	const double* q = &previousOrientations[i * RB_STATE_STORE_STRIDE];
+	return Quaternion(q[0], q[1], q[2], q[3]).sphericallyInterpolateWith(current, getInterpolationFactor());
+}
+
+/**
+	Returns the interpolated position of the ith rigid body of the world.
+*/
+Point3d SimulationClock::getInterpolatedPosition(int i){
+	return getInterpolatedPosition(world->getStateStore(), i);
+}
+
+/**
+	Returns the interpolated orientation of the ith rigid body of the world.
+*/
+Quaternion SimulationClock::getInterpolatedOrientation(int i){
+	return getInterpolatedOrientation(world->getStateStore(), i);
+}
+
+/**
+	This method is used to draw all the rigid bodies of the world at their interpolated positions.
+*/
+void SimulationClock::drawRBs(int flags){
+	if (flags & (SHOW_JOINTS | SHOW_ABSTRACT_VIEW_SKELETON)){
+		world->drawRBs(flags);
+		return;
+	}
+	//the states are copied once for all the bodies
+	RBStateStore* store = world->getStateStore();
+	for (int i=0;i<world->getRBCount();i++)
+		world->getRB(i)->drawAt(flags, getInterpolatedPosition(store, i), getInterpolatedOrientation(store, i));
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Utils/Utils.h>
+#include <Physics/World.h>
+#include <Core/Controller.h>
+
+/*-------------------------------------------------------------------------------------------------------------------------------------------*
+ * This class is used to advance a world, and the controllers that act on it, by arbitrary amounts of time while the simulation itself     *
+ * always takes steps of the same size. The time that is asked for is added to an accumulator, and as many fixed steps as fit into it are *
+ * taken, all in C++. What is left over is used to interpolate between the last two simulated states, so that the bodies can be drawn at  *
+ * the display rate without jittering, even though the simulation runs at a much higher (and unrelated) rate.                              *
+ *-------------------------------------------------------------------------------------------------------------------------------------------*/
+class SimulationClock {
+private:
+	//the world that is simulated
+	World* world;
+	//the controllers that are run at every step, in order
+	DynamicArray<Controller*> controllers;
+	//for every controller, this tells if it went through a transition during the last call to advance
+	DynamicArray<char> transitioned;
+
+	//the fixed time step of the simulation
+	double dt;
+	//the amount of time that was asked for, but not simulated yet - always less than dt after a call to advance
+	double accumulator;
+	//the upper limit on the number of steps that are taken by one call to advance
+	int maxStepCount;
+	//the number of steps that were taken by the last call to advance
+	int lastStepCount;
+	//the amount of time that was simulated since the clock was created
+	double simulatedTime;
+
+	//the positions and orientations of the rigid bodies before the last step, in the layout of the world's state store
+	DynamicArray<double> previousPositions;
+	DynamicArray<double> previousOrientations;
+	//the versions of the states of the rigid bodies right after the last step. A body that was moved from the outside since then
+	//is not interpolated, it is drawn where it is
+	DynamicArray<uint> steppedVersions;
+
+	/**
+		Returns true if the ith rigid body can be interpolated between the previous and the current state.
+	*/
+	bool canInterpolate(int i, RBStateStore* store);
+
+	/**
+		This method is used to remember where the rigid bodies are before a step is taken.
+	*/
+	void savePreviousState();
+
+	/**
+		These methods return the interpolated position and orientation of the ith rigid body, given the current states of the bodies.
+	*/
+	Point3d getInterpolatedPosition(RBStateStore* store, int i);
+	Quaternion getInterpolatedOrientation(RBStateStore* store, int i);
+
+public:
+	/**
+		Constructor. If no world is given, the active world of SimGlobals is used.
+	*/
+	SimulationClock(World* world = NULL);
+
+	/**
+		Destructor
+	*/
+	~SimulationClock(void);
+
+	/**
+		This method is used to add a controller to the list of controllers that are run at every step. The clock does not own it.
+	*/
+	void addController(Controller* controller);
+
+	/**
+		This method is used to remove all the controllers from the clock.
+	*/
+	void clearControllers();
+
+	inline int getControllerCount(){
+		return controllers.size();
+	}
+
+	/**
+		This method is used to set the fixed time step of the simulation. By default, SimGlobals::dt is used. Changing it drops the
+		time that was accumulated.
+	*/
+	void setTimeStep(double dt);
+
+	inline double getTimeStep(){
+		return dt;
+	}
+
+	/**
+		This method is used to set the largest number of steps that are taken by one call to advance. If more time than that was asked
+		for, the rest is dropped, so that a slow frame does not make the next one even slower.
+	*/
+	inline void setMaxStepCount(int maxStepCount){
+		this->maxStepCount = (maxStepCount > 0)?(maxStepCount):(1);
+	}
+
+	inline int getMaxStepCount(){
+		return maxStepCount;
+	}
+
+	/**
+		This method is used to advance the simulation by the given amount of time. Returns the number of fixed steps that were taken.
+	*/
+	int advance(double interval);
+
+	/**
+		This method is used to take exactly one step, regardless of the accumulator.
+	*/
+	void step();
+
+	/**
+		This method is used to drop the time that was accumulated, and to forget the previous state of the bodies. The bodies that are
+		moved from the outside are noticed without it, this is for when the clock should start over, for instance when a new scene is loaded.
+	*/
+	void reset();
+
+	/**
+		Returns the number of steps taken by the last call to advance.
+	*/
+	inline int getLastStepCount(){
+		return lastStepCount;
+	}
+
+	/**
+		Returns true if controller i went through a transition (i.e. performPostTasks returned true) during the last call to advance, and false
+		if there is no controller i.
+	*/
+	inline bool hasTransitioned(int i){
+		if (i<0 || (uint)i>=transitioned.size())
+			return false;
+		return transitioned[i] != 0;
+	}
+
+	inline double getSimulatedTime(){
+		return simulatedTime;
+	}
+
+	/**
+		Returns how far we are between the last two simulated states: 0 means the previous one, 1 the current one.
+	*/
+	inline double getInterpolationFactor(){
+		return accumulator / dt;
+	}
+
+	/**
+		These methods return the interpolated position and orientation of the ith rigid body of the world. Each call copies the states of
+		all the bodies, so use drawRBs to go through all of them.
+	*/
+	Point3d getInterpolatedPosition(int i);
+	Quaternion getInterpolatedOrientation(int i);
+
+	/**
+		This method is used to draw all the rigid bodies of the world at their interpolated positions. When joints or skeletons are
+		requested, the bodies are drawn where they really are instead, since the joints are not interpolated.
+	*/
+	void drawRBs(int flags = SHOW_MESH);
+};
@@ -1,6 +1,8 @@
 #include "WorldOracle.h"
+#include <Physics/SphereCDP.h>
 
 WorldOracle::WorldOracle(void){
+	world = NULL;
 }
 
 WorldOracle::~WorldOracle(void){
@@ -9,6 +11,18 @@ WorldOracle::~WorldOracle(void){
 
 double WorldOracle::getWorldHeightAt(Point3d worldLoc){
 	double height = 0;
+
+	//if the point is over the terrain, the terrain replaces the ground
+	bool overTerrain = false;
+	for (uint i=0;i<terrains.size();i++){
+		double tmpHeight;
+		if (terrains[i]->getWorldHeightAt(worldLoc, &tmpHeight)){
+			if (!overTerrain || height < tmpHeight)
+				height = tmpHeight;
+			overTerrain = true;
+		}
+	}
+
 	worldLoc.y = 0;
 	for (uint i=0;i<spheres.size();i++){
 		//see if the given point falls within it...
@@ -25,31 +39,49 @@ double WorldOracle::getWorldHeightAt(Point3d worldLoc){
 	return height;
 }
 
-void createSpheresRBFile(DynamicArray<Sphere> spheres, char* fName){
-	FILE* fp = fopen(fName, "w");
-	//we'll create an RB with the correct CDP, mesh and position
+void WorldOracle::initializeWorld(World *physicalWorld){
+//	spheres.push_back(Sphere(Point3d(0,-0.2,0), 0.3));
+//	spheres.push_back(Sphere(Point3d(5, -1.0, 6), 1.1));
+
+	world = physicalWorld;
+	terrains.clear();
+
+	//every sphere becomes a static rigid body
 	for (uint i=0;i<spheres.size();i++){
-		fprintf(fp, "RigidBody\n");
-		fprintf(fp, "\tstatic\n");
-		fprintf(fp, "\tCDP_Sphere %2.3lf %2.3lf %2.3lf %2.3lf\n", spheres[i].pos.x,spheres[i].pos.y,spheres[i].pos.z, spheres[i].radius);
-		fprintf(fp, "/End\n\n\n");
+		RigidBody* rb = new RigidBody();
+		rb->lockBody();
+		rb->addCollisionDetectionPrimitive(new SphereCDP(spheres[i].pos, spheres[i].radius));
+		physicalWorld->addRigidBody(rb);
 	}
-	fclose(fp);
 }
 
+/**
+	This method is used to add a piece of uneven terrain to the world the oracle was initialized with.
+*/
+RigidBody* WorldOracle::addHeightFieldTerrain(const Point3d& center, double width, double depth, int xCount, int zCount, DynamicArray<double>* heights){
+	if (world == NULL)
+		throwError("The world oracle must be initialized before terrain is added to it.");
 
-void WorldOracle::initializeWorld(World *physicalWorld){
-//	spheres.push_back(Sphere(Point3d(0,-0.2,0), 0.3));
-//	spheres.push_back(Sphere(Point3d(5, -1.0, 6), 1.1));
+	HeightFieldCDP* terrain = new HeightFieldCDP(center, width, depth, xCount, zCount);
+	terrain->setHeights(heights);
 
-	if (spheres.size() > 0){
-		createSpheresRBFile(spheres, "../data/objects/tmpSpheres.rbs");
-		physicalWorld->loadRBsFromFile("../data/objects/tmpSpheres.rbs");
-	}
+	RigidBody* rb = new RigidBody();
+	rb->setName("terrain");
+	rb->lockBody();
+	rb->addCollisionDetectionPrimitive(terrain);
+	world->addRigidBody(rb);
+
+	terrains.push_back(terrain);
+	return rb;
 }
 
 void WorldOracle::draw(){
+#ifndef HEADLESS
 	for (uint i=0;i<spheres.size();i++)
 		GLUtils::drawSphere(spheres[i].pos, spheres[i].radius, 9);
+	//the terrain has no mesh, so it is drawn here. Its rigid body was created at the origin, so there is no transformation to apply
+	for (uint i=0;i<terrains.size();i++)
+		terrains[i]->draw();
+#endif
 }
 
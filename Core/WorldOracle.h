@@ -2,10 +2,15 @@
 
 #include <MathLib/Sphere.h>
 #include <Physics/World.h>
+#include <Physics/HeightFieldCDP.h>
 
 class WorldOracle{
 private:
 	DynamicArray<Sphere> spheres;
+	//the heightfields the terrain is made of - they belong to static rigid bodies of the world
+	DynamicArray<HeightFieldCDP*> terrains;
+	//the world that the oracle was initialized with
+	World* world;
 
 public:
 	WorldOracle(void);
@@ -14,6 +19,14 @@ public:
 	virtual double getWorldHeightAt(Point3d worldLoc);
 	virtual void initializeWorld(World *physicalWorld);
 
+	/**
+		This method is used to add a piece of uneven terrain to the world the oracle was initialized with. The terrain is a grid of
+		xCount by zCount heights (given one row of xCount samples at a time), that covers width by depth units of the x-z plane around
+		center. It becomes a static rigid body of the world, which is returned, and the heights that getWorldHeightAt reports take it
+		into account, at the cost of a single grid lookup.
+	*/
+	virtual RigidBody* addHeightFieldTerrain(const Point3d& center, double width, double depth, int xCount, int zCount, DynamicArray<double>* heights);
+
 	virtual void draw();
 };
 
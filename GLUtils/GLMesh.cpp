@@ -293,4 +293,26 @@ uint GLMesh::renderToObjFile( FILE* fp, uint vertexIdxOffset, TransformationMatr
 	return nbVerts;
 }
 
+/**
+	This method appends the indices of the vertices of all the polygons of the mesh to the array that is passed in, three per
+	triangle. Polygons with more than three vertices are split into fans of triangles.
+*/
+void GLMesh::getTriangleIndices(DynamicArray<int>* indices) {
+	for ( uint i = 0; i<polygons->categories.size(); i++ ){
+		GLPolyIndexList* tempIndexList = polygons->categories[i];
+		uint vertsPerFace = tempIndexList->polyVertexCount;
+		uint nbFaces = tempIndexList->indexList.size() / vertsPerFace;
+		uint idx = 0;
+		for ( uint j = 0; j<nbFaces; j++ ) {
+			uint nbTriInFan = vertsPerFace - 2;
+			for ( uint k = 0; k < nbTriInFan; k++ ) {
+				indices->push_back( tempIndexList->indexList[idx] );
+				indices->push_back( tempIndexList->indexList[idx+1+k] );
+				indices->push_back( tempIndexList->indexList[idx+2+k] );
+			}
+			idx += vertsPerFace;
+		}
+	}
+}
+
 
@@ -370,6 +370,12 @@ public:
 		return &vertexList[0];
 	}
 
+	/**
+		This method appends the indices of the vertices of all the polygons of the mesh to the array that is passed in, three per
+		triangle. Polygons with more than three vertices are split into fans of triangles.
+	*/
+	void getTriangleIndices(DynamicArray<int>* indices);
+
 	/**
 		This method makes sure that the texture information will not be used
 	*/
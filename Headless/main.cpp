@@ -0,0 +1,230 @@
+/*
+	This is the headless simulator: it steps a world without any window, OpenGL context or Python interpreter, and reports how fast it
+	went. It is linked against HeadlessCore, which is the simulation code of MathLib, Utils, Physics and Core built with HEADLESS defined,
+	so it is what batch jobs (rollouts, optimizations, benchmarks on machines without a display) are built on.
+
+	Usage: HeadlessSim [options] [scene.rbs]
+		-time <seconds>		the amount of simulated time (10 seconds by default)
+		-dt <seconds>		the time step (SimGlobals::dt by default)
+		-engine <name>		ode or featherstone (ode by default)
+		-threads <n>		the number of threads the ODE islands are stepped on (0 by default)
+		-deterministic		turns on the deterministic mode of ODE
+		-hashlog <file>		records the hash of the state after every step (ODE only), and writes it to the file
+		-checkrestore		saves the state halfway through, and checks that the steps taken again from the restored state have the
+							same hashes as the ones that followed the save (ODE only)
+
+	When no scene file is given, a built-in scene is used: a grid of boxes and a few hanging chains, all falling on a flat ground.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Utils/Utils.h>
+#include <Utils/BinaryBuffer.h>
+#include <Physics/World.h>
+#include <Physics/ODEWorld.h>
+#include <Physics/RigidBody.h>
+#include <Physics/ArticulatedRigidBody.h>
+#include <Physics/ArticulatedFigure.h>
+#include <Physics/HingeJoint.h>
+#include <Physics/BoxCDP.h>
+#include <Physics/PlaneCDP.h>
+#include <Core/SimGlobals.h>
+
+/**
+	This method sets the mass of the rigid body, and the moments of inertia of a solid box of the given size with the same mass.
+*/
+void setBoxMass(RigidBody* rb, double mass, const Vector3d& size){
+	rb->setMass(mass);
+	rb->setMOI(Vector3d(mass / 12 * (size.y * size.y + size.z * size.z), mass / 12 * (size.x * size.x + size.z * size.z), mass / 12 * (size.x * size.x + size.y * size.y)));
+	rb->addCollisionDetectionPrimitive(new BoxCDP(Point3d(-size.x / 2, -size.y / 2, -size.z / 2), Point3d(size.x / 2, size.y / 2, size.z / 2)));
+}
+
+/**
+	This method fills the world with the built-in scene: the ground, a grid of boxes, and some chains of boxes that are linked by hinge joints.
+*/
+void buildDefaultScene(World* world){
+	RigidBody* ground = new RigidBody();
+	ground->setName("ground");
+	ground->addCollisionDetectionPrimitive(new PlaneCDP(Vector3d(0, 1, 0), Point3d(0, 0, 0)));
+	ground->lockBody();
+	ground->setFrictionCoefficient(0.8);
+	world->addRigidBody(ground);
+
+	Vector3d boxSize(0.2, 0.2, 0.2);
+	for (int i=0;i<5;i++){
+		for (int j=0;j<5;j++){
+			RigidBody* box = new RigidBody();
+			setBoxMass(box, 1, boxSize);
+			box->setCMPosition(Point3d(-1 + i * 0.5, 0.5 + 0.1 * ((i + j) % 3), -1 + j * 0.5));
+			box->setOrientation(0.3 * i, Vector3d(1, 0, 1).toUnit());
+			box->setFrictionCoefficient(0.8);
+			world->addRigidBody(box);
+		}
+	}
+
+	//the links of the chains hang from each other along y, and swing about z
+	Vector3d linkSize(0.05, 0.3, 0.05);
+	char name[100];
+	for (int i=0;i<4;i++){
+		ArticulatedFigure* chain = new ArticulatedFigure();
+		sprintf(name, "chain%d", i);
+		chain->setName(name);
+		ArticulatedRigidBody* parent = NULL;
+		for (int j=0;j<8;j++){
+			ArticulatedRigidBody* link = new ArticulatedRigidBody();
+			setBoxMass(link, 0.5, linkSize);
+			link->setCMPosition(Point3d(2 + i * 0.5, 3 - j * linkSize.y, 0));
+			link->setFrictionCoefficient(0.8);
+			if (parent == NULL){
+				chain->setRoot(link);
+			}else{
+				HingeJoint* joint = new HingeJoint();
+				joint->setAxis(Vector3d(0, 0, 1));
+				joint->setParent(parent);
+				joint->setChild(link);
+				joint->setParentJointPosition(Point3d(0, -linkSize.y / 2, 0));
+				joint->setChildJointPosition(Point3d(0, linkSize.y / 2, 0));
+				chain->addJoint(joint);
+				chain->addArticulatedRigidBody(link);
+			}
+			parent = link;
+		}
+		//give the chains a push, so that they swing
+		parent->setCMVelocity(Vector3d(1, 0, 0));
+		world->addArticulatedFigure(chain);
+	}
+}
+
+void printUsage(){
+	tprintf("Usage: HeadlessSim [-time seconds] [-dt seconds] [-engine ode|featherstone] [-threads n] [-deterministic] [-hashlog file] [-checkrestore] [scene.rbs]\n");
+}
+
+/**
+	This method saves the state of the world, takes stepCount steps while it records their hashes, then restores the state and takes
+	the same steps again, comparing their hashes to the recorded ones. It returns the first step that did not match, or -1 if they all did.
+*/
+int checkRestore(ODEWorld* world, int stepCount, double dt){
+	BinaryBuffer state;
+	world->saveState(&state);
+
+	world->startHashRecording();
+	for (int i=0;i<stepCount;i++)
+		world->advanceInTime(dt);
+	DynamicArray<uint> reference = *world->getHashLog();
+
+	world->restoreState(&state);
+	world->startHashComparison(&reference);
+	for (int i=0;i<stepCount;i++)
+		world->advanceInTime(dt);
+	world->stopHashLog();
+
+	return world->getFirstDivergentStep();
+}
+
+int main(int argc, char** argv){
+	double duration = 10;
+	double dt = SimGlobals::dt;
+	int engine = World::ENGINE_ODE;
+	int islandThreads = 0;
+	bool deterministic = false;
+	char* hashLogFile = NULL;
+	bool restoreCheck = false;
+	char* sceneFile = NULL;
+
+	for (int i=1;i<argc;i++){
+		bool hasValue = i+1 < argc;
+		if (strcmp(argv[i], "-time") == 0 && hasValue)
+			duration = atof(argv[++i]);
+		else if (strcmp(argv[i], "-dt") == 0 && hasValue)
+			dt = atof(argv[++i]);
+		else if (strcmp(argv[i], "-engine") == 0 && hasValue){
+			i++;
+			if (strcmp(argv[i], "ode") == 0)
+				engine = World::ENGINE_ODE;
+			else if (strcmp(argv[i], "featherstone") == 0)
+				engine = World::ENGINE_FEATHERSTONE;
+			else{
+				printUsage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-threads") == 0 && hasValue)
+			islandThreads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-deterministic") == 0)
+			deterministic = true;
+		else if (strcmp(argv[i], "-hashlog") == 0 && hasValue)
+			hashLogFile = argv[++i];
+		else if (strcmp(argv[i], "-checkrestore") == 0)
+			restoreCheck = true;
+		else if (argv[i][0] != '-' && sceneFile == NULL)
+			sceneFile = argv[i];
+		else{
+			printUsage();
+			return 1;
+		}
+	}
+	if (duration <= 0 || dt <= 0){
+		printUsage();
+		return 1;
+	}
+
+	try{
+		World* world = World::createWorld(engine);
+		ODEWorld* odeWorld = (engine == World::ENGINE_ODE)?((ODEWorld*)world):(NULL);
+		if (odeWorld != NULL){
+			odeWorld->setIslandThreadCount(islandThreads);
+			odeWorld->setDeterministic(deterministic);
+		}
+
+		if (sceneFile != NULL)
+			world->loadRBsFromFile(sceneFile);
+		else
+			buildDefaultScene(world);
+
+		if (hashLogFile != NULL){
+			if (odeWorld == NULL)
+				throwError("The hash log is only available with the ODE engine.");
+			odeWorld->startHashRecording();
+		}
+		if (restoreCheck){
+			if (odeWorld == NULL || hashLogFile != NULL)
+				throwError("The restore check is only available with the ODE engine, and without a hash log.");
+		}
+
+		int stepCount = (int)(duration / dt + 0.5);
+		if (restoreCheck){
+			//the first half brings the scene to a state with contacts, and possibly with bodies that are asleep
+			tprintf("Checking the restore of %d rigid bodies after %d steps of %gs...\n", world->getRBCount(), stepCount / 2, dt);
+			for (int i=0;i<stepCount / 2;i++)
+				world->advanceInTime(dt);
+			int divergentStep = checkRestore(odeWorld, stepCount - stepCount / 2, dt);
+			if (divergentStep >= 0){
+				tprintf("The restored simulation diverged at step %d after the restore.\n", divergentStep);
+				return 1;
+			}
+			tprintf("The restored simulation matched for all %d steps.\n", stepCount - stepCount / 2);
+			return 0;
+		}
+
+		tprintf("Simulating %d rigid bodies for %d steps of %gs...\n", world->getRBCount(), stepCount, dt);
+
+		clock_t start = clock();
+		for (int i=0;i<stepCount;i++)
+			world->advanceInTime(dt);
+		double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		tprintf("%d steps in %.3fs: %.0f steps/s, %.2fx real time\n", stepCount, elapsed, (elapsed > 0)?(stepCount / elapsed):(0.0), (elapsed > 0)?(stepCount * dt / elapsed):(0.0));
+		tprintf("state hash: %08x\n", world->getStateHash());
+
+		if (hashLogFile != NULL)
+			odeWorld->saveHashLog(hashLogFile);
+	}catch(char* error){
+		//the message was already printed by throwError
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,71 @@
+#include "stdafx.h"
+
+#include "BakedTrajectory.h"
+
+unsigned int BakedTrajectory1d::hitCount = 0;
+unsigned int BakedTrajectory1d::missCount = 0;
+
+BakedTrajectory1d::BakedTrajectory1d(int interpolation){
+	this->interpolation = interpolation;
+	resolution = 0;
+	source = NULL;
+	sourceVersion = 0;
+	tMin = 0;
+	invStep = 0;
+}
+
+/**
+	This method is used to sample the trajectory into a table of the given number of values.
+*/
+void BakedTrajectory1d::bake(const Trajectory1d& traj, int resolution){
+	this->resolution = resolution;
+	source = &traj;
+	sourceVersion = traj.getVersion();
+	samples.clear();
+
+	int knotCount = traj.getKnotCount();
+	if (resolution < 2 || knotCount == 0)
+		return;
+
+	tMin = traj.getMinPosition();
+	double tMax = traj.getMaxPosition();
+	//a single knot makes for a constant trajectory
+	if (knotCount == 1 || tMax <= tMin){
+		invStep = 0;
+		samples.push_back(traj.getKnotValue(0));
+		return;
+	}
+
+	//the sample positions are sorted, so they are evaluated in one batch
+	DynamicArray<double> positions(resolution);
+	for (int i=0;i<resolution;i++)
+		positions[i] = tMin + (tMax - tMin) * i / (resolution - 1);
+	samples.resize(resolution);
+	if (interpolation == CATMULL_ROM)
+		traj.evaluate_catmull_rom_batch(&positions[0], &samples[0], resolution);
+	else
+		traj.evaluate_linear_batch(&positions[0], &samples[0], resolution);
+	invStep = (resolution - 1) / (tMax - tMin);
+}
+
+/**
+	This method empties the table, so that the trajectory is evaluated directly until the table is baked again.
+*/
+void BakedTrajectory1d::clear(){
+	resolution = 0;
+	source = NULL;
+	samples.clear();
+}
+
+unsigned int BakedTrajectory1d::getHitCount(){
+	return hitCount;
+}
+
+unsigned int BakedTrajectory1d::getMissCount(){
+	return missCount;
+}
+
+void BakedTrajectory1d::resetCounters(){
+	hitCount = 0;
+	missCount = 0;
+}
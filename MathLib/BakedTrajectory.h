@@ -0,0 +1,110 @@
+#pragma once
+
+#include <MathLib/MathLibDll.h>
+
+#include <Utils/Utils.h>
+#include <MathLib/Trajectory.h>
+
+/**
+	This class is used to sample a one-dimensional trajectory into a table of evenly spaced values, so that evaluating it becomes a linear
+	interpolation between two entries of the table, rather than a search for the right knot followed by the evaluation of a spline. The
+	table remembers the version of the trajectory it was baked from: if the knots of the trajectory are edited afterwards (through the
+	keyframe editor, for instance), the table bakes itself again the next time it is evaluated.
+
+	A table that is baked with a resolution smaller than 2 stays empty, and evaluating it simply evaluates the trajectory.
+
+	The number of evaluations that were answered by a table (the hits), and of those that had to evaluate the trajectory itself (the misses),
+	are counted for all the tables together. The counters are not synchronized, so they are only approximate when controllers are run on
+	several threads at the same time.
+*/
+class MATHLIB_DECLSPEC BakedTrajectory1d{
+public:
+	//the way the trajectory is interpolated between its knots
+	enum Interpolation {
+		LINEAR = 0,
+		CATMULL_ROM
+	};
+
+private:
+	//the values of the trajectory, sampled evenly between its first and its last knot
+	DynamicArray<double> samples;
+	//the position of the first sample, and the inverse of the distance between two samples
+	double tMin;
+	double invStep;
+
+	//the trajectory this table was baked from, and the version of its knots at the time
+	const Trajectory1d* source;
+	int sourceVersion;
+
+	int interpolation;
+	int resolution;
+
+	static unsigned int hitCount;
+	static unsigned int missCount;
+
+	/**
+		This method evaluates the trajectory itself, with the interpolation of this table.
+	*/
+	inline double evaluateSource(const Trajectory1d& traj, double t) const {
+		return (interpolation == CATMULL_ROM)?(traj.evaluate_catmull_rom(t)):(traj.evaluate_linear(t));
+	}
+
+public:
+	BakedTrajectory1d(int interpolation = CATMULL_ROM);
+
+	/**
+		This method is used to sample the trajectory into a table of the given number of values.
+	*/
+	void bake(const Trajectory1d& traj, int resolution);
+
+	/**
+		This method empties the table, so that the trajectory is evaluated directly until the table is baked again.
+	*/
+	void clear();
+
+	/**
+		Returns true if the table holds the current knots of the trajectory.
+	*/
+	inline bool isBakedFrom(const Trajectory1d& traj) const {
+		return source == &traj && sourceVersion == traj.getVersion() && samples.size() > 0;
+	}
+
+	/**
+		This method returns the value of the trajectory at t. The table is used when it is up to date, and it is baked again first if the
+		knots of the trajectory changed since it was baked.
+	*/
+	inline double evaluate(const Trajectory1d& traj, double t){
+		if (resolution >= 2 && (source != &traj || sourceVersion != traj.getVersion()))
+			bake(traj, resolution);
+		int count = samples.size();
+		if (count == 0){
+			missCount++;
+			return evaluateSource(traj, t);
+		}
+		hitCount++;
+
+		double x = (t - tMin) * invStep;
+		if (x <= 0)
+			return samples[0];
+		if (x >= count - 1)
+			return samples[count - 1];
+		int i = (int)x;
+		x -= i;
+		return samples[i] + (samples[i+1] - samples[i]) * x;
+	}
+
+	inline int getResolution() const {
+		return resolution;
+	}
+
+	/**
+		These methods return the number of evaluations that were answered by a table, and that had to evaluate the trajectory itself.
+	*/
+	static unsigned int getHitCount();
+	static unsigned int getMissCount();
+
+	/**
+		This method sets both counters back to 0.
+	*/
+	static void resetCounters();
+};
@@ -16,6 +16,7 @@
 #include "Point3d.h"
 #include "Quaternion.h"
 #include "Trajectory.h"
+#include "BakedTrajectory.h"
 %}
 
 // SWIG compiler does not support VC++ declspec
@@ -38,4 +39,6 @@
 
 %template(Trajectory1d) GenericTrajectory<double>;
 %template(Trajectory3d) GenericTrajectory<Point3d>;
-%template(Trajectory3dv) GenericTrajectory<Vector3d>;
\ No newline at end of file
+%template(Trajectory3dv) GenericTrajectory<Vector3d>;
+
+%include "BakedTrajectory.h"
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
 #ifndef MATHLIB_DECLSPEC
-	#ifdef MATHLIB_EXPORTS
+	#if defined(HEADLESS)
+		//the headless build links everything statically
+		#define MATHLIB_DECLSPEC
+		#define MATHLIB_TEMPLATE(x)
+	#elif defined(MATHLIB_EXPORTS)
 		#define MATHLIB_DECLSPEC    __declspec(dllexport) 
 		#define MATHLIB_TEMPLATE(x) template class __declspec(dllexport) x;
 	#else
@@ -56,67 +56,114 @@ private:
 	DynamicArray<double> tValues;
 	DynamicArray<T> values;
 
-	// A caching variable to optimize searching
-	mutable int lastIndex;
+	// This is incremented every time the knots change, so that the tables that are baked from this trajectory can tell when they are stale
+	int version;
+
+	// If the knots are evenly spaced (as they are for trajectories that were sampled at a fixed rate), this is the inverse of the distance
+	// between two knots, and the interval t falls in is computed directly. Otherwise it is 0, and the interval is found by a binary search.
+	double invKnotSpacing;
+
+	/**
+		This method checks whether the knots are evenly spaced. It must be called every time the positions of the knots change, unless
+		the change is one that can be checked without looking at every knot (a knot added at the end, see updateKnotSpacingForLastKnot, or
+		the first or last knot removed or an inner knot moved while the knots are evenly spaced).
+	*/
+	void updateKnotSpacing(){
+		invKnotSpacing = 0;
+		int size = tValues.size();
+		if( size < 3 )
+			return;
+		double spacing = (tValues[size-1] - tValues[0]) / (size-1);
+		if( spacing <= 0 )
+			return;
+		for( int i=1; i < size-1; ++i )
+			if( fabs( tValues[i] - (tValues[0] + i * spacing) ) > spacing * 1e-6 )
+				return;
+		invKnotSpacing = 1 / spacing;
+	}
+
+	/**
+		This method does the same as updateKnotSpacing when the only change since it was last called is a knot that was added at the end,
+		but it only looks at the new knot. Loading a sampled curve one knot at a time is then linear in the number of knots, not quadratic.
+	*/
+	void updateKnotSpacingForLastKnot(){
+		int size = tValues.size();
+		if( size <= 3 ){
+			updateKnotSpacing();
+			return;
+		}
+		//if the knots were not evenly spaced before, they still aren't
+		if( invKnotSpacing <= 0 )
+			return;
+		double spacing = 1 / invKnotSpacing;
+		if( fabs( tValues[size-1] - (tValues[0] + (size-1) * spacing) ) > spacing * 1e-6 ){
+			invKnotSpacing = 0;
+			return;
+		}
+		invKnotSpacing = (size-1) / (tValues[size-1] - tValues[0]);
+	}
 
 	/**
 		This method returns the index of the first knot whose value is larger than the parameter value t. If no such index exists (t is larger than any
-		of the values stored), then values.size() is returned.
+		of the values stored), then values.size() is returned. Nothing is cached between calls, so a trajectory can be evaluated by several threads
+		at the same time.
 	*/
 	int getFirstLargerIndex(double t) const {
 		int size = tValues.size();
 		if( size == 0 ) 
 			return 0;
-		if( t < tValues[(lastIndex+size-1)%size] )
-			lastIndex = 0;
-		for (int i = 0; i<size;i++){
-			int index = (i + lastIndex) % size;
-			if (t < tValues[index]) {
-				lastIndex = index;
-				return index;
-			}
+		if( t < tValues[0] )
+			return 0;
+		if( t >= tValues[size-1] )
+			return size;
+
+		if( invKnotSpacing > 0 ){
+			//guess the interval from the spacing, then fix the guess if round-off put it one knot off
+			int index = (int)((t - tValues[0]) * invKnotSpacing) + 1;
+			if( index > size-1 ) index = size-1;
+			while( index > 1 && t < tValues[index-1] ) index--;
+			while( index < size-1 && t >= tValues[index] ) index++;
+			return index;
 		}
-		return size;
-	}
 
-public:
-	GenericTrajectory(void){
-		lastIndex = 0;
-	}
-	GenericTrajectory( const GenericTrajectory<T>& other ){
-		lastIndex = 0;
-		copy( other );
+		//tValues[low] <= t < tValues[high]
+		int low = 0, high = size-1;
+		while( high - low > 1 ){
+			int mid = (low + high) / 2;
+			if( t < tValues[mid] )
+				high = mid;
+			else
+				low = mid;
+		}
+		return high;
 	}
-	~GenericTrajectory(void){
-		clear();
+
+	/**
+		This method returns the index of the knot that ends the interval t falls in, knowing that t is strictly between the first and the last knot.
+		The index of the previous interval is tried first, which makes evaluating a sorted sequence of parameters cost nearly nothing.
+	*/
+	inline int getIntervalIndex(double t, int previousIndex) const {
+		if( tValues[previousIndex-1] <= t && t < tValues[previousIndex] )
+			return previousIndex;
+		if( previousIndex+1 < (int)tValues.size() && tValues[previousIndex] <= t && t < tValues[previousIndex+1] )
+			return previousIndex+1;
+		return getFirstLargerIndex(t);
 	}
 
 	/**
-		This method performs linear interpolation to evaluate the trajectory at the point t
+		This method linearly interpolates between the knots index-1 and index.
 	*/
-	T evaluate_linear(double t) const {
-		int size = tValues.size();
-		if( size == 0 ) return T();
-		if (t<=tValues[0]) return values[0];
-		if (t>=tValues[size-1])	return values[size-1];
-		int index = getFirstLargerIndex(t);
-		
-		//now linearly interpolate between inedx-1 and index
+	inline T interpolate_linear(int index, double t) const {
 		t = (t-tValues[index-1]) / (tValues[index]-tValues[index-1]);
 		return (values[index-1]) * (1-t) + (values[index]) * t;
 	}
 
-
 	/**
-		This method interprets the trajectory as a Catmul-Rom spline, and evaluates it at the point t
+		This method evaluates the Catmull-Rom spline between the knots index-1 and index.
 	*/
-	T evaluate_catmull_rom(double t) const {
+	T interpolate_catmull_rom(int index, double t) const {
 		int size = tValues.size();
-		if( size == 0 ) return T();
-		if (t<=tValues[0]) return values[0];
-		if (t>=tValues[size-1])	return values[size-1];
-		int index = getFirstLargerIndex(t);
-		
+
 		//now that we found the interval, get a value that indicates how far we are along it
 		t = (t-tValues[index-1]) / (tValues[index]-tValues[index-1]);
 
@@ -156,6 +203,83 @@ public:
 		return p1*(2*t3-3*t2+1) + m1*(t3-2*t2+t) + p2*(-2*t3+3*t2) + m2 * (t3 - t2);
 	}
 
+public:
+	GenericTrajectory(void){
+		version = 0;
+		invKnotSpacing = 0;
+	}
+	GenericTrajectory( const GenericTrajectory<T>& other ){
+		version = 0;
+		invKnotSpacing = 0;
+		copy( other );
+	}
+	~GenericTrajectory(void){
+		clear();
+	}
+
+	/**
+		This method performs linear interpolation to evaluate the trajectory at the point t
+	*/
+	T evaluate_linear(double t) const {
+		int size = tValues.size();
+		if( size == 0 ) return T();
+		if (t<=tValues[0]) return values[0];
+		if (t>=tValues[size-1])	return values[size-1];
+		return interpolate_linear(getFirstLargerIndex(t), t);
+	}
+
+
+	/**
+		This method interprets the trajectory as a Catmul-Rom spline, and evaluates it at the point t
+	*/
+	T evaluate_catmull_rom(double t) const {
+		int size = tValues.size();
+		if( size == 0 ) return T();
+		if (t<=tValues[0]) return values[0];
+		if (t>=tValues[size-1])	return values[size-1];
+		return interpolate_catmull_rom(getFirstLargerIndex(t), t);
+	}
+
+	/**
+		This method evaluates the trajectory at the n points of t with linear interpolation, and writes the results to out. The points can be in any
+		order, but sorted points are the fastest, since the interval of the previous point is tried first.
+	*/
+	void evaluate_linear_batch(const double* t, T* out, int n) const {
+		int size = tValues.size();
+		if( size == 0 ){
+			for( int i=0; i < n; ++i ) out[i] = T();
+			return;
+		}
+		double tMin = tValues[0], tMax = tValues[size-1];
+		int index = 1;
+		for( int i=0; i < n; ++i ){
+			if (t[i]<=tMin) { out[i] = values[0]; continue; }
+			if (t[i]>=tMax) { out[i] = values[size-1]; continue; }
+			index = getIntervalIndex(t[i], index);
+			out[i] = interpolate_linear(index, t[i]);
+		}
+	}
+
+	/**
+		This method evaluates the trajectory at the n points of t as a Catmull-Rom spline, and writes the results to out. As above, sorted points
+		are the fastest.
+	*/
+	void evaluate_catmull_rom_batch(const double* t, T* out, int n) const {
+		int size = tValues.size();
+		if( size == 0 ){
+			for( int i=0; i < n; ++i ) out[i] = T();
+			return;
+		}
+		double tMin = tValues[0], tMax = tValues[size-1];
+		int index = 1;
+		for( int i=0; i < n; ++i ){
+			if (t[i]<=tMin) { out[i] = values[0]; continue; }
+			if (t[i]>=tMax) { out[i] = values[size-1]; continue; }
+			index = getIntervalIndex(t[i], index);
+			out[i] = interpolate_catmull_rom(index, t[i]);
+		}
+	}
+
 	/**
 		Returns the value of the ith knot. It is assumed that i is within the correct range.
 	*/
@@ -175,6 +299,7 @@ public:
 	*/
 	void setKnotValue(int i, const T& val){
 		values[i] = val;
+		version++;
 	}
 
 	/**
@@ -184,6 +309,14 @@ public:
 		if( i-1 >= 0               && tValues[i-1] >= pos ) return;
 		if( (uint)(i+1) < tValues.size()-1 && tValues[i+1] <= pos ) return;
 		tValues[i] = pos;
+		//when the knots are evenly spaced, moving one of the inner ones only needs that one to be checked
+		if( invKnotSpacing > 0 && i > 0 && i < (int)tValues.size()-1 ){
+			double spacing = 1 / invKnotSpacing;
+			if( fabs( pos - (tValues[0] + i * spacing) ) > spacing * 1e-6 )
+				invKnotSpacing = 0;
+		}else
+			updateKnotSpacing();
+		version++;
 	}
 
 	/**
@@ -212,6 +345,13 @@ public:
 		return tValues.size();
 	}
 
+	/**
+		returns a number that changes every time the knots of this trajectory are modified
+	*/
+	int getVersion() const{
+		return version;
+	}
+
 	/**
 		This method is used to insert a new knot in the current trajectory
 	*/
@@ -221,6 +361,11 @@ public:
 
 		tValues.insert(tValues.begin()+index, t);
 		values.insert(values.begin()+index, val);
+		if( index == (int)tValues.size()-1 )
+			updateKnotSpacingForLastKnot();
+		else
+			updateKnotSpacing();
+		version++;
 	}
 
 	/**
@@ -228,8 +373,15 @@ public:
 		It is assumed that i is within the correct range.
 	*/
 	void removeKnot(int i){
+		bool endKnot = (i == 0 || i == (int)tValues.size()-1);
 		tValues.erase(tValues.begin()+i);
 		values.erase(values.begin()+i);
+		//removing the first or the last of evenly spaced knots leaves the others evenly spaced
+		if( invKnotSpacing > 0 && endKnot && tValues.size() >= 3 )
+			invKnotSpacing = (tValues.size()-1) / (tValues.back() - tValues.front());
+		else
+			updateKnotSpacing();
+		version++;
 	}
 
 	/**
@@ -238,6 +390,8 @@ public:
 	void clear(){
 		tValues.clear();
 		values.clear();
+		invKnotSpacing = 0;
+		version++;
 	}
 
 	/**
@@ -286,6 +440,7 @@ public:
 
 		tValues.clear();
 		values.clear();
+		version++;
 		int size = other.getKnotCount();
 
 		tValues.reserve(size);
@@ -294,6 +449,7 @@ public:
 			tValues.push_back( other.tValues[i] );
 			values.push_back( other.values[i] );
 		}
+		invKnotSpacing = other.invKnotSpacing;
 	}
 
 };
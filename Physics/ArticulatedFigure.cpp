@@ -9,6 +9,8 @@ ArticulatedFigure::ArticulatedFigure(void){
 	root = NULL;
 	name[0] = '\0';
 	mass = 0;
+	world = NULL;
+	namesVersion = 0;
 }
 
 ArticulatedFigure::~ArticulatedFigure(void){
@@ -23,14 +25,22 @@ ArticulatedFigure::~ArticulatedFigure(void){
 	joints.clear();
 }
 
-void ArticulatedFigure::loadIntoWorld() {
-	World& world = World::instance();
+/**
+	This method adds all the articulated rigid bodies of the figure to the world that is passed in as a parameter. If no world
+	is specified, the default world (World::instance()) is used.
+*/
+void ArticulatedFigure::loadIntoWorld(World* world) {
+	if (world == NULL)
+		world = &World::instance();
 
 	if( root == NULL )
 		throwError( "Articulated figure needs a root before it can be loaded into the world!" );
-	world.addRigidBody(root);
+	if( this->world != NULL && this->world != world )
+		throwError( "Articulated figure '%s' is already loaded into another world!", name );
+	this->world = world;
+	world->addRigidBody(root);
 	for (uint i=0;i<arbs.size();i++)
-		world.addRigidBody(arbs[i]);
+		world->addRigidBody(arbs[i]);
 }
 
 /**
@@ -43,6 +53,20 @@ void ArticulatedFigure::setRoot( ArticulatedRigidBody* root ) {
 	this->root = root;
 }
 
+/**
+	This method is used to set the collision filtering bitmasks of all the bodies of the articulated figure.
+*/
+void ArticulatedFigure::setCollisionBits(uint categoryBits, uint collideBits){
+	if (root != NULL){
+		root->setCategoryBits(categoryBits);
+		root->setCollideBits(collideBits);
+	}
+	for (uint i=0;i<arbs.size();i++){
+		arbs[i]->setCategoryBits(categoryBits);
+		arbs[i]->setCollideBits(collideBits);
+	}
+}
+
 /**
 	Sets the root
 */
@@ -95,6 +119,7 @@ void ArticulatedFigure::loadFromFile(FILE* f, World* world){
 		throwError("Invalid file pointer.");
 	if (world == NULL)
 		throwError("A valid physical world must be passed in as a parameter");
+	this->world = world;
 	//have a temporary buffer used to read the file line by line...
 	char buffer[200];
 	char tempName[100];
@@ -121,21 +146,24 @@ void ArticulatedFigure::loadFromFile(FILE* f, World* world){
 				tempJoint = new UniversalJoint();
 				tempJoint->readAxes( line );
 				tempJoint->loadFromFile(f, world);
-				tempJoint->child->AFParent = this;
+				addJoint(tempJoint);
+				addArticulatedRigidBody(tempJoint->child);
 				tempJoint->parent->AFParent = this;
 				break;
 			case RB_JOINT_TYPE_HINGE:
 				tempJoint = new HingeJoint();
 				tempJoint->readAxes( line );
 				tempJoint->loadFromFile(f, world);
-				tempJoint->child->AFParent = this;
+				addJoint(tempJoint);
+				addArticulatedRigidBody(tempJoint->child);
 				tempJoint->parent->AFParent = this;
 				break;
 			case RB_JOINT_TYPE_BALL_IN_SOCKET:
 				tempJoint = new BallInSocketJoint();
 				tempJoint->readAxes( line );
 				tempJoint->loadFromFile(f, world);
-				tempJoint->child->AFParent = this;
+				addJoint(tempJoint);
+				addArticulatedRigidBody(tempJoint->child);
 				tempJoint->parent->AFParent = this;
 				break;
 			case RB_END_ARTICULATED_FIGURE:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Utils/Observable.h>
+#include <Utils/NameIndex.h>
 
 
 #include <Physics/PhysicsDll.h>
@@ -14,6 +15,7 @@
  * figures. One note is that we will only allow tree structures - no loops.                                                                                             *
  *======================================================================================================================================================================*/
 class PHYSICS_DECLSPEC RBCollection;
+class World;
 class PHYSICS_DECLSPEC ArticulatedFigure : public Observable {
 friend class Character;
 friend class ODEWorld;
@@ -31,6 +33,14 @@ protected:
 
 	DynamicArray<ArticulatedRigidBody*> arbs;
 
+	//these are used to look the joints and the articulated rigid bodies up by name, and are built again when they are out of date
+	NameIndex jointNames;
+	mutable NameIndex arbNames;
+	//this is incremented whenever a joint or an articulated rigid body of the figure is renamed, so that the indices are built again
+	int namesVersion;
+
+	//this is the world that the articulated figure was loaded into (NULL if it was not added to any world yet)
+	World* world;
 
 public:
 	/**
@@ -43,7 +53,26 @@ public:
 	*/
 	virtual ~ArticulatedFigure(void);
 
-	void loadIntoWorld();
+	/**
+		This method adds all the articulated rigid bodies of the figure to the world that is passed in as a parameter. If no world
+		is specified, the default world (World::instance()) is used. The figure remembers which world it was loaded into.
+	*/
+	void loadIntoWorld(World* world = NULL);
+
+	/**
+		Returns the world that this articulated figure lives in, or NULL if it was not loaded into a world yet.
+	*/
+	inline World* getWorld(){
+		return world;
+	}
+
+	/**
+		This method is called by a joint or an articulated rigid body of this figure when it is renamed, so that the figure looks it up by
+		its new name.
+	*/
+	inline void namesChanged(){
+		namesVersion++;
+	}
 
 	/**
 		Sets the root
@@ -82,10 +111,8 @@ public:
 				return root;
 		}
 
-		for (uint i=0;i<arbs.size();i++)
-			if (strcmp(arbs[i]->name, name) == NULL)
-				return arbs[i];
-		return NULL;
+		int i = arbNames.findIn(arbs, namesVersion, name);
+		return (i >= 0)?(arbs[i]):(NULL);
 	}
 	/**
 		Adds a joint to the figure
@@ -118,6 +145,12 @@ public:
 	*/
 	void computeMass();
 
+	/**
+		This method is used to set the collision filtering bitmasks of all the bodies of the articulated figure. For instance, giving every
+		character its own category bit and leaving that bit out of its collide bits turns off self-collisions in the broad phase.
+	*/
+	void setCollisionBits(uint categoryBits, uint collideBits);
+
 	/**
 		This method is used to get the total mass of the articulated figure.
 	*/
@@ -150,20 +183,16 @@ public:
 		if it is not found.
 	*/
 	inline Joint* getJointByName(char* jName){
-		for (uint i=0;i<joints.size();i++)
-			if (strcmp(joints[i]->name, jName) == NULL)
-				return joints[i];
-		return NULL;
+		int i = jointNames.findIn(joints, namesVersion, jName);
+		return (i >= 0)?(joints[i]):(NULL);
 	}
 
 	/**
 		this method is used to return the index of the joint (whose name is passed as a parameter) in the articulated figure hierarchy.
+		The index can be kept: it does not change unless joints are added to the figure.
 	*/
 	inline int getJointIndex(const char* jName){
-		for (uint i=0;i<joints.size();i++)
-			if (strcmp(joints[i]->name, jName) == NULL)
-				return i;
-		return -1;
+		return jointNames.findIn(joints, namesVersion, jName);
 	}
 
 	/**
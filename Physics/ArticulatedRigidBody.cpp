@@ -14,6 +14,7 @@ ArticulatedRigidBody::~ArticulatedRigidBody(void){
 	This method draws the current rigid body.
 */
 void ArticulatedRigidBody::draw(int flags){
+#ifndef HEADLESS
 
 	if (flags & SHOW_ABSTRACT_VIEW_SKELETON){
 		GLboolean lighting = glIsEnabled(GL_LIGHTING);
@@ -51,5 +52,6 @@ void ArticulatedRigidBody::draw(int flags){
 		GLUtils::drawSphere(this->getWorldCoordinates(pJoint->cJPos), 0.02, 4);
 		GLUtils::drawSphere(pJoint->parent->getWorldCoordinates(pJoint->pJPos), 0.02, 4);
 	}
+#endif
 }
 
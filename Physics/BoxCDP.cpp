@@ -1,5 +1,7 @@
 #include "BoxCDP.h"
+#ifndef HEADLESS
 #include <GLUtils/GLUtils.h>
+#endif
 
 BoxCDP::~BoxCDP(void){
 
@@ -9,6 +11,8 @@ BoxCDP::~BoxCDP(void){
 	Draw an outline of the box
 */
 void BoxCDP::draw(){
+#ifndef HEADLESS
 	GLUtils::drawBox(p1, p2);
+#endif
 }
 
@@ -1,5 +1,7 @@
 #include ".\capsulecdp.h"
+#ifndef HEADLESS
 #include <GLUtils/GLUtils.h>
+#endif
 #include <Physics/SphereCDP.h>
 #include <Physics/PlaneCDP.h>
 #include <MathLib/Segment.h>
@@ -18,7 +20,9 @@ void CapsuleCDP::draw(){
 //	GLUtils::drawCylinder(this->c.radius, Vector3d(this->c.p1, this->c.p2), this->c.p1, 6);
 //	GLUtils::drawSphere(this->c.p1, this->c.radius, 5);
 //	GLUtils::drawSphere(this->c.p2, this->c.radius, 5);
+#ifndef HEADLESS
 	GLUtils::drawCapsule(this->c.radius,Vector3d(this->c.p1, this->c.p2), this->c.p1, 6);
+#endif
 }
 
 void CapsuleCDP::updateToWorldPrimitive(){
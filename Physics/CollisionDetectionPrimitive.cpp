@@ -6,6 +6,39 @@
 CollisionDetectionPrimitive::~CollisionDetectionPrimitive(void){
 }
 
+/**
+	This method returns the category bits that are actually used for this primitive, once the ones of the rigid body are taken into account.
+*/
+uint CollisionDetectionPrimitive::getEffectiveCategoryBits(){
+	if (bdy == NULL)
+		return categoryBits;
+	return categoryBits & bdy->getCategoryBits();
+}
+
+/**
+	This method returns the collide bits that are actually used for this primitive, once the ones of the rigid body are taken into account.
+*/
+uint CollisionDetectionPrimitive::getEffectiveCollideBits(){
+	if (bdy == NULL)
+		return collideBits;
+	return collideBits & bdy->getCollideBits();
+}
+
+/**
+	These methods are used to set the collision filtering bitmasks of this primitive. The world of the body is told about the change.
+*/
+void CollisionDetectionPrimitive::setCategoryBits( uint bits ){
+	categoryBits = bits;
+	if (bdy != NULL)
+		bdy->collisionBitsChanged();
+}
+
+void CollisionDetectionPrimitive::setCollideBits( uint bits ){
+	collideBits = bits;
+	if (bdy != NULL)
+		bdy->collisionBitsChanged();
+}
+
 /**
 	draw an outline of the primitive...
 */
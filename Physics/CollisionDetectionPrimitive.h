@@ -24,6 +24,8 @@ class BoxCDP;
 #define CAPSULE_CDP 2
 #define PLANE_CDP 3
 #define BOX_CDP 4
+#define HEIGHTFIELD_CDP 5
+#define TRIMESH_CDP 6
 
 
 
@@ -32,10 +34,14 @@ protected:
 	//keep track of the rigid body that this collision detection primitive belongs to - useful to update world coordinates, etc
 	int type;
 	RigidBody* bdy;
+	//the collision filtering bitmasks of this primitive. They are combined (and-ed) with the ones of the rigid body, so they can
+	//only be used to take a primitive out of some of the collisions that the body takes part in
+	uint categoryBits;
+	uint collideBits;
 
 public:
 	CollisionDetectionPrimitive(int type, RigidBody* theBody = NULL ) :
-	  type(type), bdy( theBody ) {}
+	  type(type), bdy( theBody ), categoryBits( ~0 ), collideBits( ~0 ) {}
 	virtual ~CollisionDetectionPrimitive(void);
 
 	const char* typeName(){
@@ -60,6 +66,21 @@ public:
 	*/
 	inline int getType(){return type;}
 
+	/**
+		These methods are used to set the collision filtering bitmasks of this primitive. The world of the body is told about the change.
+	*/
+	void setCategoryBits( uint bits );
+	void setCollideBits( uint bits );
+
+	uint getCategoryBits() const { return categoryBits; }
+	uint getCollideBits() const { return collideBits; }
+
+	/**
+		These methods return the bitmasks that are actually used for this primitive, once the ones of the rigid body are taken into account.
+	*/
+	uint getEffectiveCategoryBits();
+	uint getEffectiveCollideBits();
+
 	virtual int computeCollisionsWith(CollisionDetectionPrimitive* other,  DynamicArray<ContactPoint> *cps) = 0;
 	virtual int computeCollisionsWithSphereCDP(SphereCDP* sp,  DynamicArray<ContactPoint> *cps) = 0;
 	virtual int computeCollisionsWithPlaneCDP(PlaneCDP* sp,  DynamicArray<ContactPoint> *cps) = 0;
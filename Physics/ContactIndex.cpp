@@ -0,0 +1,112 @@
+#include "ContactIndex.h"
+#include <Physics/RigidBody.h>
+
+ContactIndex::ContactIndex(void){
+	bodyCount = 0;
+	source = NULL;
+	sourceSize = 0;
+	bodies = NULL;
+}
+
+ContactIndex::~ContactIndex(void){
+}
+
+/**
+	This method returns the index of the rigid body that is passed in, or -1 if the index doesn't know about it.
+*/
+int ContactIndex::getBodyIndex(RigidBody* rb){
+	if (rb == NULL)
+		return -1;
+	//the world sets the id of a body to its position, so this is normally found right away
+	if (rb->id >= 0 && rb->id < bodyCount && (*bodies)[rb->id] == rb)
+		return rb->id;
+	for (int i=0;i<bodyCount;i++)
+		if ((*bodies)[i] == rb)
+			return i;
+	return -1;
+}
+
+/**
+	This method is used to add the contact point to what is known about body i.
+*/
+void ContactIndex::addContact(int i, const Point3d& p, const Vector3d& f){
+	forces[i] += f;
+	if (contactCounts[i] == 0){
+		boundsMin[i] = p;
+		boundsMax[i] = p;
+	}else{
+		boundsMin[i].x = MIN(boundsMin[i].x, p.x); boundsMax[i].x = MAX(boundsMax[i].x, p.x);
+		boundsMin[i].y = MIN(boundsMin[i].y, p.y); boundsMax[i].y = MAX(boundsMax[i].y, p.y);
+		boundsMin[i].z = MIN(boundsMin[i].z, p.z); boundsMax[i].z = MAX(boundsMax[i].z, p.z);
+	}
+	contactCounts[i]++;
+}
+
+/**
+	This method is used to index the contact points cps, for the bodies that are passed in.
+*/
+void ContactIndex::build(DynamicArray<ContactPoint>* cps, DynamicArray<RigidBody*>* bodies){
+	bodyCount = bodies->size();
+	forces.assign(bodyCount, Vector3d());
+	contactCounts.assign(bodyCount, 0);
+	boundsMin.resize(bodyCount);
+	boundsMax.resize(bodyCount);
+	firstContacts.assign(bodyCount + 1, 0);
+	source = cps;
+	sourceSize = cps->size();
+	this->bodies = bodies;
+
+	//the bodies of every contact are only looked up once, and kept for the second pass
+	contactBodies.resize(2 * sourceSize);
+	int indexedCount = 0;
+	for (uint i=0;i<sourceSize;i++){
+		const ContactPoint& c = (*cps)[i];
+		int b1 = getBodyIndex(c.rb1);
+		int b2 = getBodyIndex(c.rb2);
+		if (b1 >= 0){
+			addContact(b1, c.cp, c.f);
+			indexedCount++;
+		}
+		if (b2 >= 0 && b2 != b1){
+			addContact(b2, c.cp, c.f * (-1));
+			indexedCount++;
+		}else if (b2 >= 0){
+			//a body in contact with itself is only listed once, but the force is still added and taken away, as a scan of the contacts would do
+			forces[b2] += c.f * (-1);
+		}
+		contactBodies[2*i] = b1;
+		contactBodies[2*i+1] = (b2 != b1)?(b2):(-1);
+	}
+
+	//the lists of the bodies are laid out one after the other, in the order of the bodies
+	for (int i=0;i<bodyCount;i++)
+		firstContacts[i+1] = firstContacts[i] + contactCounts[i];
+
+	//the lists are filled in the order of the contacts, which leaves every list sorted
+	nextContacts.assign(firstContacts.begin(), firstContacts.end() - 1);
+	contacts.resize(indexedCount);
+	for (uint i=0;i<sourceSize;i++){
+		int b1 = contactBodies[2*i];
+		int b2 = contactBodies[2*i+1];
+		if (b1 >= 0)
+			contacts[nextContacts[b1]++] = i;
+		if (b2 >= 0)
+			contacts[nextContacts[b2]++] = i;
+	}
+}
+
+/**
+	This method empties the index.
+*/
+void ContactIndex::clear(){
+	bodyCount = 0;
+	forces.clear();
+	contactCounts.clear();
+	boundsMin.clear();
+	boundsMax.clear();
+	firstContacts.clear();
+	contacts.clear();
+	source = NULL;
+	sourceSize = 0;
+	bodies = NULL;
+}
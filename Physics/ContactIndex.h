@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Utils/Utils.h>
+#include <MathLib/Point3d.h>
+#include <MathLib/Vector3d.h>
+#include <Physics/PhysicsDll.h>
+#include <Physics/ContactPoint.h>
+
+class RigidBody;
+
+/*==================================================================================================================================================*
+ * This class sorts the contact points of a step by rigid body, so that the questions the controllers ask every step (what is the net force on   *
+ * this foot, is this body touching anything, which contacts involve it) don't need a scan of all the contacts of the world. For every body, the  *
+ * index holds the net force that the contacts apply to it, the number of contacts, the bounding box of the contact points and the list of its   *
+ * contacts, as indices into the array it was built from. The bodies are identified by their position in the world.                               *
+ *==================================================================================================================================================*/
+class PHYSICS_DECLSPEC ContactIndex{
+private:
+	//the net force on every body (f for the contacts where it is rb1, -f for the ones where it is rb2, and both for a contact with itself)
+	DynamicArray<Vector3d> forces;
+	//the number of contacts of every body
+	DynamicArray<int> contactCounts;
+	//the bounding box of the contact points of every body - only meaningful if the body has contacts
+	DynamicArray<Point3d> boundsMin;
+	DynamicArray<Point3d> boundsMax;
+	//the contacts of body i are contacts[firstContacts[i]] to contacts[firstContacts[i+1]-1]
+	DynamicArray<int> firstContacts;
+	DynamicArray<int> contacts;
+	//these are only used while the index is built: the two bodies of every contact (-1 if they are not indexed), and where the next
+	//contact of every body goes. They are kept so that the memory is reused from one step to the next
+	DynamicArray<int> contactBodies;
+	DynamicArray<int> nextContacts;
+	//the number of bodies the index was built for
+	int bodyCount;
+
+	//the array the index was built from, and the number of contacts it had then
+	DynamicArray<ContactPoint>* source;
+	uint sourceSize;
+	//the bodies the index was built for
+	DynamicArray<RigidBody*>* bodies;
+
+	/**
+		This method is used to add the contact point to what is known about body i.
+	*/
+	void addContact(int i, const Point3d& p, const Vector3d& f);
+
+public:
+	ContactIndex(void);
+	~ContactIndex(void);
+
+	/**
+		This method is used to index the contact points cps, for the bodies that are passed in. The index keeps a pointer to cps, and is only
+		considered up to date as long as cps keeps the same number of contact points.
+	*/
+	void build(DynamicArray<ContactPoint>* cps, DynamicArray<RigidBody*>* bodies);
+
+	/**
+		This method empties the index.
+	*/
+	void clear();
+
+	/**
+		This method returns true if the index describes the contact points that are passed in.
+	*/
+	inline bool isBuiltFrom(DynamicArray<ContactPoint>* cps){
+		return cps != NULL && cps == source && cps->size() == sourceSize;
+	}
+
+	inline int getBodyCount(){
+		return bodyCount;
+	}
+
+	/**
+		This method returns the index of the rigid body that is passed in, as used by the methods below, or -1 if the index doesn't know about it.
+	*/
+	int getBodyIndex(RigidBody* rb);
+
+	/**
+		Returns the net force that the contacts apply to body i.
+	*/
+	inline Vector3d getForce(int i){
+		return forces[i];
+	}
+
+	/**
+		Returns the number of contacts of body i.
+	*/
+	inline int getContactCount(int i){
+		return contactCounts[i];
+	}
+
+	/**
+		Returns the corners of the bounding box of the contact points of body i (it is empty if the body has no contacts).
+	*/
+	inline Point3d getContactBoundsMin(int i){
+		return boundsMin[i];
+	}
+
+	inline Point3d getContactBoundsMax(int i){
+		return boundsMax[i];
+	}
+
+	/**
+		Returns the index, in the array the index was built from, of the kth contact of body i.
+	*/
+	inline int getContact(int i, int k){
+		return contacts[firstContacts[i] + k];
+	}
+};
@@ -0,0 +1,877 @@
+#include "FeatherstoneWorld.h"
+#include <Utils/Utils.h>
+#include <Physics/PhysicsGlobals.h>
+#include <Physics/ArticulatedFigure.h>
+#include <Physics/HingeJoint.h>
+#include <Physics/UniversalJoint.h>
+
+/**
+	Default constructor
+*/
+FeatherstoneWorld::FeatherstoneWorld() : World(){
+	linksDirty = false;
+	pcQuery = new PreCollisionQuery();
+	//the contact springs are stiff enough to hold a character up with a few millimeters of penetration, and the friction is viscous enough to keep
+	//a planted foot from sliding. They stay stable with the usual time step of 1/2000 s
+	contactStiffness = 100000;
+	contactDamping = 1000;
+	frictionViscosity = 2000;
+	jointLimitStiffness = 200;
+	jointLimitDamping = 0.5;
+}
+
+/**
+	destructor
+*/
+FeatherstoneWorld::~FeatherstoneWorld(void){
+	destroyWorld();
+	delete pcQuery;
+}
+
+void FeatherstoneWorld::destroyWorld(){
+	links.clear();
+	linkIndices.clear();
+	staticBodies.clear();
+	linksDirty = false;
+	World::destroyWorld();
+}
+
+/**
+	This method replaces the object that decides which pairs of bodies are checked for collisions in this world.
+*/
+void FeatherstoneWorld::setPreCollisionQuery( PreCollisionQuery* pcQuery ) {
+	if (this->pcQuery == pcQuery)
+		return;
+	delete this->pcQuery;
+	this->pcQuery = pcQuery;
+}
+
+/**
+	This method is used to set the parameters of the contact model.
+*/
+void FeatherstoneWorld::setContactParameters(double stiffness, double damping, double frictionViscosity){
+	this->contactStiffness = stiffness;
+	this->contactDamping = damping;
+	this->frictionViscosity = frictionViscosity;
+}
+
+/**
+	This method is used to set the stiffness and the damping of the springs that enforce the joint limits.
+*/
+void FeatherstoneWorld::setJointLimitParameters(double stiffness, double damping){
+	this->jointLimitStiffness = stiffness;
+	this->jointLimitDamping = damping;
+}
+
+/**
+	This method reads a list of rigid bodies from the specified file.
+*/
+void FeatherstoneWorld::loadRBsFromFile(char* fName){
+	World::loadRBsFromFile(fName);
+	linksDirty = true;
+}
+
+/**
+	This method adds one rigid body (articulated or not).
+*/
+void FeatherstoneWorld::addRigidBody( RigidBody* rigidBody ) {
+	World::addRigidBody(rigidBody);
+	//articulated rigid bodies are only simulated once (and if) their figure is added
+	linksDirty = true;
+}
+
+/**
+	This method adds one articulated figure.
+*/
+void FeatherstoneWorld::addArticulatedFigure(ArticulatedFigure* articulatedFigure){
+	World::addArticulatedFigure(articulatedFigure);
+	linksDirty = true;
+}
+
+/**
+	This method is used to add a link for the rigid body, and returns its index.
+*/
+int FeatherstoneWorld::addLink(RigidBody* rb, Joint* joint, int parent){
+	FS_Link link;
+	link.rb = rb;
+	link.joint = joint;
+	link.parent = parent;
+	link.jointType = (joint != NULL)?(joint->getJointType()):(0);
+	if (joint == NULL)
+		link.dofCount = (rb->isLocked())?(0):(6);
+	else{
+		switch (link.jointType){
+			case STIFF_JOINT:
+				link.dofCount = 0;
+				break;
+			case HINGE_JOINT:
+				link.dofCount = 1;
+				break;
+			case UNIVERSAL_JOINT:
+				link.dofCount = 2;
+				break;
+			case BALL_IN_SOCKET_JOINT:
+				link.dofCount = 3;
+				break;
+			default:
+				throwError("Ooops.... Only BallAndSocket, Hinge, Universal and Stiff joints are currently supported.\n");
+		}
+	}
+	for (int k=0;k<3;k++){
+		link.qd[k] = link.qdd[k] = link.tau[k] = link.u[k] = 0;
+		if (k < 2)
+			link.q[k] = 0;
+		for (int l=0;l<3;l++)
+			link.Dinv[k][l] = 0;
+	}
+	links.push_back(link);
+	linkIndices[rb->id] = links.size() - 1;
+	return links.size() - 1;
+}
+
+/**
+	This method is used to build the list of links from the objects and the articulated figures of the world. The bodies of a figure are added
+	breadth first, starting from the root, so every body comes after its parent.
+*/
+void FeatherstoneWorld::buildLinks(){
+	links.clear();
+	staticBodies.clear();
+	linkIndices.assign(objects.size(), -1);
+
+	for (uint i=0;i<objects.size();i++){
+		if (objects[i]->isArticulated())
+			continue;
+		if (objects[i]->isLocked())
+			staticBodies.push_back(objects[i]);
+		else
+			addLink(objects[i], NULL, -1);
+	}
+
+	for (uint i=0;i<AFs.size();i++){
+		uint first = links.size();
+		addLink(AFs[i]->getRoot(), NULL, -1);
+		for (uint j=first;j<links.size();j++){
+			ArticulatedRigidBody* arb = (ArticulatedRigidBody*)links[j].rb;
+			for (int k=0;k<arb->getChildJointCount();k++){
+				Joint* joint = arb->getChildJoint(k);
+				addLink(joint->child, joint, j);
+			}
+		}
+	}
+
+	linksDirty = false;
+}
+
+/**
+	Returns the total number of degrees of freedom of the simulated bodies.
+*/
+int FeatherstoneWorld::getDOFCount(){
+	if (linksDirty)
+		buildLinks();
+	int dofCount = 0;
+	for (uint i=0;i<links.size();i++)
+		dofCount += links[i].dofCount;
+	return dofCount;
+}
+
+/**
+	Returns the angle of the rotation q about the axis, once q is projected onto a rotation about that axis.
+*/
+static double getProjectedRotationAngle(Quaternion& q, const Vector3d& axis){
+	double angle = q.getRotationAngle(axis);
+	double len = q.v.length();
+	if (len > 1e-12)
+		angle *= fabs(q.v.dotProductWith(axis)) / len;
+	return angle;
+}
+
+/**
+	This method is used to read the joint angles and velocities of link i from the states of its body and of its parent body.
+*/
+void FeatherstoneWorld::readJointState(int i){
+	FS_Link& link = links[i];
+	RigidBody* p = links[link.parent].rb;
+	RigidBody* c = link.rb;
+	Quaternion qRel = p->state.orientation.getComplexConjugate() * c->state.orientation;
+	Vector3d wRel = c->state.angularVelocity - p->state.angularVelocity;
+
+	//first the angles, the same way the joints fix their constraints
+	switch (link.jointType){
+		case HINGE_JOINT:
+			link.q[0] = getProjectedRotationAngle(qRel, ((HingeJoint*)link.joint)->a);
+			break;
+		case UNIVERSAL_JOINT:{
+			UniversalJoint* uj = (UniversalJoint*)link.joint;
+			Quaternion qA, qB;
+			qRel.decomposeRotation(&qA, &qB, uj->b);
+			link.q[0] = getProjectedRotationAngle(qA, uj->a);
+			link.q[1] = qB.getRotationAngle(uj->b);
+			break;
+		}
+		default:
+			link.qRel = qRel;
+			link.qRel.toUnit();
+	}
+	setBodyPoseFromJoint(i);
+
+	//and then the velocities, which only have to account for the part of the relative angular velocity that the joint allows
+	switch (link.jointType){
+		case HINGE_JOINT:
+			link.qd[0] = wRel.dotProductWith(p->getWorldCoordinates(((HingeJoint*)link.joint)->a));
+			break;
+		case UNIVERSAL_JOINT:{
+			UniversalJoint* uj = (UniversalJoint*)link.joint;
+			Vector3d ua = p->getWorldCoordinates(uj->a);
+			Vector3d ub = c->getWorldCoordinates(uj->b);
+			//this is the least squares fit of qd[0] * ua + qd[1] * ub to the relative angular velocity
+			double aa = ua.dotProductWith(ua), ab = ua.dotProductWith(ub), bb = ub.dotProductWith(ub);
+			double ra = ua.dotProductWith(wRel), rb = ub.dotProductWith(wRel);
+			double det = aa * bb - ab * ab;
+			if (fabs(det) > 1e-12){
+				link.qd[0] = (bb * ra - ab * rb) / det;
+				link.qd[1] = (aa * rb - ab * ra) / det;
+			}else{
+				link.qd[0] = ra / aa;
+				link.qd[1] = 0;
+			}
+			break;
+		}
+		case BALL_IN_SOCKET_JOINT:{
+			Vector3d w = c->getLocalCoordinates(wRel);
+			link.qd[0] = w.x;
+			link.qd[1] = w.y;
+			link.qd[2] = w.z;
+			break;
+		}
+	}
+	computeJointMotion(i);
+}
+
+/**
+	This method is used to set the orientation and the position of the body of link i from its joint angles and the state of its parent.
+*/
+void FeatherstoneWorld::setBodyPoseFromJoint(int i){
+	FS_Link& link = links[i];
+	RigidBody* p = links[link.parent].rb;
+	RigidBody* c = link.rb;
+
+	switch (link.jointType){
+		case HINGE_JOINT:
+			c->state.orientation = p->state.orientation * Quaternion::getRotationQuaternion(link.q[0], ((HingeJoint*)link.joint)->a);
+			break;
+		case UNIVERSAL_JOINT:{
+			UniversalJoint* uj = (UniversalJoint*)link.joint;
+			c->state.orientation = p->state.orientation * Quaternion::getRotationQuaternion(link.q[0], uj->a) * Quaternion::getRotationQuaternion(link.q[1], uj->b);
+			break;
+		}
+		default:
+			c->state.orientation = p->state.orientation * link.qRel;
+	}
+
+	//the joint positions on the parent and on the child are made to coincide
+	Point3d j = p->getWorldCoordinates(link.joint->pJPos);
+	c->state.position = j + c->getWorldCoordinates(Vector3d(link.joint->cJPos)) * (-1);
+}
+
+/**
+	This method is used to compute the motion subspace of the joint of link i, and the velocity of its body.
+*/
+void FeatherstoneWorld::computeJointMotion(int i){
+	FS_Link& link = links[i];
+	RigidBody* c = link.rb;
+
+	//the velocity of a root comes straight from the state of its body
+	if (link.parent < 0){
+		link.v = SpatialVector(c->state.angularVelocity, c->state.velocity + Vector3d(c->state.position).crossProductWith(c->state.angularVelocity));
+		link.c.setToZero();
+		return;
+	}
+
+	FS_Link& parent = links[link.parent];
+	RigidBody* p = parent.rb;
+	Point3d j = p->getWorldCoordinates(link.joint->pJPos);
+
+	//the axes of hinge joints and the first axis of universal joints move with the parent, the other ones move with the child
+	switch (link.jointType){
+		case HINGE_JOINT:
+			link.S[0] = SpatialVector::getRotationAbout(p->getWorldCoordinates(((HingeJoint*)link.joint)->a), j);
+			break;
+		case UNIVERSAL_JOINT:
+			link.S[0] = SpatialVector::getRotationAbout(p->getWorldCoordinates(((UniversalJoint*)link.joint)->a), j);
+			link.S[1] = SpatialVector::getRotationAbout(c->getWorldCoordinates(((UniversalJoint*)link.joint)->b), j);
+			break;
+		case BALL_IN_SOCKET_JOINT:
+			link.S[0] = SpatialVector::getRotationAbout(c->getWorldCoordinates(Vector3d(1, 0, 0)), j);
+			link.S[1] = SpatialVector::getRotationAbout(c->getWorldCoordinates(Vector3d(0, 1, 0)), j);
+			link.S[2] = SpatialVector::getRotationAbout(c->getWorldCoordinates(Vector3d(0, 0, 1)), j);
+			break;
+	}
+
+	SpatialVector vJ;
+	for (int k=0;k<link.dofCount;k++)
+		vJ.addScaledVector(link.S[k], link.qd[k]);
+	link.v = parent.v + vJ;
+	//whether the axes move with the parent or with the child, their rate of change gives this velocity-product term
+	link.c = crossMotion(parent.v, vJ);
+	if (link.jointType == UNIVERSAL_JOINT)
+		link.c += crossMotion(link.S[0] * link.qd[0], link.S[1] * link.qd[1]);
+
+	c->state.angularVelocity = link.v.w;
+	c->state.velocity = link.v.v + link.v.w.crossProductWith(Vector3d(c->state.position));
+}
+
+/**
+	Returns the generalized force of the spring that pushes the joint angle q back within its limits.
+*/
+static double getJointLimitTorque(double q, double qd, double minAngle, double maxAngle, double stiffness, double damping){
+	if (q < minAngle)
+		return stiffness * (minAngle - q) - damping * qd;
+	if (q > maxAngle)
+		return stiffness * (maxAngle - q) - damping * qd;
+	return 0;
+}
+
+/**
+	This method is used to compute the external forces that act on every link, as well as the joint limit torques.
+*/
+void FeatherstoneWorld::computeLinkForces(double deltaT){
+	Vector3d gravity = PhysicsGlobals::up * PhysicsGlobals::gravity;
+
+	for (uint i=0;i<links.size();i++){
+		FS_Link& link = links[i];
+		RigidBody* rb = link.rb;
+		link.fExt = SpatialVector::getForceAt(gravity * rb->getMass() + rb->externalForce, rb->state.position) + link.fApplied;
+		link.fExt.w += rb->externalTorque;
+		link.tau[0] = link.tau[1] = link.tau[2] = 0;
+	}
+
+	for (uint i=0;i<links.size();i++){
+		FS_Link& link = links[i];
+		if (link.joint == NULL)
+			continue;
+		//we will apply to the parent a positive torque, and to the child a negative torque
+		link.fExt.w -= link.joint->torque;
+		links[link.parent].fExt.w += link.joint->torque;
+
+		if (!link.joint->useJointLimits)
+			continue;
+		if (link.jointType == HINGE_JOINT){
+			HingeJoint* hj = (HingeJoint*)link.joint;
+			link.tau[0] = getJointLimitTorque(link.q[0], link.qd[0], hj->minAngle, hj->maxAngle, jointLimitStiffness, jointLimitDamping);
+		}else if (link.jointType == UNIVERSAL_JOINT){
+			UniversalJoint* uj = (UniversalJoint*)link.joint;
+			link.tau[0] = getJointLimitTorque(link.q[0], link.qd[0], uj->minAngleA, uj->maxAngleA, jointLimitStiffness, jointLimitDamping);
+			link.tau[1] = getJointLimitTorque(link.q[1], link.qd[1], uj->minAngleB, uj->maxAngleB, jointLimitStiffness, jointLimitDamping);
+		}
+	}
+
+	//and now the contacts
+	contactPoints.clear();
+	for (uint i=0;i<links.size();i++){
+		if (links[i].rb->isLocked())
+			continue;
+		int firstContact = contactPoints.size();
+		for (int j=0;j<links[i].rb->getCDPCount();j++)
+			collideWithStaticBodies(links[i], links[i].rb->getCDP(j));
+		computeContactForces(links[i], firstContact, deltaT);
+	}
+}
+
+/**
+	This method returns the point of the triangle abc that is closest to p.
+*/
+static Point3d getClosestPointOnTriangle(const Point3d& p, const Point3d& a, const Point3d& b, const Point3d& c){
+	Vector3d ab(a, b), ac(a, c), ap(a, p);
+	double d1 = ab.dotProductWith(ap), d2 = ac.dotProductWith(ap);
+	if (d1 <= 0 && d2 <= 0)
+		return a;
+	Vector3d bp(b, p);
+	double d3 = ab.dotProductWith(bp), d4 = ac.dotProductWith(bp);
+	if (d3 >= 0 && d4 <= d3)
+		return b;
+	double vc = d1 * d4 - d3 * d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0)
+		return a + ab * (d1 / (d1 - d3));
+	Vector3d cp(c, p);
+	double d5 = ab.dotProductWith(cp), d6 = ac.dotProductWith(cp);
+	if (d6 >= 0 && d5 <= d6)
+		return c;
+	double vb = d5 * d2 - d1 * d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0)
+		return a + ac * (d2 / (d2 - d6));
+	double va = d3 * d6 - d5 * d4;
+	if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+		return b + Vector3d(b, c) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	//the closest point is inside the triangle
+	double denom = 1 / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+	This method is used to find the contacts of the collision primitive of a moving body with all the static bodies.
+*/
+void FeatherstoneWorld::collideWithStaticBodies(FS_Link& link, CollisionDetectionPrimitive* cdp){
+	RigidBody* rb = link.rb;
+
+	//the primitive is sampled with a few spheres
+	Point3d samples[8];
+	int sampleCount = 0;
+	double r = 0;
+	switch (cdp->getType()){
+		case SPHERE_CDP:
+			samples[sampleCount++] = rb->getWorldCoordinates(((SphereCDP*)cdp)->getCenter());
+			r = ((SphereCDP*)cdp)->getRadius();
+			break;
+		case CAPSULE_CDP:
+			samples[sampleCount++] = rb->getWorldCoordinates(((CapsuleCDP*)cdp)->getPoint1());
+			samples[sampleCount++] = rb->getWorldCoordinates(((CapsuleCDP*)cdp)->getPoint2());
+			r = ((CapsuleCDP*)cdp)->getRadius();
+			break;
+		case BOX_CDP:{
+			const Point3d& p1 = ((BoxCDP*)cdp)->getPoint1();
+			const Point3d& p2 = ((BoxCDP*)cdp)->getPoint2();
+			for (int k=0;k<8;k++)
+				samples[sampleCount++] = rb->getWorldCoordinates(Point3d((k&1)?(p1.x):(p2.x), (k&2)?(p1.y):(p2.y), (k&4)?(p1.z):(p2.z)));
+			break;
+		}
+		default:
+			//planes, heightfields and meshes only make sense as static geometry
+			return;
+	}
+
+	uint categoryBits = cdp->getEffectiveCategoryBits();
+	uint collideBits = cdp->getEffectiveCollideBits();
+	for (uint i=0;i<staticBodies.size();i++){
+		RigidBody* sb = staticBodies[i];
+		if (pcQuery && pcQuery->shouldCheckForCollisions(rb, sb, false) == false)
+			continue;
+		for (int j=0;j<sb->getCDPCount();j++){
+			CollisionDetectionPrimitive* other = sb->getCDP(j);
+			if ((categoryBits & other->getEffectiveCollideBits()) == 0 && (other->getEffectiveCategoryBits() & collideBits) == 0)
+				continue;
+			for (int k=0;k<sampleCount;k++)
+				collideSample(link, samples[k], r, sb, other);
+		}
+	}
+}
+
+/**
+	This method is used to find the contact of a sphere of radius r, centered at p, that is part of a moving body, with the primitive other of the
+	static body sb.
+*/
+void FeatherstoneWorld::collideSample(FS_Link& link, const Point3d& p, double r, RigidBody* sb, CollisionDetectionPrimitive* other){
+	switch (other->getType()){
+		case PLANE_CDP:{
+			PlaneCDP* plane = (PlaneCDP*)other;
+			Vector3d n = sb->getWorldCoordinates(plane->getNormal()).unit();
+			Point3d o = sb->getWorldCoordinates(plane->getOrigin());
+			double depth = r - n.dotProductWith(p - o);
+			if (depth > 0)
+				addContact(link, sb, p + n * (-r), n, depth);
+			break;
+		}
+		case HEIGHTFIELD_CDP:{
+			HeightFieldCDP* hf = (HeightFieldCDP*)other;
+			double h, hx, hz;
+			if (!hf->getWorldHeightAt(p, &h) || p.y - r >= h)
+				break;
+			//the normal of the surface is estimated from the neighbouring heights
+			const double e = 0.01;
+			if (!hf->getWorldHeightAt(p + Vector3d(e, 0, 0), &hx))
+				hx = h;
+			if (!hf->getWorldHeightAt(p + Vector3d(0, 0, e), &hz))
+				hz = h;
+			Vector3d n = Vector3d(-(hx - h) / e, 1, -(hz - h) / e).unit();
+			addContact(link, sb, p + n * (-r), n, (h - (p.y - r)) * n.y);
+			break;
+		}
+		case SPHERE_CDP:
+		case CAPSULE_CDP:{
+			//both are handled as the closest point on a segment, which is a single point for a sphere
+			Point3d a, b;
+			double R;
+			if (other->getType() == SPHERE_CDP){
+				a = b = sb->getWorldCoordinates(((SphereCDP*)other)->getCenter());
+				R = ((SphereCDP*)other)->getRadius();
+			}else{
+				a = sb->getWorldCoordinates(((CapsuleCDP*)other)->getPoint1());
+				b = sb->getWorldCoordinates(((CapsuleCDP*)other)->getPoint2());
+				R = ((CapsuleCDP*)other)->getRadius();
+			}
+			Vector3d ab = b - a;
+			double t = 0;
+			if (ab.dotProductWith(ab) > 1e-12)
+				t = MAX(0, MIN(1, (p - a).dotProductWith(ab) / ab.dotProductWith(ab)));
+			Vector3d d = p - (a + ab * t);
+			double len = d.length();
+			if (len > R + r || len < 1e-10)
+				break;
+			Vector3d n = d / len;
+			addContact(link, sb, p + n * (-r), n, R + r - len);
+			break;
+		}
+		case BOX_CDP:{
+			BoxCDP* box = (BoxCDP*)other;
+			Vector3d half(box->getXLen() / 2, box->getYLen() / 2, box->getZLen() / 2);
+			Vector3d local = Vector3d(box->getCenter(), sb->getLocalCoordinates(p));
+			Vector3d closest(MAX(-half.x, MIN(half.x, local.x)), MAX(-half.y, MIN(half.y, local.y)), MAX(-half.z, MIN(half.z, local.z)));
+			Vector3d d = local - closest;
+			double len = d.length();
+			Vector3d n;
+			double depth;
+			if (len > 1e-10){
+				//the center of the sphere is outside the box
+				if (len > r)
+					break;
+				n = d / len;
+				depth = r - len;
+			}else{
+				//the center is inside, so it is pushed out through the closest face
+				double dx = half.x - fabs(local.x), dy = half.y - fabs(local.y), dz = half.z - fabs(local.z);
+				if (dx <= dy && dx <= dz){
+					n = Vector3d((local.x < 0)?(-1):(1), 0, 0);
+					depth = r + dx;
+				}else if (dy <= dz){
+					n = Vector3d(0, (local.y < 0)?(-1):(1), 0);
+					depth = r + dy;
+				}else{
+					n = Vector3d(0, 0, (local.z < 0)?(-1):(1));
+					depth = r + dz;
+				}
+			}
+			n = sb->getWorldCoordinates(n);
+			addContact(link, sb, p + n * (-r), n, depth);
+			break;
+		}
+		case TRIMESH_CDP:{
+			//only the deepest triangle makes a contact, otherwise the triangles that share an edge or a corner would push the sample out twice
+			TriMeshCDP* mesh = (TriMeshCDP*)other;
+			const double* v = mesh->getVertexData();
+			const int* idx = mesh->getIndexData();
+			Point3d local = sb->getLocalCoordinates(p);
+			Vector3d n;
+			double depth = 0;
+			for (int i=0;i<mesh->getTriangleCount();i++){
+				Point3d a(v[3*idx[3*i]], v[3*idx[3*i]+1], v[3*idx[3*i]+2]);
+				Point3d b(v[3*idx[3*i+1]], v[3*idx[3*i+1]+1], v[3*idx[3*i+1]+2]);
+				Point3d c(v[3*idx[3*i+2]], v[3*idx[3*i+2]+1], v[3*idx[3*i+2]+2]);
+				Vector3d faceNormal = Vector3d(a, b).crossProductWith(Vector3d(a, c));
+				if (faceNormal.length() < 1e-12)
+					continue;
+				faceNormal.toUnit();
+				//the plane of the triangle is a cheap way to rule most of them out
+				if (fabs(Vector3d(a, local).dotProductWith(faceNormal)) >= r)
+					continue;
+				Vector3d d(getClosestPointOnTriangle(local, a, b, c), local);
+				double len = d.length();
+				if (len >= r)
+					continue;
+				//a center that went through the triangle is pushed back out the front
+				double triDepth;
+				Vector3d triNormal;
+				if (len < 1e-10 || d.dotProductWith(faceNormal) < 0){
+					triNormal = faceNormal;
+					triDepth = r + len;
+				}else{
+					triNormal = d / len;
+					triDepth = r - len;
+				}
+				if (triDepth > depth){
+					depth = triDepth;
+					n = triNormal;
+				}
+			}
+			if (depth > 0){
+				n = sb->getWorldCoordinates(n);
+				addContact(link, sb, p + n * (-r), n, depth);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+/**
+	This method is used to record a contact of the body of the link with the static body other, at point p, with normal n (pointing away from the
+	static body) and penetration depth. The force is computed once all the contacts of the link are known.
+*/
+void FeatherstoneWorld::addContact(FS_Link& link, RigidBody* other, const Point3d& p, const Vector3d& n, double depth){
+	//the contact is reported like the other worlds do: the force is the one that acts on rb1, the moving body
+	contactPoints.push_back(ContactPoint());
+	ContactPoint& cp = contactPoints.back();
+	cp.cp = p;
+	cp.n = n;
+	cp.d = depth;
+	cp.rb1 = link.rb;
+	cp.rb2 = other;
+}
+
+/**
+	Returns the mass that the body of the link opposes to a push at point p, in direction d, if it were on its own.
+*/
+double FeatherstoneWorld::getEffectiveMass(FS_Link& link, const Point3d& p, const Vector3d& d){
+	RigidBody* rb = link.rb;
+	Vector3d t = rb->getLocalCoordinates(Vector3d(rb->state.position, p).crossProductWith(d));
+	Vector3d moi = rb->getPMI();
+	return 1 / (1 / rb->getMass() + t.x * t.x / moi.x + t.y * t.y / moi.y + t.z * t.z / moi.z);
+}
+
+/**
+	This method computes the penalty forces of the contacts of the link, which were recorded starting at firstContact, and adds them to the link.
+*/
+void FeatherstoneWorld::computeContactForces(FS_Link& link, int firstContact, double deltaT){
+	int contactCount = contactPoints.size() - firstContact;
+	int kept = firstContact;
+	for (uint i=firstContact;i<contactPoints.size();i++){
+		ContactPoint cp = contactPoints[i];
+		//this is the velocity of the point of the body that is at the contact
+		Vector3d vel = link.v.v + link.v.w.crossProductWith(Vector3d(cp.cp));
+		double vn = cp.n.dotProductWith(vel);
+		Vector3d vt = vel - cp.n * vn;
+		double vtLen = vt.length();
+
+		//the damping is explicit, so it is capped to what would stop the contact points of the body in one step - more would make it unstable.
+		//The mass of the body on its own is used, which is the smallest mass the contact can see
+		double damping = MIN(contactDamping, getEffectiveMass(link, cp.cp, cp.n) / (contactCount * deltaT));
+		double fn = contactStiffness * cp.d - damping * vn;
+		//the contact can only push
+		if (fn <= 0)
+			continue;
+
+		Vector3d ft;
+		if (vtLen > 1e-10){
+			double viscosity = MIN(frictionViscosity, getEffectiveMass(link, cp.cp, vt / vtLen) / (contactCount * deltaT));
+			ft = vt * (-viscosity);
+			double maxFt = MIN(link.rb->props.mu, cp.rb2->props.mu) * fn;
+			if (vtLen * viscosity > maxFt)
+				ft *= maxFt / (vtLen * viscosity);
+		}
+
+		cp.f = cp.n * fn + ft;
+		link.fExt += SpatialVector::getForceAt(cp.f, cp.cp);
+		contactPoints[kept++] = cp;
+	}
+	contactPoints.resize(kept);
+}
+
+/**
+	This method is used to invert the nxn (n is 3 at most) symmetric matrix D.
+*/
+static void invertJointMatrix(double D[3][3], int n, double Dinv[3][3]){
+	if (n == 1){
+		Dinv[0][0] = 1 / D[0][0];
+	}else if (n == 2){
+		double det = D[0][0] * D[1][1] - D[0][1] * D[1][0];
+		Dinv[0][0] = D[1][1] / det;
+		Dinv[1][1] = D[0][0] / det;
+		Dinv[0][1] = -D[0][1] / det;
+		Dinv[1][0] = -D[1][0] / det;
+	}else if (n == 3){
+		Dinv[0][0] = D[1][1] * D[2][2] - D[1][2] * D[2][1];
+		Dinv[0][1] = D[0][2] * D[2][1] - D[0][1] * D[2][2];
+		Dinv[0][2] = D[0][1] * D[1][2] - D[0][2] * D[1][1];
+		Dinv[1][0] = D[1][2] * D[2][0] - D[1][0] * D[2][2];
+		Dinv[1][1] = D[0][0] * D[2][2] - D[0][2] * D[2][0];
+		Dinv[1][2] = D[0][2] * D[1][0] - D[0][0] * D[1][2];
+		Dinv[2][0] = D[1][0] * D[2][1] - D[1][1] * D[2][0];
+		Dinv[2][1] = D[0][1] * D[2][0] - D[0][0] * D[2][1];
+		Dinv[2][2] = D[0][0] * D[1][1] - D[0][1] * D[1][0];
+		double det = D[0][0] * Dinv[0][0] + D[0][1] * Dinv[1][0] + D[0][2] * Dinv[2][0];
+		for (int i=0;i<3;i++)
+			for (int j=0;j<3;j++)
+				Dinv[i][j] /= det;
+	}
+}
+
+/**
+	This method is used to run the articulated body algorithm, which gives the accelerations of all the links. The velocities and the external
+	forces must be up to date.
+*/
+void FeatherstoneWorld::computeAccelerations(){
+	//first, the inertia and the bias force of every body on its own
+	for (uint i=0;i<links.size();i++){
+		FS_Link& link = links[i];
+		RigidBody* rb = link.rb;
+		//the rotational inertia in world coordinates is R diag(MOI) R^T
+		Vector3d moi = rb->getPMI();
+		double m[3] = {moi.x, moi.y, moi.z};
+		double e[3][3];
+		for (int k=0;k<3;k++){
+			Vector3d axis = rb->getWorldCoordinates(Vector3d((k==0)?(1):(0), (k==1)?(1):(0), (k==2)?(1):(0)));
+			e[k][0] = axis.x; e[k][1] = axis.y; e[k][2] = axis.z;
+		}
+		double I[9];
+		for (int r=0;r<3;r++)
+			for (int c=0;c<3;c++)
+				I[3*r+c] = m[0] * e[0][r] * e[0][c] + m[1] * e[1][r] * e[1][c] + m[2] * e[2][r] * e[2][c];
+		link.IA.setToRigidBodyInertia(rb->getMass(), rb->state.position, I);
+		link.pA = crossForce(link.v, link.IA * link.v) - link.fExt;
+	}
+
+	//then, from the leaves to the roots, every body passes on to its parent what it can't absorb through its joint
+	for (int i=(int)links.size()-1;i>=0;i--){
+		FS_Link& link = links[i];
+		if (link.parent < 0)
+			continue;
+		int n = link.dofCount;
+		double D[3][3];
+		for (int k=0;k<n;k++){
+			link.U[k] = link.IA * link.S[k];
+			link.u[k] = link.tau[k] - link.S[k].dotProductWith(link.pA);
+		}
+		for (int k=0;k<n;k++)
+			for (int l=0;l<n;l++)
+				D[k][l] = link.S[k].dotProductWith(link.U[l]);
+		invertJointMatrix(D, n, link.Dinv);
+
+		SpatialMatrix Ia = link.IA;
+		SpatialVector pa = link.pA;
+		for (int k=0;k<n;k++){
+			for (int l=0;l<n;l++){
+				Ia.subtractOuterProduct(link.U[k], link.U[l], link.Dinv[k][l]);
+				pa.addScaledVector(link.U[k], link.Dinv[k][l] * link.u[l]);
+			}
+		}
+		pa += Ia * link.c;
+		links[link.parent].IA += Ia;
+		links[link.parent].pA += pa;
+	}
+
+	//and finally, from the roots to the leaves, the accelerations
+	for (uint i=0;i<links.size();i++){
+		FS_Link& link = links[i];
+		if (link.parent < 0){
+			if (link.dofCount == 6)
+				link.a = link.IA.solve(link.pA * (-1));
+			else
+				link.a.setToZero();
+			continue;
+		}
+		SpatialVector a = links[link.parent].a + link.c;
+		int n = link.dofCount;
+		double x[3];
+		for (int k=0;k<n;k++)
+			x[k] = link.u[k] - link.U[k].dotProductWith(a);
+		for (int k=0;k<n;k++){
+			link.qdd[k] = 0;
+			for (int l=0;l<n;l++)
+				link.qdd[k] += link.Dinv[k][l] * x[l];
+			a.addScaledVector(link.S[k], link.qdd[k]);
+		}
+		link.a = a;
+	}
+}
+
+/**
+	This method is used to integrate the joint and root velocities and positions (semi-implicit Euler), and to update the states of the rigid bodies.
+*/
+void FeatherstoneWorld::integrate(double deltaT){
+	for (uint i=0;i<links.size();i++){
+		FS_Link& link = links[i];
+		RigidBody* rb = link.rb;
+
+		if (link.parent < 0){
+			if (link.dofCount != 6)
+				continue;
+			link.v.addScaledVector(link.a, deltaT);
+			Vector3d w = link.v.w;
+			rb->state.angularVelocity = w;
+			rb->state.velocity = link.v.v + w.crossProductWith(Vector3d(rb->state.position));
+			rb->state.position += rb->state.velocity * deltaT;
+			double angle = w.length() * deltaT;
+			if (angle > 1e-12)
+				rb->state.orientation = Quaternion::getRotationQuaternion(angle, w / w.length()) * rb->state.orientation;
+			rb->state.orientation.toUnit();
+		}else{
+			for (int k=0;k<link.dofCount;k++)
+				link.qd[k] += link.qdd[k] * deltaT;
+			if (link.jointType == BALL_IN_SOCKET_JOINT){
+				//the joint velocity is the relative angular velocity in child coordinates
+				Vector3d w(link.qd[0], link.qd[1], link.qd[2]);
+				double angle = w.length() * deltaT;
+				if (angle > 1e-12)
+					link.qRel = link.qRel * Quaternion::getRotationQuaternion(angle, w / w.length());
+				link.qRel.toUnit();
+			}else{
+				for (int k=0;k<link.dofCount;k++)
+					link.q[k] += link.qd[k] * deltaT;
+			}
+			setBodyPoseFromJoint(i);
+			computeJointMotion(i);
+		}
+	}
+}
+
+/**
+	This method is used to integrate the forward simulation in time.
+*/
+void FeatherstoneWorld::advanceInTime(double deltaT){
+	if( deltaT <= 0 )
+		return;
+
+	if (linksDirty)
+		buildLinks();
+
+	//the joint angles and velocities are read back from the states of the bodies, which may have been changed since the last step. This also
+	//projects the states of the bodies back onto the joints
+	for (uint i=0;i<links.size();i++){
+		if (links[i].parent < 0)
+			computeJointMotion(i);
+		else
+			readJointState(i);
+	}
+
+	computeLinkForces(deltaT);
+	computeAccelerations();
+	integrate(deltaT);
+
+	//the forces that were applied through the World interface only last for one step
+	for (uint i=0;i<links.size();i++)
+		links[i].fApplied.setToZero();
+
+	//now that the forces are known, the contacts are sorted by rigid body for the controllers
+	updateContactIndex();
+}
+
+/**
+	This method is used to restore the state of the world from the binary buffer.
+*/
+void FeatherstoneWorld::restoreState(BinaryBuffer* buffer){
+	World::restoreState(buffer);
+	//forces that were applied after the state was saved should not carry over to the restored simulation
+	for (uint i=0;i<links.size();i++)
+		links[i].fApplied.setToZero();
+}
+
+/**
+	this method applies a force to a rigid body, at the specified point. The point is specified in local coordinates,
+	and the force is also specified in local coordinates.
+*/
+void FeatherstoneWorld::applyRelForceTo(RigidBody* b, const Vector3d& f, const Point3d& p){
+	FS_Link* link = getLink(b);
+	if (!link)
+		return;
+	link->fApplied += SpatialVector::getForceAt(b->getWorldCoordinates(f), b->getWorldCoordinates(p));
+}
+
+/**
+	this method applies a force to a rigid body, at the specified point. The point is specified in local coordinates,
+	and the force is specified in world coordinates.
+*/
+void FeatherstoneWorld::applyForceTo(RigidBody* b, const Vector3d& f, const Point3d& p){
+	FS_Link* link = getLink(b);
+	if (!link)
+		return;
+	link->fApplied += SpatialVector::getForceAt(f, b->getWorldCoordinates(p));
+}
+
+/**
+	this method applies a torque to a rigid body. The torque is specified in world coordinates.
+*/
+void FeatherstoneWorld::applyTorqueTo(RigidBody* b, const Vector3d& t){
+	FS_Link* link = getLink(b);
+	if (!link)
+		return;
+	link->fApplied.w += t;
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <Physics/PhysicsDll.h>
+#include <Physics/World.h>
+#include <Physics/SpatialAlgebra.h>
+#include <Physics/CollisionDetectionPrimitive.h>
+#include <Physics/SphereCDP.h>
+#include <Physics/CapsuleCDP.h>
+#include <Physics/BoxCDP.h>
+#include <Physics/PlaneCDP.h>
+#include <Physics/HeightFieldCDP.h>
+#include <Physics/TriMeshCDP.h>
+#include <Physics/PreCollisionQuery.h>
+
+//this structure holds everything the articulated body algorithm needs to know about one simulated body. The root of a tree (a rigid body
+//that is not part of a figure, or the root of a figure) has 6 degrees of freedom and no joint, the others have the degrees of freedom of their
+//parent joint (3 at most)
+typedef struct FS_Link_struct{
+	//the rigid body, and the joint that connects it to its parent (NULL for a root)
+	RigidBody* rb;
+	Joint* joint;
+	int jointType;
+	//the index of the parent link, -1 for a root
+	int parent;
+	//the number of degrees of freedom of the joint
+	int dofCount;
+
+	//the joint angles (hinge and universal joints), or the orientation of the child relative to the parent (ball in socket and stiff joints)
+	double q[2];
+	Quaternion qRel;
+	//the joint velocities and accelerations, and the generalized forces from the joint limits. For a ball in socket joint, the velocities
+	//are the relative angular velocity, in child coordinates
+	double qd[3], qdd[3], tau[3];
+
+	//the motion subspace of the joint, and the rest of what the algorithm computes for it
+	SpatialVector S[3];
+	SpatialVector U[3];
+	double Dinv[3][3];
+	double u[3];
+
+	//the spatial velocity and acceleration of the body, its velocity-product acceleration and the external force that acts on it
+	SpatialVector v, a, c, fExt;
+	//the forces that were applied through the World interface since the last step
+	SpatialVector fApplied;
+	//the articulated inertia and bias force
+	SpatialMatrix IA;
+	SpatialVector pA;
+} FS_Link;
+
+PHYSICS_TEMPLATE( DynamicArray<FS_Link> )
+
+/*-------------------------------------------------------------------------------------------------------------------------------------------------*
+ * This class is an alternative to ODEWorld that simulates the articulated figures in reduced coordinates. Every figure is a tree of bodies whose  *
+ * state is the free motion of its root plus the angles of its joints, and it is stepped with Featherstone's articulated body algorithm, which is  *
+ * linear in the number of bodies. The joints can't drift apart, since the states of the bodies are always rebuilt from the joint angles. Rigid    *
+ * bodies that are not part of a figure are simulated as one-body trees.                                                                           *
+ * The contacts are resolved with a penalty model: every collision primitive of a moving body is sampled (the center of a sphere, the end points   *
+ * of a capsule, the corners of a box) and the samples are pushed out of the static geometry (planes, heightfields, triangle meshes, boxes,        *
+ * spheres and capsules of the locked bodies) by a spring and damper, with viscous friction that is capped by the Coulomb cone. Moving bodies      *
+ * don't collide with each other, and every triangle of a mesh is tested against every sample, so large meshes are slow. The joint limits of hinge *
+ * and universal joints are enforced with stiff springs; ball in socket joints are not limited.                                                    *
+ *-------------------------------------------------------------------------------------------------------------------------------------------------*/
+class PHYSICS_DECLSPEC FeatherstoneWorld : public World{
+private:
+	//the simulated bodies, in an order where every body comes after its parent
+	DynamicArray<FS_Link> links;
+	//the index of the link of every object of the world, -1 for the ones that are not simulated
+	DynamicArray<int> linkIndices;
+	//the locked bodies that are not part of a figure - they make up the static geometry the links collide with
+	DynamicArray<RigidBody*> staticBodies;
+	//the links are rebuilt before the next step whenever bodies or figures are added
+	bool linksDirty;
+
+	//this is the object that decides which pairs of bodies are checked for collisions
+	PreCollisionQuery* pcQuery;
+
+	//the parameters of the penalty model used for the contacts
+	double contactStiffness;
+	double contactDamping;
+	double frictionViscosity;
+	//and those of the springs that enforce the joint limits
+	double jointLimitStiffness;
+	double jointLimitDamping;
+
+	/**
+		This method is used to build the list of links from the objects and the articulated figures of the world.
+	*/
+	void buildLinks();
+
+	/**
+		This method is used to add a link for the rigid body, and returns its index.
+	*/
+	int addLink(RigidBody* rb, Joint* joint, int parent);
+
+	/**
+		This method is used to read the joint angles and velocities of link i from the states of its body and of its parent body. The state of
+		the body is then rebuilt from them, so that it is exactly consistent with the joint.
+	*/
+	void readJointState(int i);
+
+	/**
+		This method is used to set the orientation and the position of the body of link i from its joint angles and the state of its parent.
+	*/
+	void setBodyPoseFromJoint(int i);
+
+	/**
+		This method is used to compute the motion subspace of the joint of link i, and the velocity of its body.
+	*/
+	void computeJointMotion(int i);
+
+	/**
+		This method is used to compute the external forces that act on every link, as well as the joint limit torques.
+	*/
+	void computeLinkForces(double deltaT);
+
+	/**
+		This method is used to find the contacts of the collision primitive of a moving body with all the static bodies, and to add their forces
+		to its link.
+	*/
+	void collideWithStaticBodies(FS_Link& link, CollisionDetectionPrimitive* cdp);
+
+	/**
+		This method is used to find the contact of a sphere of radius r, centered at p, that is part of a moving body, with the primitive other of the
+		static body sb. The contact force is added to the link.
+	*/
+	void collideSample(FS_Link& link, const Point3d& p, double r, RigidBody* sb, CollisionDetectionPrimitive* other);
+
+	/**
+		This method is used to record a contact of the body of the link with the static body other, at point p, with normal n and penetration depth.
+	*/
+	void addContact(FS_Link& link, RigidBody* other, const Point3d& p, const Vector3d& n, double depth);
+
+	/**
+		This method computes the penalty forces of the contacts of the link, which were recorded starting at firstContact, and adds them to the link.
+		The contacts that don't push are dropped.
+	*/
+	void computeContactForces(FS_Link& link, int firstContact, double deltaT);
+
+	/**
+		Returns the mass that the body of the link opposes to a push at point p, in direction d, if it were on its own.
+	*/
+	double getEffectiveMass(FS_Link& link, const Point3d& p, const Vector3d& d);
+
+	/**
+		This method is used to run the articulated body algorithm, which gives the accelerations of all the links.
+	*/
+	void computeAccelerations();
+
+	/**
+		This method is used to integrate the joint and root velocities and positions, and to update the states of the rigid bodies.
+	*/
+	void integrate(double deltaT);
+
+	/**
+		Returns the link of the rigid body, or NULL if it is not simulated.
+	*/
+	inline FS_Link* getLink(RigidBody* rb){
+		if (linksDirty)
+			buildLinks();
+		if (rb == NULL || rb->id < 0 || rb->id >= (int)linkIndices.size() || linkIndices[rb->id] < 0)
+			return NULL;
+		return &links[linkIndices[rb->id]];
+	}
+
+protected:
+	// Destroy the world, it becomes unusable, but everything is clean
+	virtual void destroyWorld();
+
+public:
+	/**
+		default constructor
+	*/
+	FeatherstoneWorld();
+
+	/**
+		destructor
+	*/
+	virtual ~FeatherstoneWorld(void);
+
+	/**
+		This method reads a list of rigid bodies from the specified file.
+	*/
+	virtual void loadRBsFromFile(char* fName);
+
+	/**
+		This method adds one rigid body (articulated or not).
+	*/
+	virtual void addRigidBody( RigidBody* rigidBody_disown );
+
+	/**
+		This method adds one articulated figure.
+	*/
+	virtual void addArticulatedFigure( ArticulatedFigure* articulatedFigure_disown );
+
+	/**
+		This method replaces the object that decides which pairs of bodies are checked for collisions in this world. The world
+		takes ownership of the query object. Passing NULL means that the pairs are only filtered by the collision bitmasks of the bodies.
+	*/
+	void setPreCollisionQuery( PreCollisionQuery* pcQuery_disown );
+
+	/**
+		This method is used to set the parameters of the contact model: the stiffness and the damping of the spring that pushes a contact
+		point out (per contact point), and the viscosity of the friction, which is then capped by the friction coefficient.
+	*/
+	void setContactParameters(double stiffness, double damping, double frictionViscosity);
+
+	inline double getContactStiffness(){
+		return contactStiffness;
+	}
+
+	inline double getContactDamping(){
+		return contactDamping;
+	}
+
+	inline double getFrictionViscosity(){
+		return frictionViscosity;
+	}
+
+	/**
+		This method is used to set the stiffness and the damping of the springs that enforce the joint limits.
+	*/
+	void setJointLimitParameters(double stiffness, double damping);
+
+	inline double getJointLimitStiffness(){
+		return jointLimitStiffness;
+	}
+
+	inline double getJointLimitDamping(){
+		return jointLimitDamping;
+	}
+
+	/**
+		Returns the total number of degrees of freedom of the simulated bodies.
+	*/
+	int getDOFCount();
+
+	/**
+		This method is used to integrate the forward simulation in time.
+	*/
+	virtual void advanceInTime(double deltaT);
+
+	/**
+		This method is used to restore the state of the world from the binary buffer. The forces that were applied since the last step are discarded.
+	*/
+	virtual void restoreState(BinaryBuffer* buffer);
+
+	/**
+		this method applies a force to a rigid body, at the specified point. The point is specified in local coordinates,
+		and the force is also specified in local coordinates.
+	*/
+	virtual void applyRelForceTo(RigidBody* b, const Vector3d& f, const Point3d& p);
+
+	/**
+		this method applies a force to a rigid body, at the specified point. The point is specified in local coordinates,
+		and the force is specified in world coordinates.
+	*/
+	virtual void applyForceTo(RigidBody* b, const Vector3d& f, const Point3d& p);
+
+	/**
+		this method applies a torque to a rigid body. The torque is specified in world coordinates.
+	*/
+	virtual void applyTorqueTo(RigidBody* b, const Vector3d& t);
+
+};
@@ -0,0 +1,137 @@
+#include "HeightFieldCDP.h"
+#include <Physics/RigidBody.h>
+#ifndef HEADLESS
+#include <GLUtils/GLUtils.h>
+#endif
+
+HeightFieldCDP::HeightFieldCDP(const Point3d& center, double width, double depth, int xCount, int zCount, RigidBody* theBody) :
+	CollisionDetectionPrimitive( HEIGHTFIELD_CDP, theBody ), center(center) {
+	if (xCount < 2 || zCount < 2)
+		throwError("A heightfield needs at least 2x2 samples.");
+	if (width <= 0 || depth <= 0)
+		throwError("The size of a heightfield must be positive.");
+	this->width = width;
+	this->depth = depth;
+	this->xCount = xCount;
+	this->zCount = zCount;
+	heights.resize(xCount * zCount, 0);
+}
+
+HeightFieldCDP::~HeightFieldCDP(void){
+}
+
+/**
+	This method is used to set all the heights at once, one row of xCount samples at a time.
+*/
+void HeightFieldCDP::setHeights(DynamicArray<double>* newHeights){
+	if (newHeights->size() != heights.size())
+		throwError("Expected %d heights for the %dx%d heightfield, got %d.", heights.size(), xCount, zCount, newHeights->size());
+	heights = *newHeights;
+}
+
+/**
+	Returns the lowest sample of the heightfield.
+*/
+double HeightFieldCDP::getMinHeight() const{
+	double result = heights[0];
+	for (uint i=1;i<heights.size();i++)
+		if (heights[i] < result)
+			result = heights[i];
+	return result;
+}
+
+/**
+	Returns the highest sample of the heightfield.
+*/
+double HeightFieldCDP::getMaxHeight() const{
+	double result = heights[0];
+	for (uint i=1;i<heights.size();i++)
+		if (heights[i] > result)
+			result = heights[i];
+	return result;
+}
+
+/**
+	This method is used to get the height of the surface (in local coordinates) above the point (x, z) of the local x-z plane.
+*/
+bool HeightFieldCDP::getHeightAt(double x, double z, double* height) const{
+	double cellWidth = width / (xCount - 1);
+	double cellDepth = depth / (zCount - 1);
+	//the position of the point in the grid, in number of cells
+	double gx = (x - center.x + width / 2) / cellWidth;
+	double gz = (z - center.z + depth / 2) / cellDepth;
+	if (gx < 0 || gz < 0 || gx > xCount - 1 || gz > zCount - 1)
+		return false;
+
+	int i = (int)floor(gx);
+	int j = (int)floor(gz);
+	//the last row and column of samples belong to the cells before them
+	if (i == xCount - 1) i--;
+	if (j == zCount - 1) j--;
+	double dx = gx - i;
+	double dz = gz - j;
+
+	//every cell is made of two triangles, split along the diagonal that goes from (i+1, j) to (i, j+1)
+	double h;
+	if (dx + dz < 1){
+		double h0 = getHeight(i, j);
+		h = h0 + (getHeight(i+1, j) - h0) * dx + (getHeight(i, j+1) - h0) * dz;
+	}else{
+		double h0 = getHeight(i+1, j+1);
+		h = h0 + (getHeight(i+1, j) - h0) * (1 - dz) + (getHeight(i, j+1) - h0) * (1 - dx);
+	}
+
+	*height = h + center.y;
+	return true;
+}
+
+/**
+	This method is used to get the height of the surface in world coordinates, above the point that is passed in.
+*/
+bool HeightFieldCDP::getWorldHeightAt(const Point3d& worldPoint, double* height){
+	if (bdy == NULL)
+		return getHeightAt(worldPoint.x, worldPoint.z, height);
+	Point3d p = bdy->getLocalCoordinates(worldPoint);
+	if (!getHeightAt(p.x, p.z, height))
+		return false;
+	p.y = *height;
+	*height = bdy->getWorldCoordinates(p).y;
+	return true;
+}
+
+/**
+	Draw the surface of the heightfield
+*/
+void HeightFieldCDP::draw(){
+#ifndef HEADLESS
+	double cellWidth = width / (xCount - 1);
+	double cellDepth = depth / (zCount - 1);
+	double x0 = center.x - width / 2;
+	double z0 = center.z - depth / 2;
+
+	glBegin(GL_TRIANGLES);
+	for (int j=0;j<zCount-1;j++){
+		for (int i=0;i<xCount-1;i++){
+			Point3d p00(x0 + i * cellWidth, center.y + getHeight(i, j), z0 + j * cellDepth);
+			Point3d p10(x0 + (i+1) * cellWidth, center.y + getHeight(i+1, j), z0 + j * cellDepth);
+			Point3d p01(x0 + i * cellWidth, center.y + getHeight(i, j+1), z0 + (j+1) * cellDepth);
+			Point3d p11(x0 + (i+1) * cellWidth, center.y + getHeight(i+1, j+1), z0 + (j+1) * cellDepth);
+
+			Vector3d n = Vector3d(p00, p01).crossProductWith(Vector3d(p00, p10));
+			n.toUnit();
+			glNormal3d(n.x, n.y, n.z);
+			glVertex3d(p00.x, p00.y, p00.z);
+			glVertex3d(p01.x, p01.y, p01.z);
+			glVertex3d(p10.x, p10.y, p10.z);
+
+			n = Vector3d(p11, p10).crossProductWith(Vector3d(p11, p01));
+			n.toUnit();
+			glNormal3d(n.x, n.y, n.z);
+			glVertex3d(p11.x, p11.y, p11.z);
+			glVertex3d(p10.x, p10.y, p10.z);
+			glVertex3d(p01.x, p01.y, p01.z);
+		}
+	}
+	glEnd();
+#endif
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Utils/Utils.h>
+
+#include <MathLib/Point3d.h>
+#include <MathLib/Vector3d.h>
+
+#include <Physics/PhysicsDll.h>
+#include <Physics/CollisionDetectionPrimitive.h>
+
+/*========================================================================================================================================================================*
+ * This class implements a heightfield that will be used as a collision detection primitive for uneven terrain. The heights are sampled on a regular grid that lies in   *
+ * the x-z plane of the rigid body, centered at the given point. Sample (i, j) is at x = center.x - width/2 + i * width/(xCount-1), z = center.z - depth/2 +              *
+ * j * depth/(zCount-1), and every grid cell is split into two triangles, the same way ODE does it, so that the heights reported here match the ones that are collided  *
+ * with. NOTE: like planes, heightfields can only be used by static objects, and the heights can't be changed once the body is in a world.                              *
+ *========================================================================================================================================================================*/
+class PHYSICS_DECLSPEC HeightFieldCDP : public CollisionDetectionPrimitive{
+private:
+	//the center of the grid, expressed in local coordinates
+	Point3d center;
+	//the size of the grid along x and z
+	double width, depth;
+	//the number of samples along x and z
+	int xCount, zCount;
+	//the heights, relative to center.y, stored one row of xCount samples at a time
+	DynamicArray<double> heights;
+
+public:
+	HeightFieldCDP(const Point3d& center, double width, double depth, int xCount, int zCount, RigidBody* theBody = NULL);
+	virtual ~HeightFieldCDP(void);
+
+	virtual char* save() { return "HeightFieldCDP"; }
+
+	virtual void updateToWorldPrimitive(){}
+
+	/**
+		Draw the surface of the heightfield
+	*/
+	virtual void draw();
+
+	const Point3d& getCenter() const { return center; }
+	inline double getWidth() const { return width; }
+	inline double getDepth() const { return depth; }
+	inline int getXCount() const { return xCount; }
+	inline int getZCount() const { return zCount; }
+
+	/**
+		These methods are used to access the height of sample (i, j).
+	*/
+	inline double getHeight(int i, int j) const {
+		return heights[i + j * xCount];
+	}
+
+	inline void setHeight(int i, int j, double h){
+		if (i<0 || i>=xCount || j<0 || j>=zCount)
+			throwError("Sample (%d, %d) is outside of the %dx%d heightfield.", i, j, xCount, zCount);
+		heights[i + j * xCount] = h;
+	}
+
+	/**
+		This method is used to set all the heights at once, one row of xCount samples at a time.
+	*/
+	void setHeights(DynamicArray<double>* newHeights);
+
+	/**
+		Returns the array of heights, one row of xCount samples at a time.
+	*/
+	inline const double* getHeightData() const {
+		return &heights[0];
+	}
+
+	/**
+		These methods return the lowest and highest samples of the heightfield.
+	*/
+	double getMinHeight() const;
+	double getMaxHeight() const;
+
+	/**
+		This method is used to get the height of the surface (in local coordinates) above the point (x, z) of the local x-z plane. This
+		is a constant time lookup. Returns false if the point is not over the heightfield.
+	*/
+	bool getHeightAt(double x, double z, double* height) const;
+
+	/**
+		This method is used to get the height of the surface in world coordinates, above the point that is passed in. Returns false if
+		the point is not over the heightfield.
+	*/
+	bool getWorldHeightAt(const Point3d& worldPoint, double* height);
+
+	virtual int computeCollisionsWith(CollisionDetectionPrimitive* other,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithSphereCDP(SphereCDP* sp,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithPlaneCDP(PlaneCDP* sp,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithCapsuleCDP(CapsuleCDP* c,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithBoxCDP(BoxCDP* sp,  DynamicArray<ContactPoint> *cps){return 0;}
+};
@@ -11,6 +11,7 @@
 class Joint;
 class PHYSICS_DECLSPEC HingeJoint : public Joint{
 friend class ODEWorld;
+friend class FeatherstoneWorld;
 private:
 /**
 	Quantities that do not change
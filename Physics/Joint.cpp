@@ -44,6 +44,16 @@ Joint::~Joint(void){
 
 }
 
+/**
+	This method sets the name of the joint, and lets the articulated figure it belongs to know that it was renamed. The joints of a figure
+	are those of its articulated rigid bodies, so the figure is the one of the child.
+*/
+void Joint::setName( const char* name ){
+	strncpy( this->name, name, 99 );
+	if (child != NULL && child->getAFParent() != NULL)
+		child->getAFParent()->namesChanged();
+}
+
 /**
 	This method is used to compute the relative orientation between the parent and the child rigid bodies, expressed in 
 	the frame coordinate of the parent.
@@ -84,6 +94,8 @@ void Joint::fixJointConstraints(bool fixOrientations, bool fixVelocities, bool r
 
 		//the location of the child's CM is now: pCM - rp + rc
 		child->state.position = parent->state.position + (rc - rp);
+		//this also covers the orientation and the velocity that may be fixed here
+		child->state.markModified();
 
 		//fix the velocities, if need be
 		if (fixVelocities){
@@ -51,6 +51,7 @@ friend class StiffJoint;
 friend class HingeJoint;
 friend class UniversalJoint;
 friend class ODEWorld;
+friend class FeatherstoneWorld;
 friend class Character;
 friend class SimBiController;
 friend class IKVMCController;
@@ -202,9 +203,7 @@ public:
 	/**
 		sets the name
 	*/
-	inline void setName( const char* name ) {
-		strncpy( this->name, name, 99 );
-	}
+	void setName( const char* name );
 
 
 };
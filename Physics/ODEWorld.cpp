@@ -6,11 +6,49 @@
 #include <Physics/UniversalJoint.h>
 #include <Physics/BallInSocketJoint.h>
 #include <Physics/PhysicsGlobals.h>
+#include <Physics/ArticulatedFigure.h>
+#include <algorithm>
+
+int ODEWorld::odeWorldCount = 0;
+
+/**
+	ODE keeps the OPCODE colliders that test geoms against triangle meshes in static members of dxTriMesh, so two worlds that are stepped
+	on different threads (see RolloutBatch) must not collide against triangle meshes at the same time. This lock makes them take turns.
+	The other collisions don't share any state, and are not serialized.
+*/
+static struct TriMeshCollisionLock {
+	CRITICAL_SECTION cs;
+	TriMeshCollisionLock(){ InitializeCriticalSection(&cs); }
+	~TriMeshCollisionLock(){ DeleteCriticalSection(&cs); }
+} triMeshCollisionLock;
 
 /**
 	Default constructor
 */
 ODEWorld::ODEWorld() : World(){
+	if (odeWorldCount++ == 0)
+		dInitODE();
+	//the solver settings survive destroyAllObjects, so they are initialized here rather than in setupWorld
+	solverMode = SOLVER_DIRECT;
+	quickStepIterations = 20;
+	quickStepSOR = 1.3;
+	autoSolverThreshold = 60;
+	islandThreads = 0;
+	//as well as the sleeping settings
+	autoDisable = false;
+	autoDisableLinearThreshold = 0.05;
+	autoDisableAngularThreshold = 0.05;
+	autoDisableTime = 0.5;
+	//and so do the collision detection settings
+	broadPhase = BROADPHASE_HASH;
+	quadTreeCenter = Point3d(0, 0, 0);
+	quadTreeExtents = Vector3d(64, 16, 64);
+	quadTreeDepth = 5;
+	selfCollisions = false;
+	//the simulation is only repeatable when asked for, and nobody is keeping track of the hashes yet
+	deterministic = false;
+	hashLogMode = HASH_LOG_OFF;
+	firstDivergentStep = -1;
 	setupWorld();
 }
 
@@ -19,18 +57,39 @@ ODEWorld::ODEWorld() : World(){
 */
 ODEWorld::~ODEWorld(void){
 	//destroy the ODE physical world, simulation space and joint group
-	
-	dCloseODE();
+	destroyWorld();
+
+	//only shut ODE down once the last world is gone, the other ones still need it
+	if (--odeWorldCount == 0)
+		dCloseODE();
 }
 
 
 void ODEWorld::destroyWorld() {
 	delete[] cps;
+	cps = NULL;
 	delete pcQuery;
+	pcQuery = NULL;
 	dJointGroupDestroy(contactGroupID);
+	//the static space and the spaces of the figures are destroyed along with the top level space
 	dSpaceDestroy(spaceID);
+	figureSpaces.clear();
+	collisionPairs.clear();
+	jointParentBodies.clear();
+	jointChildBodies.clear();
+	for (uint i=0;i<heightfieldData.size();i++)
+		dGeomHeightfieldDataDestroy(heightfieldData[i]);
+	heightfieldData.clear();
+	for (uint i=0;i<triMeshData.size();i++)
+		dGeomTriMeshDataDestroy(triMeshData[i]);
+	triMeshData.clear();
 	dWorldDestroy(worldID);	
 	odeToRbs.clear();
+	materials.clear();
+	materialPairSurfaces.clear();
+	for (uint i=0;i<jointFeedbackBlocks.size();i++)
+		delete [] jointFeedbackBlocks[i];
+	jointFeedbackBlocks.clear();
 	World::destroyWorld();
 }
 
@@ -42,25 +101,117 @@ void ODEWorld::setupWorld() {
 	//set a few of the constants that ODE needs to be aware of
 	dWorldSetContactSurfaceLayer(worldID,0.001);							// the ammount of interpenetration allowed between objects
 	dWorldSetContactMaxCorrectingVel(worldID, 1.0);							// maximum velocity that contacts are allowed to generate  
+	dWorldSetQuickStepNumIterations(worldID, quickStepIterations);			// only used by the QuickStep solver
+	dWorldSetQuickStepW(worldID, quickStepSOR);
+	dWorldSetIslandThreads(worldID, islandThreads);
 
 	//set the gravity...
 	Vector3d gravity = PhysicsGlobals::up * PhysicsGlobals::gravity;
 	dWorldSetGravity(worldID, gravity.x, gravity.y, gravity.z);	
 	
-	//Initialize the world, simulation space and joint groups
-    spaceID = dHashSpaceCreate(0);
+	//Initialize the world, simulation spaces and joint groups
+	createCollisionSpaces();
 	contactGroupID = dJointGroupCreate(0);
 
-	//make sure that when we destroy the space group, we destroy all the geoms inside it
-	dSpaceSetCleanup(spaceID, 1);
-
 	//allocate the space for the contacts;
 	maxContactCount = maxCont;
 	cps = new dContact[maxContactCount];
+	jointFeedbackCount = 0;
+	lastStepUsedQuickStep = false;
 
+	//there is no query by default: the bitmasks, the spaces and the checks in processCollisions do all the filtering
 	pcQuery = NULL;
+}
 
-	pcQuery = new PreCollisionQuery();
+/**
+	This method is used to create the top level space, of the kind that was asked for, and the static space that goes in it.
+*/
+void ODEWorld::createCollisionSpaces(){
+	switch (broadPhase){
+		case BROADPHASE_QUADTREE:{
+			dVector3 center = {quadTreeCenter.x, quadTreeCenter.y, quadTreeCenter.z};
+			dVector3 extents = {quadTreeExtents.x, quadTreeExtents.y, quadTreeExtents.z};
+			//the tree splits the plane that is perpendicular to the up axis
+			int upAxis = 1;
+			if (fabs(PhysicsGlobals::up.x) > fabs(PhysicsGlobals::up.y) && fabs(PhysicsGlobals::up.x) > fabs(PhysicsGlobals::up.z))
+				upAxis = 0;
+			else if (fabs(PhysicsGlobals::up.z) > fabs(PhysicsGlobals::up.y))
+				upAxis = 2;
+			spaceID = dQuadTreeSpaceCreateUp(0, center, extents, quadTreeDepth, upAxis);
+			break;
+		}
+		case BROADPHASE_SAP:
+			spaceID = dSweepAndPruneSpaceCreate(0, dSAP_AXES_XZY);
+			break;
+		default:
+			spaceID = dHashSpaceCreate(0);
+	}
+	//make sure that when we destroy the space group, we destroy all the geoms inside it
+	dSpaceSetCleanup(spaceID, 1);
+
+	//the locked bodies don't move, and they are never checked against each other, so a hash space is good enough for them
+	staticSpaceID = dHashSpaceCreate(spaceID);
+	dSpaceSetCleanup(staticSpaceID, 1);
+}
+
+/**
+	This method returns the space that the geoms of the rigid body that is passed in should go into.
+*/
+dSpaceID ODEWorld::getCollisionSpace(RigidBody* body){
+	if (body->isLocked())
+		return staticSpaceID;
+
+	ArticulatedFigure* af = body->getAFParent();
+	if (af == NULL)
+		return spaceID;
+
+	for (uint i=0;i<AFs.size();i++){
+		if (AFs[i] != af)
+			continue;
+		while (figureSpaces.size() <= i)
+			figureSpaces.push_back(NULL);
+		//a figure only has a handful of geoms, so a simple space is all it takes
+		if (figureSpaces[i] == NULL){
+			figureSpaces[i] = dSimpleSpaceCreate(spaceID);
+			dSpaceSetCleanup(figureSpaces[i], 1);
+		}
+		return figureSpaces[i];
+	}
+
+	//the figure is not part of this world...
+	return spaceID;
+}
+
+/**
+	This method is used to select the kind of space used at the top level of the collision detection (one of the BroadPhase values).
+*/
+void ODEWorld::setBroadPhase(int broadPhase){
+	if (broadPhase < BROADPHASE_HASH || broadPhase > BROADPHASE_SAP)
+		throwError("Unknown broad phase: %d.", broadPhase);
+	if (broadPhase == this->broadPhase)
+		return;
+	if (objects.size() > 0)
+		throwError("The broad phase can only be changed while the world is empty.");
+	this->broadPhase = broadPhase;
+	dSpaceDestroy(spaceID);
+	createCollisionSpaces();
+}
+
+/**
+	This method is used to set the region covered by the quadtree (center and half-sizes), and its depth.
+*/
+void ODEWorld::setQuadTreeBounds(const Point3d& center, const Vector3d& extents, int depth){
+	if (depth < 0)
+		throwError("The depth of the quadtree should be >= 0.");
+	if (objects.size() > 0)
+		throwError("The bounds of the quadtree can only be changed while the world is empty.");
+	quadTreeCenter = center;
+	quadTreeExtents = extents;
+	quadTreeDepth = depth;
+	if (broadPhase == BROADPHASE_QUADTREE){
+		dSpaceDestroy(spaceID);
+		createCollisionSpaces();
+	}
 }
 
 void ODEWorld::destroyAllObjects() {
@@ -69,12 +220,28 @@ void ODEWorld::destroyAllObjects() {
 }
 
 /**
-	this method is used to copy the state of the ith rigid body to its ode counterpart.
+	This method installs an object that decides which pairs of bodies are checked for collisions in this world, on top of the
+	collision bitmasks. The world takes ownership of the query object. There is none by default (NULL), which is the fast path:
+	the pairs are filtered by the bitmasks, the bodies of a figure are kept apart unless self-collisions are on, and the bodies that
+	are connected by a joint are never checked.
+*/
+void ODEWorld::setPreCollisionQuery( PreCollisionQuery* pcQuery ) {
+	if (this->pcQuery == pcQuery)
+		return;
+	delete this->pcQuery;
+	this->pcQuery = pcQuery;
+}
+
+/**
+	this method is used to copy the state of the ith rigid body to its ode counterpart. The orientation is normalized on the way,
+	unless exact is true, in which case it is copied bit for bit (which is what restoring a saved state needs).
 */
-void ODEWorld::setODEStateFromRB(int i){
+void ODEWorld::setODEStateFromRB(int i, bool exact){
 	if (i<0 || (uint)i>=odeToRbs.size())
 		return;
 
+	odeToRbs[i].syncedVersion = odeToRbs[i].rb->state.version;
+
 	//if it is a locked object, we update its CDPS
 	if (odeToRbs[i].rb->isLocked() == true) {
 
@@ -98,11 +265,70 @@ void ODEWorld::setODEStateFromRB(int i){
 	tempQ[3] = odeToRbs[i].rb->state.orientation.v.z;
 	
 	dBodySetPosition(odeToRbs[i].id, odeToRbs[i].rb->state.position.x, odeToRbs[i].rb->state.position.y, odeToRbs[i].rb->state.position.z);
-	dBodySetQuaternion(odeToRbs[i].id, tempQ);
+	//ODE normalizes the orientations itself after every step, so normalizing them again here would change their last bits
+	if (exact)
+		dBodySetQuaternionNoNormalize(odeToRbs[i].id, tempQ);
+	else
+		dBodySetQuaternion(odeToRbs[i].id, tempQ);
 	dBodySetLinearVel(odeToRbs[i].id, odeToRbs[i].rb->state.velocity.x, odeToRbs[i].rb->state.velocity.y, odeToRbs[i].rb->state.velocity.z);
 	dBodySetAngularVel(odeToRbs[i].id, odeToRbs[i].rb->state.angularVelocity.x, odeToRbs[i].rb->state.angularVelocity.y, odeToRbs[i].rb->state.angularVelocity.z);
 }
 
+/**
+	This method is used to pass the auto-disable settings of the world on to the ode body that is passed in.
+*/
+void ODEWorld::setupODEAutoDisable(dBodyID id){
+	dBodySetAutoDisableLinearThreshold(id, autoDisableLinearThreshold);
+	dBodySetAutoDisableAngularThreshold(id, autoDisableAngularThreshold);
+	dBodySetAutoDisableTime(id, autoDisableTime);
+	//the idle time is what counts, and the velocities are looked at step by step rather than averaged
+	dBodySetAutoDisableSteps(id, 1);
+	dBodySetAutoDisableAverageSamplesCount(id, 1);
+	dBodySetAutoDisableFlag(id, autoDisable?1:0);
+}
+
+/**
+	This method is used to turn the automatic sleeping of resting bodies on or off.
+*/
+void ODEWorld::setAutoDisable(bool autoDisable){
+	this->autoDisable = autoDisable;
+	for (uint i=0;i<odeToRbs.size();i++)
+		if (odeToRbs[i].id != NULL && !odeToRbs[i].rb->isArticulated())
+			setupODEAutoDisable(odeToRbs[i].id);
+}
+
+/**
+	This method is used to set how slow a body needs to be moving, and for how long, before it falls asleep.
+*/
+void ODEWorld::setAutoDisableThresholds(double linearVelocity, double angularVelocity, double idleTime){
+	if (linearVelocity < 0 || angularVelocity < 0 || idleTime < 0)
+		throwError("The auto-disable thresholds should be >= 0.");
+	autoDisableLinearThreshold = linearVelocity;
+	autoDisableAngularThreshold = angularVelocity;
+	autoDisableTime = idleTime;
+	for (uint i=0;i<odeToRbs.size();i++)
+		if (odeToRbs[i].id != NULL && !odeToRbs[i].rb->isArticulated())
+			setupODEAutoDisable(odeToRbs[i].id);
+}
+
+/**
+	This method returns true if the rigid body that is passed in was put to sleep.
+*/
+bool ODEWorld::isAsleep(RigidBody* rb){
+	if (rb == NULL || rb->isLocked() || rb->id < 0 || (uint)rb->id >= odeToRbs.size() || odeToRbs[rb->id].id == NULL)
+		return false;
+	return !dBodyIsEnabled(odeToRbs[rb->id].id);
+}
+
+/**
+	This method is used to wake up the rigid body that is passed in, if it was put to sleep.
+*/
+void ODEWorld::wakeUp(RigidBody* rb){
+	if (rb == NULL || rb->isLocked() || rb->id < 0 || (uint)rb->id >= odeToRbs.size())
+		return;
+	wakeUp(odeToRbs[rb->id].id);
+}
+
 /**
 	this method is used to copy the state of the ith rigid body, from the ode object to its rigid body counterpart 
 */
@@ -163,7 +389,52 @@ dGeomID ODEWorld::getPlaneGeom(PlaneCDP* p, RigidBody* parent){
 	//and create the ground plane
 	Vector3d n = parent->getWorldCoordinates(p->getNormal());
 	Vector3d o = Vector3d(parent->getWorldCoordinates(p->getOrigin()));
-	dGeomID g = dCreatePlane(spaceID, n.x, n.y, n.z, o.dotProductWith(n));
+	dGeomID g = dCreatePlane(getCollisionSpace(parent), n.x, n.y, n.z, o.dotProductWith(n));
+	return g;
+}
+
+/**
+	this method is used to set up an ODE heightfield geom. Like planes, heightfields are placed in world coordinates once and for all.
+*/
+dGeomID ODEWorld::getHeightFieldGeom(HeightFieldCDP* h, RigidBody* parent){
+	dHeightfieldDataID data = dGeomHeightfieldDataCreate();
+	heightfieldData.push_back(data);
+	//ODE keeps its own copy of the heights, and the heightfield is given some thickness, so that fast bodies can't go through it
+	dGeomHeightfieldDataBuildDouble(data, h->getHeightData(), 1, h->getWidth(), h->getDepth(), h->getXCount(), h->getZCount(), 1, 0, 1, 0);
+	dGeomHeightfieldDataSetBounds(data, h->getMinHeight(), h->getMaxHeight());
+
+	dGeomID g = dCreateHeightfield(getCollisionSpace(parent), data, 1);
+	//ODE's heightfields are centered on their origin, just like ours are centered on h->getCenter()
+	Point3d c = parent->getWorldCoordinates(h->getCenter());
+	dGeomSetPosition(g, c.x, c.y, c.z);
+	dQuaternion q;
+	q[0] = parent->state.orientation.s;
+	q[1] = parent->state.orientation.v.x;
+	q[2] = parent->state.orientation.v.y;
+	q[3] = parent->state.orientation.v.z;
+	dGeomSetQuaternion(g, q);
+	return g;
+}
+
+/**
+	this method is used to set up an ODE triangle mesh geom. Like planes, triangle meshes are placed in world coordinates once and for all.
+*/
+dGeomID ODEWorld::getTriMeshGeom(TriMeshCDP* m, RigidBody* parent){
+	if (m->getTriangleCount() == 0)
+		throwError("The triangle mesh of rigid body %s is empty.", parent->name);
+	dTriMeshDataID data = dGeomTriMeshDataCreate();
+	triMeshData.push_back(data);
+	//ODE does not copy the triangles, it builds its bounding volume hierarchy over the arrays of the primitive, which lives as long as the world
+	dGeomTriMeshDataBuildDouble(data, m->getVertexData(), 3 * sizeof(double), m->getVertexCount(), m->getIndexData(), 3 * m->getTriangleCount(), 3 * sizeof(int));
+
+	dGeomID g = dCreateTriMesh(getCollisionSpace(parent), data, NULL, NULL, NULL);
+	dGeomSetPosition(g, parent->state.position.x, parent->state.position.y, parent->state.position.z);
+	dQuaternion q;
+	q[0] = parent->state.orientation.s;
+	q[1] = parent->state.orientation.v.x;
+	q[2] = parent->state.orientation.v.y;
+	q[3] = parent->state.orientation.v.z;
+	dGeomSetQuaternion(g, q);
 	return g;
 }
 
@@ -345,6 +616,16 @@ void ODEWorld::createODECollisionPrimitives(RigidBody* body, int index){
 				//NOTE: only static objects can have planes as their collision primitives - if this isn't static, force it!!
 				g = getPlaneGeom((PlaneCDP*)body->cdps[j], body);
 				break;
+			case HEIGHTFIELD_CDP:
+				if (body->isLocked() == false)
+					throwError("Only static rigid bodies can have heightfields as collision primitives (rb: %s).", body->name);
+				g = getHeightFieldGeom((HeightFieldCDP*)body->cdps[j], body);
+				break;
+			case TRIMESH_CDP:
+				if (body->isLocked() == false)
+					throwError("Only static rigid bodies can have triangle meshes as collision primitives (rb: %s).", body->name);
+				g = getTriMeshGeom((TriMeshCDP*)body->cdps[j], body);
+				break;
 			default:
 				throwError("Ooppps... No collision detection primitive was created rb: %s, cdp: %d", body->name, j);
 		}
@@ -352,18 +633,30 @@ void ODEWorld::createODECollisionPrimitives(RigidBody* body, int index){
 		//now associate the geom to the rigid body that it belongs to, so that we can look up the properties we need later...
 		dGeomSetData(g, body);
 
-		//if it's a plane, it means it must be static, so we can't attach a transform to it...
-		if (cdpType == PLANE_CDP)
+		//the pairs that are filtered out by the bitmasks are rejected by ODE in the broad phase, before they get to processCollisions
+		uint categoryBits = body->cdps[j]->getEffectiveCategoryBits();
+		uint collideBits = body->cdps[j]->getEffectiveCollideBits();
+		dGeomSetCategoryBits(g, categoryBits);
+		dGeomSetCollideBits(g, collideBits);
+
+		//if it's a plane, a heightfield or a triangle mesh, it means it must be static, so we can't attach a transform to it...
+		if (cdpType == PLANE_CDP || cdpType == HEIGHTFIELD_CDP || cdpType == TRIMESH_CDP){
+			odeToRbs[index].geoms.push_back(g);
 			continue;
+		}
 
 		//now we've created a geom for the current body. Note: g will be rotated relative to t, so that it is positioned
 		//well in body coordinates, and then t will be attached to the body.
-		dGeomID t = dCreateGeomTransform(spaceID);
+		dGeomID t = dCreateGeomTransform(getCollisionSpace(body));
 		//make sure that when we destroy the transfromation, we destroy the encapsulated objects as well.
 		dGeomTransformSetCleanup(t, 1);
 
 		//associate the transform geom with the body as well
 		dGeomSetData(t, body);
+		odeToRbs[index].geoms.push_back(t);
+		//the transform is what the space sees, so it needs the bitmasks too
+		dGeomSetCategoryBits(t, categoryBits);
+		dGeomSetCollideBits(t, collideBits);
 
 		//if the object is fixed, then we want the geometry to take into account the initial position and orientation of the rigid body
 		if (body->isLocked() == true){
@@ -402,7 +695,7 @@ void ODEWorld::loadRBsFromFile(char* fName){
 		// Add a placeholder in the odeToRbs mapping
 		odeToRbs.push_back(ODE_RB_Map(0, rigidBody));
 		if( !rigidBody->isArticulated() )
-			linkRigidBodyToODE(objects.size()-1);
+			linkRigidBodyToODE(i);
 	}
 
 	DynamicArray<Joint*> joints;
@@ -502,6 +795,32 @@ void ODEWorld::addArticulatedFigure(ArticulatedFigure* articulatedFigure){
 				throwError("Ooops.... Only BallAndSocket, Hinge, Universal and Stiff joints are currently supported.\n");
 		}
 	}
+
+	//the new joints need to be part of the actuation plan
+	buildJointActuationPlan();
+}
+
+/**
+	This method copies the new collision bitmasks of the rigid body to its geoms, so that the broad phase uses them from the next step on.
+*/
+void ODEWorld::updateCollisionBits(RigidBody* rb){
+	int index = getRBIndex(rb);
+	//an articulated body has no geoms until its figure is added
+	if (index < 0 || (uint)index >= odeToRbs.size())
+		return;
+	//there is one geom per collision primitive, in the same order
+	for (uint j=0;j<odeToRbs[index].geoms.size() && j<rb->cdps.size();j++){
+		uint categoryBits = rb->cdps[j]->getEffectiveCategoryBits();
+		uint collideBits = rb->cdps[j]->getEffectiveCollideBits();
+		dGeomID g = odeToRbs[index].geoms[j];
+		dGeomSetCategoryBits(g, categoryBits);
+		dGeomSetCollideBits(g, collideBits);
+		//the geom that is wrapped in a transform was given the bitmasks too
+		if (dGeomGetClass(g) == dGeomTransformClass && dGeomTransformGetGeom(g) != NULL){
+			dGeomSetCategoryBits(dGeomTransformGetGeom(g), categoryBits);
+			dGeomSetCollideBits(dGeomTransformGetGeom(g), collideBits);
+		}
+	}
 }
 
 /**
@@ -510,13 +829,15 @@ void ODEWorld::addArticulatedFigure(ArticulatedFigure* articulatedFigure){
 void ODEWorld::linkRigidBodyToODE( int index ) {
 	
 	RigidBody* rigidBody = odeToRbs[index].rb; 
+	//the ODE counterpart starts out with the current state of the rigid body
+	odeToRbs[index].syncedVersion = rigidBody->state.version;
 
 	//CREATE AND LINK THE ODE BODY WITH OUR RIGID BODY
 	//if the body is fixed, we'll only create the colission detection primitives
+	//the ID of this rigid body will be its index in the mapping - locked bodies get one as well, although they have no ODE body
+	rigidBody->setBodyID( index );
 	if (!rigidBody->isLocked()){
 		odeToRbs[index].id = dBodyCreate(worldID);
-		//the ID of this rigid body will be its index in the 
-		rigidBody->setBodyID( index );
 		//we will use the user data of the object to store the index in this mapping as well, for easy retrieval
 		dBodySetData(odeToRbs[index].id, (void*)index);
 	}
@@ -527,9 +848,17 @@ void ODEWorld::linkRigidBodyToODE( int index ) {
 		dJointAttach(j, odeToRbs[index].id, 0);
 	}
 
+	//props can fall asleep once they come to rest - the bodies of the figures are driven by their controllers, so they never do
+	if (!rigidBody->isLocked() && !rigidBody->isArticulated())
+		setupODEAutoDisable(odeToRbs[index].id);
+
 	//PROCESS THE COLLISION PRIMITIVES OF THE BODY
 	createODECollisionPrimitives(rigidBody, index);
 
+	//the body may have been assigned a material by some other world, so it gets one from this world
+	rigidBody->props.materialID = -1;
+	assignMaterial(rigidBody);
+
 	//SET THE INERTIAL PARAMETERS
 
 	if (rigidBody->isLocked() == false){
@@ -551,6 +880,118 @@ void ODEWorld::linkRigidBodyToODE( int index ) {
 
 }
 
+/**
+	This method is used to assign a material to the rigid body, based on its contact properties. A new material is created if none of
+	the existing ones match, in which case the table of surface parameters is rebuilt.
+*/
+void ODEWorld::assignMaterial(RigidBody* rb){
+	for (uint i=0;i<materials.size();i++){
+		if (materials[i].mu == rb->props.mu && materials[i].epsilon == rb->props.epsilon && 
+			materials[i].groundSoftness == rb->props.groundSoftness && materials[i].groundPenalty == rb->props.groundPenalty){
+			rb->props.materialID = i;
+			return;
+		}
+	}
+
+	ODE_Material material;
+	material.mu = rb->props.mu;
+	material.epsilon = rb->props.epsilon;
+	material.groundSoftness = rb->props.groundSoftness;
+	material.groundPenalty = rb->props.groundPenalty;
+	materials.push_back(material);
+	rb->props.materialID = materials.size() - 1;
+
+	buildMaterialPairSurfaces();
+}
+
+/**
+	This method is used to rebuild the surface parameters for every pair of materials. We use the minimum of the two coefficients of friction
+	and of the two coefficients of restitution, while the softness and penalty of the contact come from the first body.
+*/
+void ODEWorld::buildMaterialPairSurfaces(){
+	uint n = materials.size();
+	materialPairSurfaces.resize(n * n);
+	for (uint i=0;i<n;i++){
+		for (uint j=0;j<n;j++){
+			dSurfaceParameters& surface = materialPairSurfaces[i * n + j];
+			memset(&surface, 0, sizeof(dSurfaceParameters));
+			surface.mode = dContactSoftERP | dContactSoftCFM | dContactApprox1 | dContactBounce;
+			surface.mu = min(materials[i].mu, materials[j].mu);
+			surface.bounce = min(materials[i].epsilon, materials[j].epsilon);
+			surface.bounce_vel = 0.00001;
+
+			surface.soft_cfm = materials[i].groundSoftness;
+			surface.soft_erp = materials[i].groundPenalty;
+		}
+	}
+}
+
+/**
+	This method is used to build the joint actuation plan, from the joints of the world.
+*/
+void ODEWorld::buildJointActuationPlan(){
+	jointParentBodies.resize(jts.size());
+	jointChildBodies.resize(jts.size());
+	for (uint j=0;j<jts.size();j++){
+		RigidBody* parent = jts[j]->parent;
+		RigidBody* child = jts[j]->child;
+		jointParentBodies[j] = (parent->isLocked())?(NULL):(odeToRbs[parent->id].id);
+		jointChildBodies[j] = (child->isLocked())?(NULL):(odeToRbs[child->id].id);
+	}
+}
+
+/**
+	This method is used to apply the torques of all the joints to their parent and child bodies, following the joint actuation plan.
+*/
+void ODEWorld::applyJointTorques(){
+	//the figures may have been loaded through the base class, which doesn't know about the plan
+	if (jointParentBodies.size() != jts.size())
+		buildJointActuationPlan();
+
+	int jointCount = jts.size();
+	for (int j=0;j<jointCount;j++){
+		const Vector3d& t = jts[j]->torque;
+		//we will apply to the parent a positive torque, and to the child a negative torque
+		if (jointParentBodies[j] != NULL)
+			dBodyAddTorque(jointParentBodies[j], t.x, t.y, t.z);
+		if (jointChildBodies[j] != NULL)
+			dBodyAddTorque(jointChildBodies[j], -t.x, -t.y, -t.z);
+	}
+}
+
+/**
+	This method is used to apply the external forces and torques of the rigid bodies to their ODE counterparts.
+*/
+void ODEWorld::applyExternalForces(){
+	//the mapping holds the rigid bodies in the same order as the objects, along with their ODE bodies (NULL for the locked ones)
+	for (uint j=0;j<odeToRbs.size();j++){
+		dBodyID id = odeToRbs[j].id;
+		if (id == NULL)
+			continue;
+		const Vector3d& f = odeToRbs[j].rb->externalForce;
+		if( !f.isZeroVector() ){
+			wakeUp(id);
+			dBodyAddForce(id, f.x, f.y, f.z);
+		}
+		const Vector3d& t = odeToRbs[j].rb->externalTorque;
+		if( !t.isZeroVector() ){
+			wakeUp(id);
+			dBodyAddTorque(id, t.x, t.y, t.z);
+		}
+	}
+}
+
+/**
+	This method returns the feedback structure for the ith contact joint of the current step. A new block of feedback structures is
+	allocated if needed.
+*/
+dJointFeedback* ODEWorld::getJointFeedback(int i){
+	int block = i / CONTACT_FEEDBACK_BLOCK_SIZE;
+	while ((int)jointFeedbackBlocks.size() <= block)
+		jointFeedbackBlocks.push_back(new dJointFeedback[CONTACT_FEEDBACK_BLOCK_SIZE]);
+	return &jointFeedbackBlocks[block][i % CONTACT_FEEDBACK_BLOCK_SIZE];
+}
+
 /**
 	this method is used to process the collision between the two objects passed in as parameters. More generally,
 	it is used to determine if the collision should take place, and if so, it calls the method that generates the
@@ -564,41 +1005,40 @@ void ODEWorld::processCollisions(dGeomID o1, dGeomID o2){
     rb1 = (RigidBody*) dGeomGetData(o1);
     rb2 = (RigidBody*) dGeomGetData(o2);
 
-	bool joined = b1 && b2 && dAreConnectedExcluding(b1, b2, dJointTypeContact);
+	//the spaces of the figures should keep the bodies of a figure apart already, but this does not rely on it
+	ArticulatedFigure* af = rb1->getAFParent();
+	if (af != NULL && af == rb2->getAFParent() && !selfCollisions)
+		return;
 
-	if (pcQuery)
+	//the bitmasks were already checked by ODE at this point - the query is only there for the rules that can't be expressed with them
+	if (pcQuery){
+		bool joined = b1 && b2 && dAreConnectedExcluding(b1, b2, dJointTypeContact);
 		if (pcQuery->shouldCheckForCollisions(rb1, rb2, joined) == false)
 			return;
-
-	//we'll use the minimum of the two coefficients of friction of the two bodies.
-	double mu1 = rb1->getFrictionCoefficient();
-	double mu2 = rb2->getFrictionCoefficient();
-	double mu_to_use = min(mu1, mu2);
-	double eps1 = rb1->getRestitutionCoefficient();
-	double eps2 = rb2->getRestitutionCoefficient();
-	double eps_to_use = min(eps1, eps2);
-
-	int num_contacts = dCollide(o1,o2,maxContactCount,&(cps[0].geom), sizeof(dContact));
-
-	double groundSoftness = 0, groundPenalty = 0;
-	if (rb1){
-		groundSoftness = rb1->props.groundSoftness;
-		groundPenalty = rb1->props.groundPenalty;
-	}else{
-		groundSoftness = rb2->props.groundSoftness;
-		groundPenalty = rb2->props.groundPenalty;
+	}else if (af != NULL && af == rb2->getAFParent()){
+		//only the bodies of a figure can be connected by joints, and the joint limits take care of those
+		if (b1 && b2 && dAreConnectedExcluding(b1, b2, dJointTypeContact))
+			return;
 	}
 
-	//fill in the missing properties for the contact points
-	for (int i=0;i<num_contacts;i++){
-		cps[i].surface.mode = dContactSoftERP | dContactSoftCFM | dContactApprox1 | dContactBounce;
-		cps[i].surface.mu = mu_to_use;
-		cps[i].surface.bounce = eps_to_use;
-		cps[i].surface.bounce_vel = 0.00001;
+	//sleeping bodies don't move, so there is nothing new to be found between them, or between them and the static objects
+	if ((b1 == NULL || !dBodyIsEnabled(b1)) && (b2 == NULL || !dBodyIsEnabled(b2)))
+		return;
 
-		cps[i].surface.soft_cfm = groundSoftness;
-		cps[i].surface.soft_erp = groundPenalty;
-	}
+	int num_contacts;
+	if (dGeomGetClass(o1) == dTriMeshClass || dGeomGetClass(o2) == dTriMeshClass){
+		EnterCriticalSection(&triMeshCollisionLock.cs);
+		num_contacts = dCollide(o1,o2,maxContactCount,&(cps[0].geom), sizeof(dContact));
+		LeaveCriticalSection(&triMeshCollisionLock.cs);
+	}else
+		num_contacts = dCollide(o1,o2,maxContactCount,&(cps[0].geom), sizeof(dContact));
+	if (num_contacts == 0)
+		return;
+
+	//the surface properties for this pair of materials were computed ahead of time
+	const dSurfaceParameters& surface = materialPairSurfaces[getMaterialID(rb1) * materials.size() + getMaterialID(rb2)];
+	for (int i=0;i<num_contacts;i++)
+		memcpy(&cps[i].surface, &surface, sizeof(dSurfaceParameters));
 
 	// and now add them contact points to the simulation
 	for (int i=0;i<num_contacts;i++){
@@ -606,23 +1046,78 @@ void ODEWorld::processCollisions(dGeomID o1, dGeomID o2){
 		dJointID c = dJointCreateContact(worldID, contactGroupID, &cps[i]);
 		dJointAttach(c, b1, b2);
 
-		if (jointFeedbackCount >= MAX_CONTACT_FEEDBACK)
-			tprintf("Warning: too many contacts are established. Some of them will not be reported.\n");
-		else{
-			if (contactPoints.size() != jointFeedbackCount){
-				tprintf("Warning: Contact forces need to be cleared after each simulation, otherwise the results are not predictable.\n");
-			}
-			contactPoints.push_back(ContactPoint());
-			//now we'll set up the feedback for this contact joint
-			contactPoints[jointFeedbackCount].rb1 = rb1;
-			contactPoints[jointFeedbackCount].rb2 = rb2;
-			contactPoints[jointFeedbackCount].cp = Point3d(cps[i].geom.pos[0], cps[i].geom.pos[1], cps[i].geom.pos[2]);
-			dJointSetFeedback(c,&(jointFeedback[jointFeedbackCount]));
-			jointFeedbackCount++;
+		if (contactPoints.size() != jointFeedbackCount){
+			tprintf("Warning: Contact forces need to be cleared after each simulation, otherwise the results are not predictable.\n");
 		}
+		//the contact points array keeps its memory from one step to the next, so this only allocates when there are more contacts than ever before
+		contactPoints.push_back(ContactPoint());
+		//now we'll set up the feedback for this contact joint
+		contactPoints[jointFeedbackCount].rb1 = rb1;
+		contactPoints[jointFeedbackCount].rb2 = rb2;
+		contactPoints[jointFeedbackCount].cp = Point3d(cps[i].geom.pos[0], cps[i].geom.pos[1], cps[i].geom.pos[2]);
+		dJointSetFeedback(c, getJointFeedback(jointFeedbackCount));
+		jointFeedbackCount++;
 	}
 }
 
+/**
+	This method returns the index of the rigid body that the geom belongs to, and the index of the geom among the geoms of that body.
+*/
+void ODEWorld::getGeomKey(dGeomID g, int* rbIndex, int* geomIndex){
+	RigidBody* rb = (RigidBody*) dGeomGetData(g);
+	*rbIndex = rb->id;
+	*geomIndex = -1;
+	DynamicArray<dGeomID>& geoms = odeToRbs[*rbIndex].geoms;
+	for (uint i=0;i<geoms.size();i++)
+		if (geoms[i] == g){
+			*geomIndex = i;
+			break;
+		}
+}
+
+/**
+	In deterministic mode, this method is used to keep the pair of geoms passed in until all the pairs of the step are known.
+*/
+void ODEWorld::addCollisionPair(dGeomID o1, dGeomID o2){
+	ODE_Collision_Pair pair;
+	getGeomKey(o1, &pair.rb1, &pair.geom1);
+	getGeomKey(o2, &pair.rb2, &pair.geom2);
+	pair.o1 = o1;
+	pair.o2 = o2;
+	//the broad phase may report the geoms of a pair in either order, so the one with the lowest key always goes first
+	if (pair.rb2 < pair.rb1 || (pair.rb2 == pair.rb1 && pair.geom2 < pair.geom1)){
+		std::swap(pair.o1, pair.o2);
+		std::swap(pair.rb1, pair.rb2);
+		std::swap(pair.geom1, pair.geom2);
+	}
+	collisionPairs.push_back(pair);
+}
+
+/**
+	This is the order the collision pairs are processed in, in deterministic mode.
+*/
+static bool collisionPairComesFirst(const ODE_Collision_Pair& a, const ODE_Collision_Pair& b){
+	if (a.rb1 != b.rb1)
+		return a.rb1 < b.rb1;
+	if (a.geom1 != b.geom1)
+		return a.geom1 < b.geom1;
+	if (a.rb2 != b.rb2)
+		return a.rb2 < b.rb2;
+	return a.geom2 < b.geom2;
+}
+
+/**
+	In deterministic mode, this method is used to sort the pairs of geoms of the current step, and to process them in that order.
+*/
+void ODEWorld::processCollisionPairs(){
+	//a pair of geoms is only reported once per step, so no two pairs compare equal, and the order doesn't depend on the sort either
+	std::sort(collisionPairs.begin(), collisionPairs.end(), collisionPairComesFirst);
+	for (uint i=0;i<collisionPairs.size();i++)
+		processCollisions(collisionPairs[i].o1, collisionPairs[i].o2);
+	//the memory is kept for the next step
+	collisionPairs.clear();
+}
+
 /**
 	This method is used to set the state of all the rigid body in this collection.
 */
@@ -634,7 +1129,34 @@ void ODEWorld::setState(DynamicArray<double>* state, int start){
 	This method is a simple call back function that passes the message to the world whose objects are being acted upon. 
 */
 void collisionCallBack(void* odeWorld, dGeomID o1, dGeomID o2){
-	((ODEWorld*)odeWorld)->processCollisions(o1, o2);
+	//if one of them is a space, the pair stands for all the geoms inside it, and they are collided with the other one in turn
+	if (dGeomIsSpace(o1) || dGeomIsSpace(o2)){
+		dSpaceCollide2(o1, o2, odeWorld, &collisionCallBack);
+		return;
+	}
+	ODEWorld* world = (ODEWorld*)odeWorld;
+	if (world->deterministic)
+		world->addCollisionPair(o1, o2);
+	else
+		world->processCollisions(o1, o2);
+}
+
+/**
+	This method is used to run the collision detection for the current step.
+*/
+void ODEWorld::collideSpaces(){
+	//the static space and the spaces of the figures are just more geoms as far as the top level space is concerned
+	dSpaceCollide(spaceID, this, &collisionCallBack);
+
+	//the bodies of a figure are only checked against each other if self-collisions are enabled
+	if (selfCollisions)
+		for (uint i=0;i<figureSpaces.size();i++)
+			if (figureSpaces[i] != NULL)
+				dSpaceCollide(figureSpaces[i], this, &collisionCallBack);
+
+	//in deterministic mode, the pairs were only collected so far
+	if (deterministic)
+		processCollisionPairs();
 }
 
 //void runTestStep(dWorldID w, dReal stepsize);
@@ -675,24 +1197,10 @@ void ODEWorld::advanceInTime(double deltaT){
 	jointFeedbackCount = 0;
 
 	//go through all the rigid bodies in the world, and apply their external force
-	for (uint j=0;j<objects.size();j++){
-		if( objects[j]->isLocked() ) 
-			continue;
-		const Vector3d& f = objects[j]->externalForce;
-		if( !f.isZeroVector() )
-			dBodyAddForce(odeToRbs[objects[j]->id].id, f.x, f.y, f.z);
-		const Vector3d& t = objects[j]->externalTorque;
-		if( !t.isZeroVector() )
-			dBodyAddTorque(odeToRbs[objects[j]->id].id, t.x, t.y, t.z);
-	}
+	applyExternalForces();
 
 	//go through all the joints in the world, and apply their torques to the parent and child rb's
-	for (uint j=0;j<jts.size();j++){
-		Vector3d t = jts[j]->torque;
-		//we will apply to the parent a positive torque, and to the child a negative torque
-		dBodyAddTorque(odeToRbs[jts[j]->parent->id].id, t.x, t.y, t.z);
-		dBodyAddTorque(odeToRbs[jts[j]->child->id].id, -t.x, -t.y, -t.z);
-	}
+	applyJointTorques();
 
 
 	//clear the previous list of contact forces
@@ -701,19 +1209,26 @@ void ODEWorld::advanceInTime(double deltaT){
 	//we need to determine the contact points first - delete the previous contacts
 	dJointGroupEmpty(contactGroupID);
 	//initiate the collision detection
-	dSpaceCollide(spaceID, this, &collisionCallBack);
-
-	//advance the simulation
-	dWorldStep(worldID, deltaT);
-//	dWorldQuickStep(worldQID, deltaT);
+	collideSpaces();
+
+	//advance the simulation, with the solver that was asked for
+	lastStepUsedQuickStep = (solverMode == SOLVER_QUICKSTEP) || (solverMode == SOLVER_AUTO && getConstraintCount() > autoSolverThreshold);
+	if (lastStepUsedQuickStep)
+		dWorldQuickStep(worldID, deltaT);
+	else
+		dWorldStep(worldID, deltaT);
 //	runTestStep(worldID, deltaT);
 
 	//copy over the state of the ODE bodies to the rigid bodies...
 	setRBStateFromEngine();
 
+	if (hashLogMode != HASH_LOG_OFF)
+		logStateHash();
+
 	//copy over the force information for the contact forces
 	for (int i=0;i<jointFeedbackCount;i++){
-		contactPoints[i].f = Vector3d(jointFeedback[i].f1[0], jointFeedback[i].f1[1], jointFeedback[i].f1[2]);
+		dJointFeedback* feedback = getJointFeedback(i);
+		contactPoints[i].f = Vector3d(feedback->f1[0], feedback->f1[1], feedback->f1[2]);
 		//make sure that the force always points away from the static objects
 		if (contactPoints[i].rb1->isLocked() && !contactPoints[i].rb2->isLocked()){
 			contactPoints[i].f = contactPoints[i].f * (-1);
@@ -722,6 +1237,9 @@ void ODEWorld::advanceInTime(double deltaT){
 			contactPoints[i].rb2 = tmpBdy;
 		}
 	}
+
+	//now that the forces are known, the contacts are sorted by rigid body for the controllers
+	updateContactIndex();
 }
 
 /**
@@ -735,12 +1253,7 @@ void ODEWorld::testAdvanceInTime(double deltaT){
 	jointFeedbackCount = 0;
 
 	//go through all the joints in the world, and apply their torques to the parent and child rb's
-	for (uint j=0;j<jts.size();j++){
-		Vector3d t = jts[j]->torque;
-		//we will apply to the parent a positive torque, and to the child a negative torque
-		dBodyAddTorque(odeToRbs[jts[j]->parent->id].id, t.x, t.y, t.z);
-		dBodyAddTorque(odeToRbs[jts[j]->child->id].id, -t.x, -t.y, -t.z);
-	}
+	applyJointTorques();
 
 	//clear the previous list of contact forces
 	contactPoints.clear();
@@ -748,7 +1261,7 @@ void ODEWorld::testAdvanceInTime(double deltaT){
 	//we need to determine the contact points first - delete the previous contacts
 	dJointGroupEmpty(contactGroupID);
 	//initiate the collision detection
-	dSpaceCollide(spaceID, this, &collisionCallBack);
+	collideSpaces();
 
 	//advance the simulation
 //	dWorldStep(worldID, deltaT);
@@ -760,7 +1273,8 @@ void ODEWorld::testAdvanceInTime(double deltaT){
 
 	//copy over the force information for the contact forces
 	for (int i=0;i<jointFeedbackCount;i++){
-		contactPoints[i].f = Vector3d(jointFeedback[i].f1[0], jointFeedback[i].f1[1], jointFeedback[i].f1[2]);
+		dJointFeedback* feedback = getJointFeedback(i);
+		contactPoints[i].f = Vector3d(feedback->f1[0], feedback->f1[1], feedback->f1[2]);
 		//make sure that the force always points away from the static objects
 		if (contactPoints[i].rb1->isLocked() && !contactPoints[i].rb2->isLocked()){
 			contactPoints[i].f = contactPoints[i].f * (-1);
@@ -771,6 +1285,164 @@ void ODEWorld::testAdvanceInTime(double deltaT){
 	}
 }
 
+/**
+	This method is used to select the way the constraints are solved (one of the SolverMode values).
+*/
+void ODEWorld::setSolverMode(int solverMode){
+	if (solverMode < SOLVER_DIRECT || solverMode > SOLVER_AUTO)
+		throwError("Unknown solver mode: %d.", solverMode);
+	this->solverMode = solverMode;
+}
+
+/**
+	This method is used to set the number of iterations performed by the QuickStep solver at every step.
+*/
+void ODEWorld::setQuickStepIterations(int iterations){
+	if (iterations <= 0)
+		throwError("The QuickStep solver needs at least one iteration.");
+	quickStepIterations = iterations;
+	dWorldSetQuickStepNumIterations(worldID, quickStepIterations);
+}
+
+/**
+	This method is used to set the successive over-relaxation parameter of the QuickStep solver.
+*/
+void ODEWorld::setQuickStepSOR(double sor){
+	if (sor <= 0 || sor >= 2)
+		throwError("The over-relaxation parameter of the QuickStep solver must be between 0 and 2.");
+	quickStepSOR = sor;
+	dWorldSetQuickStepW(worldID, quickStepSOR);
+}
+
+/**
+	This method is used to set the number of threads that step the islands of the world.
+*/
+void ODEWorld::setIslandThreadCount(int threadCount){
+	if (threadCount < 0)
+		throwError("The number of island threads can't be negative.");
+	islandThreads = threadCount;
+	dWorldSetIslandThreads(worldID, islandThreads);
+}
+
+/**
+	This method is used to record or check the hash of the state of the world, once a step has been taken.
+*/
+void ODEWorld::logStateHash(){
+	uint hash = getStateHash();
+	int step = hashLog.size();
+	hashLog.push_back(hash);
+	if (hashLogMode != HASH_LOG_COMPARE || firstDivergentStep >= 0 || step >= (int)referenceHashLog.size())
+		return;
+	if (hash != referenceHashLog[step]){
+		firstDivergentStep = step;
+		tprintf("Warning: the state of the world diverged from the reference hash log at step %d.\n", step);
+	}
+}
+
+/**
+	This method is used to start a new hash log. From now on, the hash of the state of the world is appended to it after every step.
+*/
+void ODEWorld::startHashRecording(){
+	hashLog.clear();
+	referenceHashLog.clear();
+	firstDivergentStep = -1;
+	hashLogMode = HASH_LOG_RECORD;
+}
+
+/**
+	This method is used to start a new hash log, whose hashes are compared to the ones of the reference log as the steps are taken.
+*/
+void ODEWorld::startHashComparison(DynamicArray<uint>* reference){
+	if (reference == NULL)
+		throwError("A reference hash log is needed for the comparison.");
+	//the reference is copied first, in case it is the log of this world
+	referenceHashLog = *reference;
+	hashLog.clear();
+	firstDivergentStep = -1;
+	hashLogMode = HASH_LOG_COMPARE;
+}
+
+/**
+	This method is used to start a new hash log, whose hashes are compared to the ones that are read from the file.
+*/
+void ODEWorld::startHashComparisonFromFile(const char* fName){
+	FILE* f = fopen(fName, "r");
+	if (f == NULL)
+		throwError("Could not open file: %s", fName);
+	DynamicArray<uint> reference;
+	uint hash;
+	while (fscanf(f, "%x", &hash) == 1)
+		reference.push_back(hash);
+	fclose(f);
+	startHashComparison(&reference);
+}
+
+/**
+	This method is used to write the hash log to a text file, one step per line.
+*/
+void ODEWorld::saveHashLog(const char* fName){
+	FILE* f = fopen(fName, "w");
+	if (f == NULL)
+		throwError("Could not open file: %s", fName);
+	for (uint i=0;i<hashLog.size();i++)
+		fprintf(f, "%08x\n", hashLog[i]);
+	fclose(f);
+}
+
+/**
+	This method is used to append the complete state of the world to the binary buffer.
+*/
+void ODEWorld::saveState(BinaryBuffer* buffer){
+	World::saveState(buffer);
+	buffer->writeValue(dWorldGetQuickStepRandomSeed(worldID));
+
+	//whether the bodies are asleep, and for how long they have been idle, so that they fall asleep at the same step after a restore
+	for (uint i=0;i<odeToRbs.size();i++){
+		if (odeToRbs[i].id == NULL)
+			continue;
+		dReal timeLeft;
+		int stepsLeft, averageReady;
+		dBodyGetAutoDisableTimers(odeToRbs[i].id, &timeLeft, &stepsLeft, &averageReady);
+		buffer->writeInt(dBodyIsEnabled(odeToRbs[i].id));
+		buffer->writeValue(timeLeft);
+		buffer->writeInt(stepsLeft);
+		buffer->writeInt(averageReady);
+	}
+}
+
+/**
+	This method is used to restore the state of the world from the binary buffer.
+*/
+void ODEWorld::restoreState(BinaryBuffer* buffer){
+	World::restoreState(buffer);
+	unsigned long seed;
+	buffer->readValue(&seed);
+	dWorldSetQuickStepRandomSeed(worldID, seed);
+
+	//the ODE bodies get the saved states exactly, rather than through setEngineStateFromRB, so that the steps that follow are the same
+	//bit for bit as the ones that followed the save
+	for (uint i=0;i<odeToRbs.size();i++){
+		setODEStateFromRB(i, true);
+		if (odeToRbs[i].id == NULL)
+			continue;
+		//forces that were applied after the state was saved should not carry over to the restored simulation
+		dBodySetForce(odeToRbs[i].id, 0, 0, 0);
+		dBodySetTorque(odeToRbs[i].id, 0, 0, 0);
+		//the bodies go back to sleep, or stay awake, as they were - the timers are set last, since enabling a body resets them
+		bool enabled = buffer->readInt() != 0;
+		dReal timeLeft;
+		buffer->readValue(&timeLeft);
+		int stepsLeft = buffer->readInt();
+		int averageReady = buffer->readInt();
+		if (enabled)
+			dBodyEnable(odeToRbs[i].id);
+		else
+			dBodyDisable(odeToRbs[i].id);
+		dBodySetAutoDisableTimers(odeToRbs[i].id, timeLeft, stepsLeft, averageReady);
+		odeToRbs[i].asleep = !enabled;
+	}
+}
+
 
 /**
 	this method is used to transfer the state of the rigid bodies, from ODE to the rigid body wrapper
@@ -778,6 +1450,13 @@ void ODEWorld::testAdvanceInTime(double deltaT){
 void ODEWorld::setRBStateFromEngine(){
 	//now update all the rigid bodies...
 	for (uint i=0;i<objects.size();i++){
+		//a body that was asleep for the whole step has not moved, so there is nothing to copy
+		if (odeToRbs[i].id != NULL){
+			bool wasAsleep = odeToRbs[i].asleep;
+			odeToRbs[i].asleep = !dBodyIsEnabled(odeToRbs[i].id);
+			if (wasAsleep && odeToRbs[i].asleep)
+				continue;
+		}
 		setRBStateFromODE(i);
 //		objects[i]->updateToWorldTransformation();
 	}
@@ -789,6 +1468,14 @@ void ODEWorld::setRBStateFromEngine(){
 void ODEWorld::setEngineStateFromRB(){
 	//now update all the rigid bodies...
 	for (uint i=0;i<objects.size();i++){
+		//only the bodies that were changed from the outside since they were last copied over need to be updated
+		if (odeToRbs[i].rb->state.version == odeToRbs[i].syncedVersion)
+			continue;
+		//and if one of them was asleep, it wakes up
+		if (odeToRbs[i].asleep){
+			wakeUp(odeToRbs[i].id);
+			odeToRbs[i].asleep = false;
+		}
 		setODEStateFromRB(i);
 	}
 }
@@ -800,6 +1487,7 @@ void ODEWorld::setEngineStateFromRB(){
 void ODEWorld::applyRelForceTo(RigidBody* b, const Vector3d& f, const Point3d& p){
 	if (!b)
 		return;
+	wakeUp(odeToRbs[b->id].id);
 	dBodyAddRelForceAtRelPos(odeToRbs[b->id].id, f.x, f.y, f.z, p.x, p.y, p.z);
 }
 
@@ -810,6 +1498,7 @@ void ODEWorld::applyRelForceTo(RigidBody* b, const Vector3d& f, const Point3d& p
 void ODEWorld::applyForceTo(RigidBody* b, const Vector3d& f, const Point3d& p){
 	if (!b)
 		return;
+	wakeUp(odeToRbs[b->id].id);
 	dBodyAddForceAtRelPos(odeToRbs[b->id].id, f.x, f.y, f.z, p.x, p.y, p.z);
 }
 
@@ -820,5 +1509,6 @@ void ODEWorld::applyForceTo(RigidBody* b, const Vector3d& f, const Point3d& p){
 void ODEWorld::applyTorqueTo(RigidBody* b, const Vector3d& t){
 	if (!b)
 		return;
+	wakeUp(odeToRbs[b->id].id);
 	dBodyAddTorque(odeToRbs[b->id].id, t.x, t.y, t.z);
 }
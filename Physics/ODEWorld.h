@@ -9,38 +9,89 @@
 #include <Physics/CapsuleCDP.h>
 #include <Physics/BoxCDP.h>
 #include <Physics/PlaneCDP.h>
+#include <Physics/HeightFieldCDP.h>
+#include <Physics/TriMeshCDP.h>
 #include <Physics/PreCollisionQuery.h>
 
-#define MAX_CONTACT_FEEDBACK 200
+//the contact feedback structures are allocated in blocks of this many
+#define CONTACT_FEEDBACK_BLOCK_SIZE 256
 
 PHYSICS_TEMPLATE( DynamicArray<dGeomID> )
+PHYSICS_TEMPLATE( DynamicArray<dSpaceID> )
+PHYSICS_TEMPLATE( DynamicArray<dJointFeedback*> )
+PHYSICS_TEMPLATE( DynamicArray<dHeightfieldDataID> )
+PHYSICS_TEMPLATE( DynamicArray<dTriMeshDataID> )
 
 //this structure is used to map a rigid body to the id of its ODE counterpart
 typedef struct ODE_RB_Map_struct{
 	dBodyID id;
 	RigidBody* rb;
 	DynamicArray<dGeomID> collisionVolumes; // Only used for rigid bodies
-	ODE_RB_Map_struct() : id(NULL), rb(NULL) {}
-	ODE_RB_Map_struct(dBodyID newId, RigidBody* newRb){ this->id = newId; this->rb = newRb;}
+	DynamicArray<dGeomID> geoms; // the geoms of the body, as the spaces see them, in the order of its collision primitives
+	bool asleep; // true if ODE had disabled the body the last time its state was copied over to the rigid body
+	uint syncedVersion; // the version of the state of the rigid body the last time it was copied over to ODE
+	ODE_RB_Map_struct() : id(NULL), rb(NULL), asleep(false), syncedVersion(0) {}
+	ODE_RB_Map_struct(dBodyID newId, RigidBody* newRb){ this->id = newId; this->rb = newRb; this->asleep = false; this->syncedVersion = 0;}
 } ODE_RB_Map;
 
 // Instanciate used STL classes
 PHYSICS_TEMPLATE( DynamicArray<ODE_RB_Map> )
 
+//this structure holds the contact properties that define a material. All the rigid bodies that have the same properties share a material
+typedef struct ODE_Material_struct{
+	double mu;
+	double epsilon;
+	double groundSoftness;
+	double groundPenalty;
+} ODE_Material;
+
+PHYSICS_TEMPLATE( DynamicArray<ODE_Material> )
+PHYSICS_TEMPLATE( DynamicArray<dSurfaceParameters> )
+
+//in deterministic mode, the pairs of geoms reported by the broad phase are kept in this structure until they are sorted. The geoms
+//are identified by the index of their rigid body in the world and their index among the geoms of that body, which don't change from one run to the next
+typedef struct ODE_Collision_Pair_struct{
+	dGeomID o1, o2;
+	int rb1, geom1;
+	int rb2, geom2;
+} ODE_Collision_Pair;
+
+PHYSICS_TEMPLATE( DynamicArray<ODE_Collision_Pair> )
+
 
 /*-------------------------------------------------------------------------------------------------------------------------------------------------*
  * This class is used as a wrapper that is designed to work with the Open Dynamics Engine. It uses all the rigid bodies (together with the joints) *
  * that are loaded with RBCollection, and has methods that link with ODE to simulate the physics. If a different physics engine is to be used,     *
  * then ideally only the methods of this class need to be re-implemented, and the rest of the application can stay the same.                       *
+ * Every instance owns its own ODE world, collision space, contact group and contact feedback buffers, so several independent simulations can     *
+ * live side by side in the same process.                                                                                                          *
  *-------------------------------------------------------------------------------------------------------------------------------------------------*/
 class PHYSICS_DECLSPEC ODEWorld : public World{
 friend void collisionCallBack(void* odeWorld, dGeomID o1, dGeomID o2);
 
 private:
+	//this is the number of ODE worlds that are currently alive - ODE is initialized with the first one and closed with the last one
+	static int odeWorldCount;
+
 	// ODE's id for the simulation world
 	dWorldID worldID;
-	// id of collision detection space
+	// id of the top level collision detection space
 	dSpaceID spaceID;
+	// the space that holds the geoms of the locked bodies - it is part of the top level space, but never collided with itself
+	dSpaceID staticSpaceID;
+	// the geoms of every articulated figure go into a space of their own, in the same order as AFs (NULL until the figure gets a geom)
+	DynamicArray<dSpaceID> figureSpaces;
+	// the data of the heightfield and triangle mesh geoms - ODE does not destroy it along with the geoms
+	DynamicArray<dHeightfieldDataID> heightfieldData;
+	DynamicArray<dTriMeshDataID> triMeshData;
+	//this is the kind of space used at the top level (one of the BroadPhase values)
+	int broadPhase;
+	//the region covered by the quadtree, and its depth, in BROADPHASE_QUADTREE mode
+	Point3d quadTreeCenter;
+	Vector3d quadTreeExtents;
+	int quadTreeDepth;
+	//if this is true, the bodies of an articulated figure are checked for collisions with each other
+	bool selfCollisions;
 	// id of contact group
 	dJointGroupID contactGroupID;
 	//keep track of the mapping between the rigid bodies and their ODE counterparts with this
@@ -51,13 +102,58 @@ private:
 	//this is the max number of contacts that are going to be processed between any two objects
 	int maxContactCount;
 
-	dJointFeedback jointFeedback[MAX_CONTACT_FEEDBACK];
+	//ODE keeps a pointer to the feedback structure of every contact joint, so these structures are allocated in blocks that never move.
+	//The blocks are reused from one step to the next, and a new one is only added when there are more contacts than ever before
+	DynamicArray<dJointFeedback*> jointFeedbackBlocks;
 	//this is the current number of contact joints, for the current step of the simulation
 	int jointFeedbackCount;
 
-	//this is a pointer to a physical interface object that is used as an abstract way of communicating between the simulator and the application
+	//this is the joint actuation plan: for every joint of jts, in the same order, the ODE bodies that its torque is applied to (NULL for
+	//locked bodies). It is built once the figures are loaded, so that applying the torques is one walk through two contiguous arrays
+	DynamicArray<dBodyID> jointParentBodies;
+	DynamicArray<dBodyID> jointChildBodies;
+
+	//this is a pointer to a physical interface object that is used as an abstract way of communicating between the simulator and the application (NULL unless one was installed)
 	PreCollisionQuery* pcQuery;
 
+	//these are the materials used by the rigid bodies of this world
+	DynamicArray<ODE_Material> materials;
+	//and for every ordered pair of materials (m1, m2), at index m1 * materials.size() + m2, the surface parameters of the contacts between them
+	DynamicArray<dSurfaceParameters> materialPairSurfaces;
+
+	//this is the way the constraints are solved at every step (one of the SolverMode values)
+	int solverMode;
+	//the number of iterations and the over-relaxation parameter used by the QuickStep solver
+	int quickStepIterations;
+	double quickStepSOR;
+	//in SOLVER_AUTO mode, QuickStep is used whenever the number of joints and contacts is larger than this
+	int autoSolverThreshold;
+	//this is set to true if the last step was taken with the QuickStep solver
+	bool lastStepUsedQuickStep;
+	//the number of threads that step the islands (groups of bodies that are connected by joints or contacts), 0 to step them one after the other
+	int islandThreads;
+
+	//if this is true, the rigid bodies that are not part of an articulated figure are put to sleep by ODE once they come to rest
+	bool autoDisable;
+	//a body is at rest when its linear and angular velocities stay below these thresholds for autoDisableTime seconds
+	double autoDisableLinearThreshold;
+	double autoDisableAngularThreshold;
+	double autoDisableTime;
+
+	//if this is true, the contacts are created in an order that only depends on the rigid bodies and their collision primitives
+	bool deterministic;
+	//in deterministic mode, the pairs of geoms that were reported by the broad phase during the current step
+	DynamicArray<ODE_Collision_Pair> collisionPairs;
+
+	//this is what is done with the hash of the state of the world after every step (one of the HashLogMode values)
+	int hashLogMode;
+	//the hashes of the steps that were taken since the log was started
+	DynamicArray<uint> hashLog;
+	//when comparing, these are the hashes that the steps are expected to have
+	DynamicArray<uint> referenceHashLog;
+	//the first step whose hash did not match the reference, or -1 if they all matched so far
+	int firstDivergentStep;
+
 	/**
 		This method is used to set up an ode fixed joint, based on the information in the hinge joint passed in as a parameter
 	*/
@@ -80,15 +176,30 @@ private:
 	void setupODEBallAndSocketJoint(BallInSocketJoint* basj);
 
 	/**
-		this method is used to copy the state of the ith rigid body to its ode counterpart.
+		this method is used to copy the state of the ith rigid body to its ode counterpart. The orientation is normalized on the way,
+		unless exact is true, in which case it is copied bit for bit (which is what restoring a saved state needs).
 	*/
-	void setODEStateFromRB(int i);
+	void setODEStateFromRB(int i, bool exact = false);
 
 	/**
 		this method is used to copy the state of the ith rigid body, from the ode object to its rigid body counterpart 
 	*/
 	void setRBStateFromODE(int i);
 
+	/**
+		This method is used to pass the auto-disable settings of the world on to the ode body that is passed in.
+	*/
+	void setupODEAutoDisable(dBodyID id);
+
+	/**
+		This method is used to wake up the ode body that is passed in, if it was put to sleep.
+	*/
+	inline void wakeUp(dBodyID id){
+		//enabling a body restarts its idle countdown, so this is only done if it is really asleep
+		if (id != NULL && !dBodyIsEnabled(id))
+			dBodyEnable(id);
+	}
+
 	/**
 		this method is used to set up an ODE sphere geom. It is properly placed in body coordinates.
 	*/
@@ -104,11 +215,62 @@ private:
 	*/
 	dGeomID getPlaneGeom(PlaneCDP* p, RigidBody* parent);
 
+	/**
+		this method is used to set up an ODE heightfield geom. Like planes, heightfields are placed in world coordinates once and for all.
+	*/
+	dGeomID getHeightFieldGeom(HeightFieldCDP* h, RigidBody* parent);
+
+	/**
+		this method is used to set up an ODE triangle mesh geom. Like planes, triangle meshes are placed in world coordinates once and for all.
+	*/
+	dGeomID getTriMeshGeom(TriMeshCDP* m, RigidBody* parent);
+
 	/**
 		this method is used to set up an ODE sphere geom. It is properly placed in body coordinates.
 	*/
 	dGeomID getCapsuleGeom(CapsuleCDP* c);
 
+	/**
+		This method returns the material of the rigid body that is passed in, assigning one to it if it does not have one yet.
+	*/
+	inline int getMaterialID(RigidBody* rb){
+		if (rb->props.materialID < 0)
+			assignMaterial(rb);
+		return rb->props.materialID;
+	}
+
+	/**
+		This method is used to assign a material to the rigid body, based on its contact properties. A new material is created if none of
+		the existing ones match, in which case the table of surface parameters is rebuilt.
+	*/
+	void assignMaterial(RigidBody* rb);
+
+	/**
+		This method is used to rebuild the surface parameters for every pair of materials.
+	*/
+	void buildMaterialPairSurfaces();
+
+	/**
+		This method is used to build the joint actuation plan, from the joints of the world.
+	*/
+	void buildJointActuationPlan();
+
+	/**
+		This method is used to apply the torques of all the joints to their parent and child bodies, following the joint actuation plan.
+	*/
+	void applyJointTorques();
+
+	/**
+		This method is used to apply the external forces and torques of the rigid bodies to their ODE counterparts.
+	*/
+	void applyExternalForces();
+
+	/**
+		This method returns the feedback structure for the ith contact joint of the current step. A new block of feedback structures is
+		allocated if needed.
+	*/
+	dJointFeedback* getJointFeedback(int i);
+
 	/**
 		this method is used to process the collision between the two objects passed in as parameters. More generally,
 		it is used to determine if the collision should take place, and if so, it calls the method that generates the
@@ -116,11 +278,48 @@ private:
 	*/
 	void processCollisions(dGeomID o1, dGeomID o2);
 
+	/**
+		This method returns the index of the rigid body that the geom belongs to, and the index of the geom among the geoms of that body.
+	*/
+	void getGeomKey(dGeomID g, int* rbIndex, int* geomIndex);
+
+	/**
+		In deterministic mode, this method is used to keep the pair of geoms passed in until all the pairs of the step are known.
+	*/
+	void addCollisionPair(dGeomID o1, dGeomID o2);
+
+	/**
+		In deterministic mode, this method is used to sort the pairs of geoms of the current step, and to process them in that order.
+	*/
+	void processCollisionPairs();
+
+	/**
+		This method is used to record or check the hash of the state of the world, once a step has been taken.
+	*/
+	void logStateHash();
+
 	/**
 		this method is used to create ODE geoms for all the collision primitives of the rigid body that is passed in as a paramter
 	*/
 	void createODECollisionPrimitives(RigidBody* body, int index);
 
+	/**
+		This method is used to create the top level space, of the kind that was asked for, and the static space that goes in it.
+	*/
+	void createCollisionSpaces();
+
+	/**
+		This method returns the space that the geoms of the rigid body that is passed in should go into: the static space for locked
+		bodies, the space of the figure for articulated bodies (it is created on the first call) and the top level space otherwise.
+	*/
+	dSpaceID getCollisionSpace(RigidBody* body);
+
+	/**
+		This method is used to run the collision detection for the current step. Only the top level space is collided with itself, and the
+		spaces of the articulated figures are only collided with themselves if self-collisions are enabled.
+	*/
+	void collideSpaces();
+
 	/**
 		this method is used to transfer the state of the rigid bodies, from the simulator to the rigid body wrapper
 	*/
@@ -171,12 +370,271 @@ public:
 	*/
 	virtual void addArticulatedFigure( ArticulatedFigure* articulatedFigure_disown );
 
+	/**
+		This method copies the new collision bitmasks of the rigid body to its geoms, so that the broad phase uses them from the next step on.
+	*/
+	virtual void updateCollisionBits(RigidBody* rb);
+
+	/**
+		This method installs an object that decides which pairs of bodies are checked for collisions in this world, on top of the
+		collision bitmasks. The world takes ownership of the query object. There is none by default (NULL), which is the fast path:
+		the pairs are filtered by the bitmasks, the bodies of a figure are kept apart unless self-collisions are on, and the bodies that
+		are connected by a joint are never checked.
+	*/
+	void setPreCollisionQuery( PreCollisionQuery* pcQuery_disown );
+
+
+	//these are the kinds of spaces that can be used at the top level of the collision detection
+	enum BroadPhase {
+		//ODE's multi-resolution hash table space
+		BROADPHASE_HASH = 0,
+		//ODE's quadtree space - it splits the plane that is perpendicular to PhysicsGlobals::up, within the bounds set with setQuadTreeBounds
+		BROADPHASE_QUADTREE,
+		//a sweep and prune space, sorted along the x axis
+		BROADPHASE_SAP
+	};
+
+	/**
+		This method is used to select the kind of space used at the top level of the collision detection (one of the BroadPhase values).
+		This can only be done while the world is empty.
+	*/
+	void setBroadPhase(int broadPhase);
+
+	inline int getBroadPhase(){
+		return broadPhase;
+	}
+
+	/**
+		This method is used to set the region covered by the quadtree (center and half-sizes), and its depth. It is only used in
+		BROADPHASE_QUADTREE mode and, like the broad phase itself, can only be changed while the world is empty.
+	*/
+	void setQuadTreeBounds(const Point3d& center, const Vector3d& extents, int depth);
+
+	/**
+		This method is used to specify whether the bodies of an articulated figure should be checked for collisions with each other.
+		This is off by default - the pairs are then never even looked at by the broad phase.
+	*/
+	inline void setSelfCollisions(bool selfCollisions){
+		this->selfCollisions = selfCollisions;
+	}
+
+	inline bool getSelfCollisions(){
+		return selfCollisions;
+	}
+
+	/**
+		This method is used to turn the automatic sleeping of resting bodies on or off (it is off by default). Only the rigid bodies that are
+		not part of an articulated figure can fall asleep. A sleeping body is not integrated, and its state is not copied back and forth
+		between the rigid body and ODE. It wakes up when something touches it, when a force is applied to it, or when its state is changed.
+	*/
+	void setAutoDisable(bool autoDisable);
+
+	inline bool getAutoDisable(){
+		return autoDisable;
+	}
+
+	/**
+		This method is used to set how slow a body needs to be moving (linear and angular velocity), and for how long, before it falls asleep.
+	*/
+	void setAutoDisableThresholds(double linearVelocity, double angularVelocity, double idleTime);
+
+	inline double getAutoDisableLinearThreshold(){
+		return autoDisableLinearThreshold;
+	}
+
+	inline double getAutoDisableAngularThreshold(){
+		return autoDisableAngularThreshold;
+	}
+
+	inline double getAutoDisableTime(){
+		return autoDisableTime;
+	}
+
+	/**
+		This method returns true if the rigid body that is passed in was put to sleep.
+	*/
+	bool isAsleep(RigidBody* rb);
+
+	/**
+		This method is used to wake up the rigid body that is passed in, if it was put to sleep.
+	*/
+	void wakeUp(RigidBody* rb);
+
+	//these are the ways the constraints can be solved at every step
+	enum SolverMode {
+		//ODE's big-matrix LCP solver (dWorldStep) - accurate, but cubic in the number of constraints
+		SOLVER_DIRECT = 0,
+		//ODE's iterative solver (dWorldQuickStep) - linear in the number of constraints, less accurate
+		SOLVER_QUICKSTEP,
+		//use the direct solver for small problems, and QuickStep once there are more constraints than the auto solver threshold
+		SOLVER_AUTO
+	};
+
+	/**
+		This method is used to select the way the constraints are solved (one of the SolverMode values).
+	*/
+	void setSolverMode(int solverMode);
+
+	inline int getSolverMode(){
+		return solverMode;
+	}
+
+	/**
+		This method is used to set the number of iterations performed by the QuickStep solver at every step (20 by default).
+	*/
+	void setQuickStepIterations(int iterations);
+
+	inline int getQuickStepIterations(){
+		return quickStepIterations;
+	}
+
+	/**
+		This method is used to set the successive over-relaxation parameter of the QuickStep solver (1.3 by default).
+	*/
+	void setQuickStepSOR(double sor);
+
+	inline double getQuickStepSOR(){
+		return quickStepSOR;
+	}
+
+	/**
+		This method is used to set the number of constraints (joints and contacts) above which the QuickStep solver is used in SOLVER_AUTO mode.
+	*/
+	inline void setAutoSolverThreshold(int threshold){
+		autoSolverThreshold = threshold;
+	}
+
+	inline int getAutoSolverThreshold(){
+		return autoSolverThreshold;
+	}
+
+	/**
+		This method is used to set the number of threads that step the islands of the world. An island is a group of bodies that are
+		connected by joints or contacts, so characters that don't touch each other are in different islands and can be solved on different
+		cores. With 0 (the default), the islands are stepped one after the other, as they always were. With 1 or more, the results are
+		the same whatever the number of threads, but they differ slightly from those of 0 when QuickStep is used, since every island then
+		reorders its constraints with a random generator of its own.
+	*/
+	void setIslandThreadCount(int threadCount);
+
+	inline int getIslandThreadCount(){
+		return islandThreads;
+	}
+
+	/**
+		This method returns the number of constraints (joints and contacts) that were solved at the last step.
+	*/
+	inline int getConstraintCount(){
+		return (int)jts.size() + jointFeedbackCount;
+	}
+
+	/**
+		This method returns true if the last step was taken with the QuickStep solver, false if the direct solver was used.
+	*/
+	inline bool usedQuickStepLastStep(){
+		return lastStepUsedQuickStep;
+	}
+
+	/**
+		This method is used to turn the deterministic mode on or off (it is off by default). ODE reports the pairs of geoms that may
+		collide in an order that depends on the internals of the spaces, and the order the contacts are created in changes the solution
+		that is found. In deterministic mode, the pairs of the step are all collected first, and then sorted by rigid body and collision
+		primitive, so that a given setup is simulated exactly the same way run after run. Along with the hash log, this is what the
+		regression tests of the controllers rely on.
+	*/
+	inline void setDeterministic(bool deterministic){
+		this->deterministic = deterministic;
+	}
+
+	inline bool isDeterministic(){
+		return deterministic;
+	}
+
+	//these are the things that can be done with the hash of the state of the world after every step
+	enum HashLogMode {
+		//nothing, the hashes are not computed
+		HASH_LOG_OFF = 0,
+		//the hashes are appended to the log
+		HASH_LOG_RECORD,
+		//the hashes are appended to the log, and compared to the ones of a reference log
+		HASH_LOG_COMPARE
+	};
+
+	/**
+		This method is used to start a new hash log. From now on, the hash of the state of the world is appended to it after every step.
+	*/
+	void startHashRecording();
+
+	/**
+		This method is used to start a new hash log, whose hashes are compared to the ones of the reference log as the steps are taken.
+		The first step that doesn't match is reported, and can be retrieved with getFirstDivergentStep. Both logs are expected to start
+		from the same state.
+	*/
+	void startHashComparison(DynamicArray<uint>* reference);
+
+	/**
+		Same as above, but the reference log is read from a file that was written by saveHashLog.
+	*/
+	void startHashComparisonFromFile(const char* fName);
+
+	/**
+		This method is used to stop computing the hashes. The log is kept.
+	*/
+	inline void stopHashLog(){
+		hashLogMode = HASH_LOG_OFF;
+	}
+
+	inline int getHashLogMode(){
+		return hashLogMode;
+	}
+
+	/**
+		This method is used to write the hash log to a text file, one step per line.
+	*/
+	void saveHashLog(const char* fName);
+
+	/**
+		These methods give access to the hashes of the steps that were taken since the log was started.
+	*/
+	inline DynamicArray<uint>* getHashLog(){
+		return &hashLog;
+	}
+
+	inline int getHashLogSize(){
+		return hashLog.size();
+	}
+
+	inline uint getHashLogEntry(int i){
+		return hashLog[i];
+	}
+
+	/**
+		This method returns the first step, counted from the start of the log, whose hash did not match the reference log, or -1 if
+		they all matched so far. Steps taken past the end of the reference log are not checked.
+	*/
+	inline int getFirstDivergentStep(){
+		return firstDivergentStep;
+	}
 
 	/**
 		This method is used to integrate the forward simulation in time.
 	*/
 	virtual void advanceInTime(double deltaT);
 
+	/**
+		This method is used to append the complete state of the world to the binary buffer. On top of the rigid body states and the
+		contact points, the seed of the world's random number generator is saved, since the iterative solver uses it to order the constraints,
+		along with whether each body is asleep and how long it has been idle for.
+	*/
+	virtual void saveState(BinaryBuffer* buffer);
+
+	/**
+		This method is used to restore the state of the world from the binary buffer. The ODE bodies are updated right away, they are put
+		back to sleep or woken up as they were when the state was saved, and any force or torque that was accumulated since the last step
+		is discarded.
+	*/
+	virtual void restoreState(BinaryBuffer* buffer);
+
 	/**
 		this method applies a force to a rigid body, at the specified point. The point is specified in local coordinates,
 		and the force is also specified in local coordinates.
@@ -13,6 +13,8 @@
 #include "CapsuleCDP.h"
 #include "PlaneCDP.h"
 #include "SphereCDP.h"
+#include "HeightFieldCDP.h"
+#include "TriMeshCDP.h"
 #include "Joint.h"
 #include "StiffJoint.h"
 #include "HingeJoint.h"
@@ -21,7 +23,12 @@
 #include "RigidBody.h"
 #include "ArticulatedRigidBody.h"
 #include "ArticulatedFigure.h"
+#include "PreCollisionQuery.h"
+#include "RBStateStore.h"
+#include "ContactIndex.h"
 #include "World.h"
+#include "ODEWorld.h"
+#include "FeatherstoneWorld.h"
 %}
 
 // SWIG compiler does not support VC++ declspec
@@ -40,12 +47,15 @@
 %apply SWIGTYPE *DISOWN { CollisionDetectionPrimitive* cdp_disown };
 %apply SWIGTYPE *DISOWN { Joint* joint_disown };
 %apply SWIGTYPE *DISOWN { GLMesh* mesh_disown};
+%apply SWIGTYPE *DISOWN { PreCollisionQuery* pcQuery_disown };
 %import "../Utils/Utils.i"
 %include "CollisionDetectionPrimitive.h"
 %include "BoxCDP.h"
 %include "CapsuleCDP.h"
 %include "PlaneCDP.h"
 %include "SphereCDP.h"
+%include "HeightFieldCDP.h"
+%include "TriMeshCDP.h"
 %include "Joint.h"
 %include "StiffJoint.h"
 %include "HingeJoint.h"
@@ -54,11 +64,50 @@
 %include "RigidBody.h"
 %include "ArticulatedRigidBody.h"
 %include "ArticulatedFigure.h"
+%include "PreCollisionQuery.h"
+%include "RBStateStore.h"
+%include "ContactIndex.h"
+// the worlds made by createWorld belong to Python, and come out as the class of their engine
+%include <factory.i>
+%newobject World::createWorld;
+%factory(World* World::createWorld, ODEWorld, FeatherstoneWorld);
 %include "World.h"
+%ignore ODE_RB_Map_struct;
+%ignore ODE_Material_struct;
+%ignore ODE_Collision_Pair_struct;
+%include "ODEWorld.h"
+%ignore FS_Link_struct;
+%include "FeatherstoneWorld.h"
+
+// The arrays of the state store are handed over to Python as copies (one string per array), so they stay valid whatever happens
+// to the world afterwards. Use numpy.frombuffer(data, float).reshape(-1, 4) to look at them. Get the store with
+// World.getStateStore() right before, so that it is up to date.
+%extend RBStateStore {
+	PyObject* getPositionBuffer(){
+		return PyString_FromStringAndSize((const char*)$self->getPositionData(), $self->getDataSize());
+	}
+	PyObject* getOrientationBuffer(){
+		return PyString_FromStringAndSize((const char*)$self->getOrientationData(), $self->getDataSize());
+	}
+	PyObject* getVelocityBuffer(){
+		return PyString_FromStringAndSize((const char*)$self->getVelocityData(), $self->getDataSize());
+	}
+	PyObject* getAngularVelocityBuffer(){
+		return PyString_FromStringAndSize((const char*)$self->getAngularVelocityData(), $self->getDataSize());
+	}
+}
 
 %pythoncode %{
 def world():
 	return World_instance();
+
+def createWorld(engine = World.ENGINE_ODE):
+	"""Creates a new, independent simulation world, simulated with the given engine. The default world is still returned by world()."""
+	return World_createWorld(engine);
+
+def setDefaultEngine(engine):
+	"""Selects the engine the default world is simulated with. This must be done before anything asks for the default world."""
+	World_setDefaultEngine(engine);
 %}
 
 %inline %{
@@ -71,6 +120,8 @@ PHYSICS_CAST_TO( BoxCDP )
 PHYSICS_CAST_TO( SphereCDP )
 PHYSICS_CAST_TO( PlaneCDP )
 PHYSICS_CAST_TO( CapsuleCDP )
+PHYSICS_CAST_TO( HeightFieldCDP )
+PHYSICS_CAST_TO( TriMeshCDP )
 PHYSICS_CAST_TO( Joint )
 PHYSICS_CAST_TO( StiffJoint )
 PHYSICS_CAST_TO( HingeJoint )
@@ -79,6 +130,8 @@ PHYSICS_CAST_TO( BallInSocketJoint )
 PHYSICS_CAST_TO( RigidBody )
 PHYSICS_CAST_TO( ArticulatedRigidBody )
 PHYSICS_CAST_TO( ArticulatedFigure )
+PHYSICS_CAST_TO( ODEWorld )
+PHYSICS_CAST_TO( FeatherstoneWorld )
 %}
 
 
@@ -1,7 +1,11 @@
 #pragma once
 
 #ifndef PHYSICS_DECLSPEC
-	#ifdef PHYSICS_EXPORTS
+	#if defined(HEADLESS)
+		//the headless build links everything statically
+		#define PHYSICS_DECLSPEC
+		#define PHYSICS_TEMPLATE(x)
+	#elif defined(PHYSICS_EXPORTS)
 		#define PHYSICS_DECLSPEC    __declspec(dllexport) 
 		#define PHYSICS_TEMPLATE(x) template class __declspec(dllexport) x;
 	#else
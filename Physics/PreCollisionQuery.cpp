@@ -24,9 +24,7 @@ bool PreCollisionQuery::shouldCheckForCollisions(RigidBody* rb1, RigidBody* rb2,
 	if (rb1->isLocked() && rb2->isLocked())
 		return false;
 
-	if (rb1->getAFParent() != NULL)
-		if (rb1->getAFParent() == rb2->getAFParent())
-			return false;
+	//the bodies of an articulated figure are kept apart by the world, unless it is asked to check them for self-collisions
 	return true;
 }
 
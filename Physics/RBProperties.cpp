@@ -17,6 +17,9 @@ RBProperties::RBProperties(){
 	isPlanar = false;
 	groundSoftness = 0.00001;
 	groundPenalty = 0.2;
+	materialID = -1;
+	categoryBits = ~0;
+	collideBits = ~0;
 }
 
 /**
@@ -39,6 +39,16 @@ public:
 	double groundSoftness;
 	double groundPenalty;
 
+	//this is the material that the world assigned to the body, based on the contact properties above. It is -1 until the body is
+	//added to a world, and it is reset to -1 whenever one of the contact properties changes, so that the world assigns it again
+	int materialID;
+
+	//these are the collision filtering bitmasks: two bodies are only tested for collisions if the category bits of one of them have
+	//at least one bit in common with the collide bits of the other. They are handed over to the collision detection of the world
+	//(dGeomSetCategoryBits/dGeomSetCollideBits for ODE), so the pairs that are filtered out never make it past the broad phase
+	uint categoryBits;
+	uint collideBits;
+
 	//if this method is set to true, then the body is constrained to be a planar object (move in the x-y plane and only rotate about the z-axis)
 	bool isPlanar;
 
@@ -9,6 +9,7 @@ RBState::RBState(void){
 	this->orientation = Quaternion(1,Vector3d(0,0,0));
 	this->velocity = Vector3d(0,0,0);
 	this->angularVelocity = Vector3d(0,0,0);
+	this->version = 0;
 }
 
 /**
@@ -19,6 +20,7 @@ RBState::RBState(const RBState& other){
 	this->orientation = other.orientation;
 	this->velocity = other.velocity;
 	this->angularVelocity = other.angularVelocity;
+	this->version = 0;
 }
 
 /**
@@ -29,6 +31,8 @@ RBState& RBState::operator = (const RBState& other){
 	this->orientation = other.orientation;
 	this->velocity = other.velocity;
 	this->angularVelocity = other.angularVelocity;
+	//the version is not copied over: this state was just changed, no matter what the version of the other one is
+	markModified();
 	return *this;
 }
 
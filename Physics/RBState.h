@@ -4,6 +4,7 @@
 #include <MathLib/Vector3d.h>
 #include <MathLib/Quaternion.h>
 
+#include <Utils/Utils.h>
 #include <Physics/PhysicsDll.h>
 
 /*======================================================================================================================================================================*
@@ -23,6 +24,9 @@ public:
 	Vector3d velocity;
 	// and finally, the angular velocity about the center of mass
 	Vector3d angularVelocity;
+	//this is bumped every time the state is changed from outside of the physics engine, so that the engine only needs to
+	//pick up the states of the bodies that were actually changed. It is not copied from one state to another.
+	uint version;
 	
 public:
 	/**
@@ -43,4 +47,11 @@ public:
 		Default destructor.
 	*/
 	~RBState(void);
+
+	/**
+		This method must be called whenever the state is changed by something other than the physics engine.
+	*/
+	inline void markModified(){
+		version++;
+	}
 };
@@ -0,0 +1,47 @@
+#include "RBStateStore.h"
+
+RBStateStore::RBStateStore(void){
+	bodyCount = 0;
+}
+
+RBStateStore::~RBStateStore(void){
+}
+
+/**
+	This method is used to change the number of bodies the store holds.
+*/
+void RBStateStore::resize(int bodyCount){
+	this->bodyCount = bodyCount;
+	positions.resize(bodyCount * RB_STATE_STORE_STRIDE, 0);
+	orientations.resize(bodyCount * RB_STATE_STORE_STRIDE, 0);
+	velocities.resize(bodyCount * RB_STATE_STORE_STRIDE, 0);
+	angularVelocities.resize(bodyCount * RB_STATE_STORE_STRIDE, 0);
+	versions.resize(bodyCount, 0);
+}
+
+/**
+	This method is used to fold size bytes into the hash that is passed in (32 bit FNV-1a).
+*/
+static inline uint hashBytes(uint hash, const void* data, int size){
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (int i=0;i<size;i++){
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+	This method returns a hash of the bits of all the rows. The unused fourth value of the vectors is always 0, so it doesn't get in the way.
+*/
+uint RBStateStore::computeHash(){
+	uint hash = 2166136261u;
+	hash = hashBytes(hash, &bodyCount, sizeof(int));
+	if (bodyCount == 0)
+		return hash;
+	hash = hashBytes(hash, getPositionData(), getDataSize());
+	hash = hashBytes(hash, getOrientationData(), getDataSize());
+	hash = hashBytes(hash, getVelocityData(), getDataSize());
+	hash = hashBytes(hash, getAngularVelocityData(), getDataSize());
+	return hash;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <Utils/Utils.h>
+#include <Physics/PhysicsDll.h>
+#include <Physics/RBState.h>
+
+//every quantity takes up this many doubles per body, so that the rows have the same layout as ODE's vectors and quaternions
+#define RB_STATE_STORE_STRIDE 4
+
+PHYSICS_TEMPLATE( DynamicArray<uint> )
+
+/*==================================================================================================================================================*
+ * This class keeps a copy of the states of all the rigid bodies of a world in contiguous arrays - one for the positions, one for the orientations, *
+ * one for the velocities and one for the angular velocities - indexed by the position of the body in the world. Every row is                       *
+ * RB_STATE_STORE_STRIDE doubles long: x, y, z (and an unused fourth value) for the vectors, s, x, y, z for the quaternions.                        *
+ *                                                                                                                                                  *
+ * The rigid bodies still own their states: the store is a snapshot that World::getStateStore fills in on demand, for the code that wants all       *
+ * the states at once (saving and restoring the world, hashing it, interpolating it for drawing, or copying it to Python). Nothing is kept up to    *
+ * date while the world is stepped, so a world whose store nobody asks for does not pay for it.                                                     *
+ *==================================================================================================================================================*/
+class PHYSICS_DECLSPEC RBStateStore{
+private:
+	DynamicArray<double> positions;
+	DynamicArray<double> orientations;
+	DynamicArray<double> velocities;
+	DynamicArray<double> angularVelocities;
+	//the version of the rigid body state that each row was copied from
+	DynamicArray<uint> versions;
+	//the number of bodies the store holds
+	int bodyCount;
+
+public:
+	RBStateStore(void);
+	~RBStateStore(void);
+
+	/**
+		This method is used to change the number of bodies the store holds.
+	*/
+	void resize(int bodyCount);
+
+	inline int getBodyCount(){
+		return bodyCount;
+	}
+
+	/**
+		This method is used to copy the state that is passed in to row i.
+	*/
+	inline void setState(int i, const RBState& s){
+		double* p = &positions[i * RB_STATE_STORE_STRIDE];
+		p[0] = s.position.x; p[1] = s.position.y; p[2] = s.position.z;
+		double* q = &orientations[i * RB_STATE_STORE_STRIDE];
+		q[0] = s.orientation.s; q[1] = s.orientation.v.x; q[2] = s.orientation.v.y; q[3] = s.orientation.v.z;
+		double* v = &velocities[i * RB_STATE_STORE_STRIDE];
+		v[0] = s.velocity.x; v[1] = s.velocity.y; v[2] = s.velocity.z;
+		double* w = &angularVelocities[i * RB_STATE_STORE_STRIDE];
+		w[0] = s.angularVelocity.x; w[1] = s.angularVelocity.y; w[2] = s.angularVelocity.z;
+		versions[i] = s.version;
+	}
+
+	/**
+		This method is used to copy row i to the state that is passed in. The version of the state is left alone.
+	*/
+	inline void getState(int i, RBState* s){
+		s->position = getPosition(i);
+		s->orientation = getOrientation(i);
+		s->velocity = getVelocity(i);
+		s->angularVelocity = getAngularVelocity(i);
+	}
+
+	/**
+		Returns the version of the rigid body state that row i was copied from.
+	*/
+	inline uint getVersion(int i){
+		return versions[i];
+	}
+
+	inline Point3d getPosition(int i){
+		const double* p = &positions[i * RB_STATE_STORE_STRIDE];
+		return Point3d(p[0], p[1], p[2]);
+	}
+
+	inline Quaternion getOrientation(int i){
+		const double* q = &orientations[i * RB_STATE_STORE_STRIDE];
+		return Quaternion(q[0], q[1], q[2], q[3]);
+	}
+
+	inline Vector3d getVelocity(int i){
+		const double* v = &velocities[i * RB_STATE_STORE_STRIDE];
+		return Vector3d(v[0], v[1], v[2]);
+	}
+
+	inline Vector3d getAngularVelocity(int i){
+		const double* w = &angularVelocities[i * RB_STATE_STORE_STRIDE];
+		return Vector3d(w[0], w[1], w[2]);
+	}
+
+	/**
+		These methods return the arrays themselves (bodyCount * RB_STATE_STORE_STRIDE doubles each). They are only valid until the store is
+		resized, and they are only up to date right after World::getStateStore.
+	*/
+	inline double* getPositionData(){
+		return (bodyCount > 0)?(&positions[0]):(NULL);
+	}
+
+	inline double* getOrientationData(){
+		return (bodyCount > 0)?(&orientations[0]):(NULL);
+	}
+
+	inline double* getVelocityData(){
+		return (bodyCount > 0)?(&velocities[0]):(NULL);
+	}
+
+	inline double* getAngularVelocityData(){
+		return (bodyCount > 0)?(&angularVelocities[0]):(NULL);
+	}
+
+	/**
+		Returns the size, in bytes, of each of the arrays.
+	*/
+	inline int getDataSize(){
+		return bodyCount * RB_STATE_STORE_STRIDE * sizeof(double);
+	}
+
+	/**
+		This method returns a hash of the bits of all the rows. Two stores that hold exactly the same states have the same hash, and
+		states that differ in any way, even in the last bit of one value, almost certainly have different ones.
+	*/
+	uint computeHash();
+};
@@ -1,5 +1,6 @@
 #include <Physics/RBUtils.h>
 #include <string.h>
+#include <stdlib.h>
 
 typedef struct key_word{
 	char keyWord[25];
@@ -48,7 +49,9 @@ int getRBLineType(char* &buffer){
 		{"CDP_Box", RB_BOX},
 		{"planar", RB_PLANAR},
 		{"ODEGroundParameters", RB_ODE_GROUND_COEFFS},
-		{"softBody", RB_SOFT_BODY}
+		{"softBody", RB_SOFT_BODY},
+		{"collisionBits", RB_COLLISION_BITS},
+		{"CDP_CollisionBits", RB_CDP_COLLISION_BITS}
 	};
 
 	//declare a list of keywords
@@ -64,3 +67,20 @@ int getRBLineType(char* &buffer){
 	return RB_NOT_IMPORTANT;
 }
 
+/**
+	This method is used to read a pair of collision bitmasks (category bits, then collide bits) from the string that is passed in.
+	The values can be written in decimal or in hexadecimal (0x...). Returns false if the two values could not be read.
+*/
+bool readCollisionBits(char* buffer, uint* categoryBits, uint* collideBits){
+	char* end;
+	unsigned long category = strtoul(buffer, &end, 0);
+	if (end == buffer)
+		return false;
+	buffer = end;
+	unsigned long collide = strtoul(buffer, &end, 0);
+	if (end == buffer)
+		return false;
+	*categoryBits = (uint)category;
+	*collideBits = (uint)collide;
+	return true;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Utils/Utils.h>
 #include <Physics/PhysicsDll.h>
 
 #define RB_NOT_IMPORTANT				1
@@ -39,10 +40,18 @@
 #define RB_ODE_GROUND_COEFFS			35
 #define RB_PLANAR						36
 #define RB_SOFT_BODY					37
+#define RB_COLLISION_BITS				38
+#define RB_CDP_COLLISION_BITS			39
 
 /**
 	This method is used to determine the type of a line that was used in the input file for a rigid body.
 	It is assumed that there are no white spaces at the beginning of the string that is passed in. the pointer buffer
 	will be updated to point at the first character after the keyword.
 */
-PHYSICS_DECLSPEC int getRBLineType(char* &buffer);
\ No newline at end of file
+PHYSICS_DECLSPEC int getRBLineType(char* &buffer);
+
+/**
+	This method is used to read a pair of collision bitmasks (category bits, then collide bits) from the string that is passed in.
+	The values can be written in decimal or in hexadecimal (0x...). Returns false if the two values could not be read.
+*/
+PHYSICS_DECLSPEC bool readCollisionBits(char* buffer, uint* categoryBits, uint* collideBits);
\ No newline at end of file
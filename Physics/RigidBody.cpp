@@ -23,11 +23,15 @@
 
 #include ".\rigidbody.h"
 #include <Physics/RBUtils.h>
+#ifndef HEADLESS
 #include <GLUtils/OBJReader.h>
+#endif
 #include <Physics/CapsuleCDP.h>
 #include <Physics/PlaneCDP.h>
 #include <Physics/BoxCDP.h>
 #include <Physics/SphereCDP.h>
+#include <Physics/World.h>
+#include <Physics/ArticulatedFigure.h>
 
 #include <Utils/Utils.h>
 
@@ -36,15 +40,39 @@
 */
 RigidBody::RigidBody(void){
 	name[0] = '\0';
+	id = -1;
+	world = NULL;
 //	toWorld.loadIdentity();
 }
 
+/**
+	This method is used to let the world know that the collision bitmasks of the body, or of one of its primitives, were changed.
+*/
+void RigidBody::collisionBitsChanged(){
+	if (world != NULL)
+		world->updateCollisionBits(this);
+}
+
+/**
+	This method sets the rigid body name, and lets the world and the articulated figure it belongs to know that it was renamed.
+*/
+void RigidBody::setName( char* name ){
+	strncpy( this->name, name, 99 );
+	if (world != NULL)
+		world->namesChanged();
+	ArticulatedFigure* af = getAFParent();
+	if (af != NULL)
+		af->namesChanged();
+}
+
 /**
 	Default destructor - free up all the memory that we've used up
 */
 RigidBody::~RigidBody(void){
+#ifndef HEADLESS
 	for (uint i=0;i<meshes.size();i++)
 		delete meshes[i];
+#endif
 
 	for (uint i=0;i<cdps.size();i++)
 		delete cdps[i];
@@ -108,6 +136,14 @@ Vector3d RigidBody::getAbsoluteVelocityForGlobalPoint(const Point3d& globalPoint
 	This method draws the current rigid body.
 */
 void RigidBody::draw(int flags){
+	drawAt(flags, state.position, state.orientation);
+}
+
+/**
+	This method draws the rigid body as if it was at the given position and orientation, rather than where its state says it is.
+*/
+void RigidBody::drawAt(int flags, const Point3d& position, const Quaternion& orientation){
+#ifndef HEADLESS
 	if (flags & SHOW_ABSTRACT_VIEW_SKELETON)
 		return;
 	//multiply the gl matrix with the transformations needed to go from local space into world space
@@ -116,8 +152,8 @@ void RigidBody::draw(int flags){
 	GLboolean lighting = glIsEnabled(GL_LIGHTING);
 
 	TransformationMatrix toWorld;
-	this->state.orientation.getRotationMatrix(&toWorld);
-	toWorld.setTranslation(this->state.position);
+	orientation.getRotationMatrix(&toWorld);
+	toWorld.setTranslation(position);
 
 	double values[16];
 	toWorld.getOGLValues(values);
@@ -180,6 +216,7 @@ void RigidBody::draw(int flags){
 	}
 
 	glPopMatrix();
+#endif
 }
 
 /**
@@ -231,7 +268,10 @@ void RigidBody::loadFromFile(FILE* f){
 	Vector3d n;
 	double t1, t2, t3;
 	double t;
+	uint t1bits, t2bits;
+#ifndef HEADLESS
 	GLMesh* tmpMesh;
+#endif
 
 	//this is where it happens.
 	while (!feof(f)){
@@ -247,10 +287,12 @@ void RigidBody::loadFromFile(FILE* f){
 				break;
 			case RB_MESH_NAME:
 				sscanf(line, "%s", meshName);
+#ifndef HEADLESS
 				tmpMesh = OBJReader::loadOBJFile(meshName);
 				tmpMesh->computeNormals();
 				tmpMesh->dontUseTextureMapping();
 				meshes.push_back(tmpMesh);
+#endif
 				break;
 			case RB_MASS:
 				if (sscanf(line, "%lf", &t)!=1)
@@ -270,8 +312,7 @@ void RigidBody::loadFromFile(FILE* f){
 			case RB_COLOUR:
 				if (sscanf(line, "%lf %lf %lf %lf", &r, &g, &b, &a)!=4)
 					throwError("Incorrect rigid body input file - colour parameter expects 4 arguments (colour %s)\n", line);
-				if (meshes.size()>0)
-					meshes[meshes.size()-1]->setColour(r, g, b, a);
+				setColour(r, g, b, a);
 				break;
 			case RB_SPHERE:
 				if (sscanf(line, "%lf %lf %lf %lf", &p1.x, &p1.y, &p1.z, &r)!=4)
@@ -338,6 +379,18 @@ void RigidBody::loadFromFile(FILE* f){
 			case RB_PLANAR:
 				props.isPlanar = true;
 				break;
+			case RB_COLLISION_BITS:
+				if (readCollisionBits(line, &props.categoryBits, &props.collideBits) == false)
+					throwError("Incorrect rigid body input file - the category and collide bits need to be specified if the 'collisionBits' keyword is used.");
+				break;
+			case RB_CDP_COLLISION_BITS:
+				if (cdps.size() == 0)
+					throwError("Incorrect rigid body input file - 'CDP_CollisionBits' applies to the last collision detection primitive, but none was specified.");
+				if (readCollisionBits(line, &t1bits, &t2bits) == false)
+					throwError("Incorrect rigid body input file - the category and collide bits need to be specified if the 'CDP_CollisionBits' keyword is used.");
+				cdps[cdps.size()-1]->setCategoryBits(t1bits);
+				cdps[cdps.size()-1]->setCollideBits(t2bits);
+				break;
 			default:
 				throwError("Incorrect rigid body input file: \'%s\' - unexpected line.", buffer);
 		}
@@ -350,6 +403,7 @@ void RigidBody::loadFromFile(FILE* f){
 	This method loads an OBJ mesh and associates it with the rigid body
 */
 void RigidBody::addMeshObj( char* objFilename, const Vector3d& offset, const Vector3d& scale ) {
+#ifndef HEADLESS
 	GLMesh* tmpMesh;
 	tmpMesh = OBJReader::loadOBJFile(objFilename);
 	tmpMesh->offset( offset );
@@ -357,12 +411,15 @@ void RigidBody::addMeshObj( char* objFilename, const Vector3d& offset, const Vec
 	tmpMesh->computeNormals();
 	tmpMesh->dontUseTextureMapping();
 	meshes.push_back(tmpMesh);
+#endif
 }
 
 /**
 	This method sets the colour of the last mesh loaded
 */
 void RigidBody::setColour( double r, double g, double b, double a ) {	
+#ifndef HEADLESS
 	if (meshes.size()>0)
 		meshes[meshes.size()-1]->setColour(r, g, b, a);
+#endif
 }
\ No newline at end of file
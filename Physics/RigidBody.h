@@ -23,8 +23,13 @@
 
 #include <MathLib/TransformationMatrix.h>
 
+#ifndef HEADLESS
 #include <GLUtils/GLMesh.h>
 #include <GLUtils/GLUtils.h>
+#else
+//GLUtils is what brings in windows.h (and its min and max) otherwise
+#include <windows.h>
+#endif
 
 #include <Physics/PhysicsDll.h>
 #include <Physics/RBState.h>
@@ -34,6 +39,7 @@
 
 class Force;
 class ArticulatedFigure;
+class World;
 
 
 //define some drawing flags:
@@ -60,6 +66,8 @@ friend class HingeJoint;
 friend class UniversalJoint;
 friend class BallInSocketJoint;
 friend class ODEWorld;
+friend class FeatherstoneWorld;
+friend class ContactIndex;
 friend class Character;
 friend class SimBiController;
 friend class Joint;
@@ -82,12 +90,16 @@ protected:
 
 	//--> an array with all the collision detection primitives that are relevant for this rigid body
 	DynamicArray<CollisionDetectionPrimitive*> cdps;
+#ifndef HEADLESS
 	//--> the mesh(es) that are used when displaying this rigid body
 	DynamicArray<GLMesh*> meshes;
+#endif
 	//--> the name of the rigid body - it might be used to reference the object for articulated bodies
 	char name[100];
 	//--> the id of the rigid body
 	int id;
+	//--> the world the rigid body was added to (NULL until then). It is told when the collision bitmasks change
+	World* world;
 
 	//--> this transformation matrix is used to transform points/vectors from local coordinates to global coordinates. It will be updated using the state
 	//information, and is therefore redundant, but it will be used to draw the object quickly. Everytime the state is updated, this matrix must also be updated!
@@ -160,7 +172,8 @@ public:
 		This method sets the world coordinate of the posision of the center of mass of the object
 	*/
 	inline void setCMPosition(const Point3d& newCMPos){
-		state.position = newCMPos;		
+		state.position = newCMPos;
+		state.markModified();
 	}
 
 	/**
@@ -172,6 +185,7 @@ public:
 
 	inline void setOrientation(double angle, Vector3d axis) {
 		state.orientation = Quaternion::getRotationQuaternion(angle, axis.toUnit()) * state.orientation;
+		state.markModified();
 	}
 
 	/**
@@ -179,6 +193,7 @@ public:
 	*/
 	inline void setCMVelocity(const Vector3d& newCMVel){
 		state.velocity = newCMVel;
+		state.markModified();
 	}
 
 	/**
@@ -186,6 +201,7 @@ public:
 	*/
 	inline void setAngularVelocity(const Vector3d& newAVel){
 		state.angularVelocity = newAVel;
+		state.markModified();
 	}
 
 	/**
@@ -203,10 +219,16 @@ public:
 	}
 
 	/**
-		This method draws the current rigid body.
+		This method draws the current rigid body. It does nothing in the headless build.
 	*/
 	virtual void draw(int flags);
 
+	/**
+		This method draws the rigid body as if it was at the given position and orientation, rather than where its state says it is.
+		Only the body itself is drawn, not the joints or the skeleton of articulated bodies.
+	*/
+	void drawAt(int flags, const Point3d& position, const Quaternion& orientation);
+
 	/**
 		This method renders the rigid body in its current state as a set of vertices 
 		and faces that will be appended to the passed OBJ file.
@@ -227,16 +249,14 @@ public:
 	/**
 		This method sets the rigid body name
 	*/
-	void setName( char* name ) {
-		strncpy( this->name, name, 99 );
-	}
+	void setName( char* name );
 
 	const char* getName() const {
 		return name;
 	}
 
 	/**
-		This method loads an OBJ mesh and associates it with the rigid body
+		This method loads an OBJ mesh and associates it with the rigid body. The headless build has no meshes, and ignores it.
 	*/
 	void addMeshObj( char* objFilename, const Vector3d& offset = Vector3d(0,0,0), const Vector3d& scale = Vector3d(1,1,1) );
 
@@ -245,6 +265,7 @@ public:
 	*/
 	void setColour( double r, double g, double b, double a );
 
+#ifndef HEADLESS
 	void addMesh( GLMesh* mesh_disown ) {
 		meshes.push_back(mesh_disown);
 	}
@@ -258,6 +279,7 @@ public:
 			return NULL;
 		return meshes[index];
 	}
+#endif
 
 	int getCDPCount() const {
 		return cdps.size();
@@ -316,6 +338,7 @@ public:
 		if (frictionCoefficient<0)
 			throwError("Friction coefficient should be >= 0");
 		props.mu = frictionCoefficient;
+		props.materialID = -1;
 	}
 
 	/**
@@ -325,6 +348,7 @@ public:
 		if (restitutionCoefficient<0 || restitutionCoefficient>1)
 			throwError("Restitution coefficient should be between 0 and 1");
 		props.epsilon = restitutionCoefficient;
+		props.materialID = -1;
 	}
 
 	double getGroundSoftness() const { return props.groundSoftness; }
@@ -336,8 +360,14 @@ public:
 	void setODEGroundCoefficients( double softness, double penalty ) {
 		props.groundSoftness = softness;
 		props.groundPenalty = penalty;
+		props.materialID = -1;
 	}
 	
+	/**
+		This method returns the material that the world assigned to the body (-1 if none was assigned yet)
+	*/
+	int getMaterialID() const { return props.materialID; }
+	
 	double getODEGroundSoftness() const { return props.groundSoftness; }
 	double getODEGroundPenalty() const { return props.groundPenalty; }
 
@@ -350,6 +380,30 @@ public:
 
 	bool isPlanar() const { return props.isPlanar; }
 
+	/**
+		These methods are used to set the collision filtering bitmasks of the body. Two bodies are only checked for collisions if the category
+		bits of one of them share a bit with the collide bits of the other - for instance, the bodies of a character can all be given the same
+		category bit and have it cleared from their collide bits to turn off self-collisions. They can be changed at any time, even once the body
+		is in a world.
+	*/
+	void setCategoryBits( uint bits ) {
+		props.categoryBits = bits;
+		collisionBitsChanged();
+	}
+
+	void setCollideBits( uint bits ) {
+		props.collideBits = bits;
+		collisionBitsChanged();
+	}
+
+	uint getCategoryBits() const { return props.categoryBits; }
+	uint getCollideBits() const { return props.collideBits; }
+
+	/**
+		This method is used to let the world know that the collision bitmasks of the body, or of one of its primitives, were changed.
+	*/
+	void collisionBitsChanged();
+
 	/**
 		Returns the mass of the rigid body
 	*/
@@ -389,6 +443,7 @@ public:
 	*/
 	inline void setOrientation(Quaternion q){
 		state.orientation = q;
+		state.markModified();
 	}
 
 	/**
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <MathLib/Vector3d.h>
+#include <MathLib/Point3d.h>
+
+/*==================================================================================================================================================*
+ * These classes implement the bits of spatial (6d) vector algebra that the articulated body algorithm needs. A spatial vector is made up of an     *
+ * angular part and a linear part. For motion vectors these are the angular velocity and the velocity of the body point that is at the world origin *
+ * at this instant; for force vectors they are the moment about the world origin and the force. Everything is expressed in world coordinates, so   *
+ * no coordinate transformations are ever needed between the bodies.                                                                               *
+ *==================================================================================================================================================*/
+class SpatialVector{
+public:
+	//the angular part
+	Vector3d w;
+	//the linear part
+	Vector3d v;
+
+	SpatialVector(){}
+
+	SpatialVector(const Vector3d& w, const Vector3d& v) : w(w), v(v) {}
+
+	inline void setToZero(){
+		w = Vector3d();
+		v = Vector3d();
+	}
+
+	inline SpatialVector operator + (const SpatialVector& other) const{
+		return SpatialVector(w + other.w, v + other.v);
+	}
+
+	inline SpatialVector operator - (const SpatialVector& other) const{
+		return SpatialVector(w - other.w, v - other.v);
+	}
+
+	inline SpatialVector operator * (double n) const{
+		return SpatialVector(w * n, v * n);
+	}
+
+	inline SpatialVector& operator += (const SpatialVector& other){
+		w += other.w;
+		v += other.v;
+		return *this;
+	}
+
+	inline SpatialVector& operator -= (const SpatialVector& other){
+		w -= other.w;
+		v -= other.v;
+		return *this;
+	}
+
+	/**
+		This method is used to add a multiple of the spatial vector that is passed in to the current one.
+	*/
+	inline void addScaledVector(const SpatialVector& other, double s){
+		w.addScaledVector(other.w, s);
+		v.addScaledVector(other.v, s);
+	}
+
+	/**
+		Returns the scalar product of the two spatial vectors - the power, when one is a motion and the other is a force.
+	*/
+	inline double dotProductWith(const SpatialVector& other) const{
+		return w.dotProductWith(other.w) + v.dotProductWith(other.v);
+	}
+
+	/**
+		Returns the ith component of the vector: 0 to 2 are the angular part, 3 to 5 the linear part.
+	*/
+	inline double get(int i) const{
+		switch (i){
+			case 0: return w.x;
+			case 1: return w.y;
+			case 2: return w.z;
+			case 3: return v.x;
+			case 4: return v.y;
+			default: return v.z;
+		}
+	}
+
+	inline void set(int i, double val){
+		switch (i){
+			case 0: w.x = val; break;
+			case 1: w.y = val; break;
+			case 2: w.z = val; break;
+			case 3: v.x = val; break;
+			case 4: v.y = val; break;
+			default: v.z = val;
+		}
+	}
+
+	/**
+		Returns the motion vector of a pure rotation with angular velocity axis, about a line that goes through the point p.
+	*/
+	inline static SpatialVector getRotationAbout(const Vector3d& axis, const Point3d& p){
+		return SpatialVector(axis, Vector3d(p).crossProductWith(axis));
+	}
+
+	/**
+		Returns the force vector of the force f, applied at the point p.
+	*/
+	inline static SpatialVector getForceAt(const Vector3d& f, const Point3d& p){
+		return SpatialVector(Vector3d(p).crossProductWith(f), f);
+	}
+};
+
+/**
+	Returns the cross product of the motion vector m with the motion vector x (the rate of change of x, if x moves with velocity m).
+*/
+inline SpatialVector crossMotion(const SpatialVector& m, const SpatialVector& x){
+	return SpatialVector(m.w.crossProductWith(x.w), m.w.crossProductWith(x.v) + m.v.crossProductWith(x.w));
+}
+
+/**
+	Returns the cross product of the motion vector m with the force vector f (the rate of change of f, if f moves with velocity m).
+*/
+inline SpatialVector crossForce(const SpatialVector& m, const SpatialVector& f){
+	return SpatialVector(m.w.crossProductWith(f.w) + m.v.crossProductWith(f.v), m.w.crossProductWith(f.v));
+}
+
+/*==================================================================================================================================================*
+ * This class implements a 6x6 matrix that maps spatial vectors to spatial vectors, such as the (articulated) inertia of a body.                    *
+ *==================================================================================================================================================*/
+class SpatialMatrix{
+public:
+	double m[6][6];
+
+	SpatialMatrix(){
+		setToZero();
+	}
+
+	inline void setToZero(){
+		for (int i=0;i<6;i++)
+			for (int j=0;j<6;j++)
+				m[i][j] = 0;
+	}
+
+	/**
+		This method is used to set the matrix to the spatial inertia of a rigid body of the given mass, whose center of mass is at c and whose
+		rotational inertia about the center of mass is I (a row-major 3x3 matrix, in world coordinates).
+	*/
+	inline void setToRigidBodyInertia(double mass, const Point3d& c, const double* I){
+		//the upper left block is I + m cx cx^T, the off-diagonal blocks are m cx and its transpose, and the lower right block is m 1
+		double cx[3][3] = {{0, -c.z, c.y}, {c.z, 0, -c.x}, {-c.y, c.x, 0}};
+		for (int i=0;i<3;i++){
+			for (int j=0;j<3;j++){
+				double cxcxT = 0;
+				for (int k=0;k<3;k++)
+					cxcxT += cx[i][k] * cx[j][k];
+				m[i][j] = I[3*i+j] + mass * cxcxT;
+				m[i][j+3] = mass * cx[i][j];
+				m[i+3][j] = mass * cx[j][i];
+				m[i+3][j+3] = (i == j)?(mass):(0);
+			}
+		}
+	}
+
+	inline SpatialVector operator * (const SpatialVector& x) const{
+		double in[6] = {x.w.x, x.w.y, x.w.z, x.v.x, x.v.y, x.v.z};
+		double out[6];
+		for (int i=0;i<6;i++){
+			out[i] = 0;
+			for (int j=0;j<6;j++)
+				out[i] += m[i][j] * in[j];
+		}
+		return SpatialVector(Vector3d(out[0], out[1], out[2]), Vector3d(out[3], out[4], out[5]));
+	}
+
+	inline SpatialMatrix& operator += (const SpatialMatrix& other){
+		for (int i=0;i<6;i++)
+			for (int j=0;j<6;j++)
+				m[i][j] += other.m[i][j];
+		return *this;
+	}
+
+	/**
+		This method is used to subtract s * a * b^T from the matrix.
+	*/
+	inline void subtractOuterProduct(const SpatialVector& a, const SpatialVector& b, double s){
+		for (int i=0;i<6;i++){
+			double ai = a.get(i) * s;
+			for (int j=0;j<6;j++)
+				m[i][j] -= ai * b.get(j);
+		}
+	}
+
+	/**
+		This method returns the x for which the matrix times x is b. The matrix is assumed to be invertible (gaussian elimination with
+		partial pivoting is used).
+	*/
+	inline SpatialVector solve(const SpatialVector& b) const{
+		double a[6][7];
+		for (int i=0;i<6;i++){
+			for (int j=0;j<6;j++)
+				a[i][j] = m[i][j];
+			a[i][6] = b.get(i);
+		}
+		for (int col=0;col<6;col++){
+			int pivot = col;
+			for (int i=col+1;i<6;i++)
+				if (fabs(a[i][col]) > fabs(a[pivot][col]))
+					pivot = i;
+			if (pivot != col)
+				for (int j=col;j<7;j++){
+					double tmp = a[col][j]; a[col][j] = a[pivot][j]; a[pivot][j] = tmp;
+				}
+			for (int i=col+1;i<6;i++){
+				double f = a[i][col] / a[col][col];
+				for (int j=col;j<7;j++)
+					a[i][j] -= f * a[col][j];
+			}
+		}
+		SpatialVector x;
+		for (int i=5;i>=0;i--){
+			double sum = a[i][6];
+			for (int j=i+1;j<6;j++)
+				sum -= a[i][j] * x.get(j);
+			x.set(i, sum / a[i][i]);
+		}
+		return x;
+	}
+};
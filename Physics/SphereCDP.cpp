@@ -1,5 +1,7 @@
 #include ".\spherecdp.h"
+#ifndef HEADLESS
 #include <GLUtils/GLUtils.h>
+#endif
 #include <MathLib/Segment.h>
 #include <Physics/CapsuleCDP.h>
 #include <Physics/PlaneCDP.h>
@@ -13,7 +15,9 @@ SphereCDP::~SphereCDP(void){
 	Draw an outline of the sphere
 */
 void SphereCDP::draw(){
+#ifndef HEADLESS
 	GLUtils::drawSphere(s.pos, s.radius, 5);
+#endif
 }
 
 /**
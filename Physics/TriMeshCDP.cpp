@@ -0,0 +1,112 @@
+#include "TriMeshCDP.h"
+#ifndef HEADLESS
+#include <GLUtils/GLUtils.h>
+#include <GLUtils/GLMesh.h>
+#include <GLUtils/OBJReader.h>
+#endif
+
+TriMeshCDP::~TriMeshCDP(void){
+}
+
+/**
+	This method is used to add a vertex to the mesh. It returns the index of the vertex.
+*/
+int TriMeshCDP::addVertex(const Point3d& p){
+	vertices.push_back(p.x);
+	vertices.push_back(p.y);
+	vertices.push_back(p.z);
+	return getVertexCount() - 1;
+}
+
+/**
+	This method is used to add a triangle to the mesh, given the indices of its vertices in counter-clockwise order.
+*/
+void TriMeshCDP::addTriangle(int i1, int i2, int i3){
+	int n = getVertexCount();
+	if (i1<0 || i1>=n || i2<0 || i2>=n || i3<0 || i3>=n)
+		throwError("Triangle (%d, %d, %d) refers to a vertex that is not in the mesh (%d vertices).", i1, i2, i3, n);
+	indices.push_back(i1);
+	indices.push_back(i2);
+	indices.push_back(i3);
+}
+
+/**
+	This method is used to add the triangles of a box to the mesh.
+*/
+void TriMeshCDP::addBox(const Point3d& center, const Vector3d& size, const Quaternion& orientation){
+	//the corners are numbered so that bit 0 is x, bit 1 is y and bit 2 is z
+	int first = getVertexCount();
+	for (int i=0;i<8;i++){
+		Vector3d corner((i & 1)?(size.x/2):(-size.x/2), (i & 2)?(size.y/2):(-size.y/2), (i & 4)?(size.z/2):(-size.z/2));
+		addVertex(center + orientation.rotate(corner));
+	}
+
+	//two triangles per face, counter-clockwise when seen from the outside
+	static const int faces[6][4] = { {0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6} };
+	for (int i=0;i<6;i++){
+		addTriangle(first + faces[i][0], first + faces[i][1], first + faces[i][2]);
+		addTriangle(first + faces[i][0], first + faces[i][2], first + faces[i][3]);
+	}
+}
+
+#ifndef HEADLESS
+/**
+	This method is used to add the triangles of all the polygons of the mesh that is read from the given OBJ file.
+*/
+void TriMeshCDP::addOBJFile(char* objFilename, const Vector3d& offset, const Vector3d& scale){
+	GLMesh* mesh = OBJReader::loadOBJFile(objFilename);
+	mesh->scale(scale);
+	mesh->offset(offset);
+
+	int first = getVertexCount();
+	double* v = mesh->getVertexArray();
+	for (int i=0;i<mesh->getVertexCount();i++)
+		addVertex(Point3d(v[3*i], v[3*i+1], v[3*i+2]));
+
+	DynamicArray<int> triangles;
+	mesh->getTriangleIndices(&triangles);
+	for (uint i=0;i<triangles.size();i+=3)
+		addTriangle(first + triangles[i], first + triangles[i+1], first + triangles[i+2]);
+
+	delete mesh;
+}
+
+/**
+	This method is used to create a mesh that can be drawn, with the triangles of this primitive.
+*/
+GLMesh* TriMeshCDP::createMesh(){
+	GLMesh* mesh = new GLMesh();
+	for (uint i=0;i<indices.size();i+=3){
+		GLIndexedPoly poly;
+		for (int j=0;j<3;j++){
+			Point3d p(vertices[3*indices[i+j]], vertices[3*indices[i+j]+1], vertices[3*indices[i+j]+2]);
+			mesh->addVertex(p);
+			poly.addVertexIndex(i+j);
+		}
+		mesh->addPoly(poly);
+	}
+	mesh->computeNormals();
+	return mesh;
+}
+#endif
+
+/**
+	Draw the triangles of the mesh
+*/
+void TriMeshCDP::draw(){
+#ifndef HEADLESS
+	glBegin(GL_TRIANGLES);
+	for (uint i=0;i<indices.size();i+=3){
+		Point3d p1(vertices[3*indices[i]], vertices[3*indices[i]+1], vertices[3*indices[i]+2]);
+		Point3d p2(vertices[3*indices[i+1]], vertices[3*indices[i+1]+1], vertices[3*indices[i+1]+2]);
+		Point3d p3(vertices[3*indices[i+2]], vertices[3*indices[i+2]+1], vertices[3*indices[i+2]+2]);
+		Vector3d n = Vector3d(p1, p2).crossProductWith(Vector3d(p1, p3));
+		n.toUnit();
+		glNormal3d(n.x, n.y, n.z);
+		glVertex3d(p1.x, p1.y, p1.z);
+		glVertex3d(p2.x, p2.y, p2.z);
+		glVertex3d(p3.x, p3.y, p3.z);
+	}
+	glEnd();
+#endif
+}
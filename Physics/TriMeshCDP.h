@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Utils/Utils.h>
+
+#include <MathLib/Point3d.h>
+#include <MathLib/Vector3d.h>
+#include <MathLib/Quaternion.h>
+
+#include <Physics/PhysicsDll.h>
+#include <Physics/CollisionDetectionPrimitive.h>
+
+class GLMesh;
+
+/*========================================================================================================================================================================*
+ * This class implements a triangle mesh that will be used as a collision detection primitive for complex static environments, such as staircases or whole levels. The   *
+ * triangles can be read from an OBJ file, or built up procedurally. The physics engine keeps a bounding volume hierarchy over the triangles, so a whole environment is a *
+ * single primitive as far as the broad phase is concerned. NOTE: like planes, triangle meshes can only be used by static objects, and they can't be changed once the   *
+ * body is in a world.                                                                                                                                                    *
+ *========================================================================================================================================================================*/
+class PHYSICS_DECLSPEC TriMeshCDP : public CollisionDetectionPrimitive{
+private:
+	//the coordinates of the vertices (x, y, z), expressed in local coordinates
+	DynamicArray<double> vertices;
+	//the indices of the vertices of the triangles, three per triangle, in counter-clockwise order when seen from the outside
+	DynamicArray<int> indices;
+
+public:
+	TriMeshCDP(RigidBody* theBody = NULL) :
+		CollisionDetectionPrimitive( TRIMESH_CDP, theBody ) {}
+	virtual ~TriMeshCDP(void);
+
+	virtual char* save() { return "TriMeshCDP"; }
+
+	virtual void updateToWorldPrimitive(){}
+
+	/**
+		Draw the triangles of the mesh
+	*/
+	virtual void draw();
+
+	/**
+		This method is used to add a vertex to the mesh. It returns the index of the vertex.
+	*/
+	int addVertex(const Point3d& p);
+
+	/**
+		This method is used to add a triangle to the mesh, given the indices of its vertices in counter-clockwise order.
+	*/
+	void addTriangle(int i1, int i2, int i3);
+
+	/**
+		This method is used to add the triangles of a box to the mesh. The box is centered at the given point, has the given
+		size along its x, y and z axes, and is rotated by the given orientation.
+	*/
+	void addBox(const Point3d& center, const Vector3d& size, const Quaternion& orientation = Quaternion());
+
+#ifndef HEADLESS
+	/**
+		This method is used to add the triangles of all the polygons of the mesh that is read from the given OBJ file. The
+		vertices are scaled and then offset by the given amounts.
+	*/
+	void addOBJFile(char* objFilename, const Vector3d& offset = Vector3d(0,0,0), const Vector3d& scale = Vector3d(1,1,1));
+
+	/**
+		This method is used to create a mesh that can be drawn, with the triangles of this primitive. Every triangle gets its own
+		vertices, so that it can have its own normal.
+	*/
+	GLMesh* createMesh();
+#endif
+
+	inline int getVertexCount() const {
+		return vertices.size() / 3;
+	}
+
+	inline int getTriangleCount() const {
+		return indices.size() / 3;
+	}
+
+	/**
+		These methods return the array of vertex coordinates (three per vertex) and the array of indices (three per triangle).
+	*/
+	inline const double* getVertexData() const {
+		return (vertices.size() > 0)?(&vertices[0]):(NULL);
+	}
+
+	inline const int* getIndexData() const {
+		return (indices.size() > 0)?(&indices[0]):(NULL);
+	}
+
+	virtual int computeCollisionsWith(CollisionDetectionPrimitive* other,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithSphereCDP(SphereCDP* sp,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithPlaneCDP(PlaneCDP* sp,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithCapsuleCDP(CapsuleCDP* c,  DynamicArray<ContactPoint> *cps){return 0;}
+	virtual int computeCollisionsWithBoxCDP(BoxCDP* sp,  DynamicArray<ContactPoint> *cps){return 0;}
+};
@@ -9,6 +9,7 @@
 
 class PHYSICS_DECLSPEC UniversalJoint : public Joint{
 friend class ODEWorld;
+friend class FeatherstoneWorld;
 private:
 	//This joint can only rotate about the vector a, that is stored in parent coordinates
 	Vector3d a;
@@ -1,16 +1,19 @@
 #include <cstdlib>
+#include <cassert>
 
 #include "World.h"
 #include <Physics/RBUtils.h>
 #include <Utils/Utils.h>
 
-#include <Physics/ODEWorld.h>   // Singleton will be an instance of ODEWorld
+#include <Physics/ODEWorld.h>
+#include <Physics/FeatherstoneWorld.h>
 
 // Singleton stuff
 World* World::_instance = NULL;
+int World::defaultEngine = World::ENGINE_ODE;
 void World::create() {
 	assert( _instance == NULL );
-	_instance = new ODEWorld();
+	_instance = createWorld(defaultEngine);
 	std::atexit( World::destroy );
 }
 
@@ -21,9 +24,36 @@ void World::destroy() {
 
 
 
+/**
+	This method is used to select the physics engine that the default world is simulated with.
+*/
+void World::setDefaultEngine(int engine){
+	if (engine != ENGINE_ODE && engine != ENGINE_FEATHERSTONE)
+		throwError("Unknown physics engine: %d.", engine);
+	if (_instance != NULL && engine != defaultEngine)
+		throwError("The default world already exists, its physics engine can't be changed anymore.");
+	defaultEngine = engine;
+}
+
+/**
+	This method returns a new, empty world that is simulated with the given physics engine.
+*/
+World* World::createWorld(int engine){
+	switch (engine){
+		case ENGINE_ODE:
+			return new ODEWorld();
+		case ENGINE_FEATHERSTONE:
+			return new FeatherstoneWorld();
+		default:
+			throwError("Unknown physics engine: %d.", engine);
+	}
+	return NULL;
+}
+
 World::World(void){
 	this->objects = DynamicArray<RigidBody*>(300);
 	this->objects.clear();
+	namesVersion = 0;
 }
 
 World::~World(void){
@@ -44,6 +74,9 @@ void World::destroyWorld() {
 
 	ABs.clear();
 
+	objectNames.clear();
+	arbNames.clear();
+
 	//delete the references to the articulated figures that we hold as well
 	for (uint i=0;i<AFs.size();i++)
 		delete AFs[i];
@@ -52,6 +85,7 @@ void World::destroyWorld() {
 	jts.clear();
 
 	contactPoints.clear();
+	contactIndex.clear();
 }
 
 void World::destroyAllObjects() {
@@ -90,14 +124,7 @@ uint World::renderRBsToObjFile(FILE* fp, uint vertexIdxOffset){
 	its name and its articulared figure name, or NULL if it is not found
 */
 ArticulatedRigidBody* World::getARBByName(char* name, char* articulatedFigureName){
-	if (name == NULL)
-		return NULL;
-	for (uint i=0;i<ABs.size();i++)
-		if (strcmp(name, ABs[i]->name) == 0)
-			if( articulatedFigureName == NULL ||
-				strcmp( articulatedFigureName, ABs[i]->getAFParent()->getName() ) == 0 )
-			return ABs[i];
-	return NULL;
+	return findARBByName(name, NULL, articulatedFigureName);
 }
 
 /**
@@ -105,11 +132,28 @@ ArticulatedRigidBody* World::getARBByName(char* name, char* articulatedFigureNam
 	its name and its articulared figure name, or NULL if it is not found
 */
 ArticulatedRigidBody* World::getARBByName(char* name, const ArticulatedFigure* articulatedFigure){
+	if (articulatedFigure == NULL)
+		return NULL;
+	return findARBByName(name, articulatedFigure, NULL);
+}
+
+/**
+	This method returns the first articulated rigid body with the given name that belongs to the articulated figure, or to the articulated
+	figure with the given name. If both are NULL, any articulated figure will do.
+*/
+ArticulatedRigidBody* World::findARBByName(const char* name, const ArticulatedFigure* articulatedFigure, const char* articulatedFigureName){
 	if (name == NULL)
 		return NULL;
-	for (uint i=0;i<ABs.size();i++)
-		if (strcmp(name, ABs[i]->name) == 0 && articulatedFigure == ABs[i]->getAFParent() )
-			return ABs[i];
+	//the bodies with the same name are chained in the index, so only those are looked at
+	if (!arbNames.isUpToDate(ABs, namesVersion))
+		arbNames.build(ABs, namesVersion);
+	for (int i = arbNames.find(name); i >= 0; i = arbNames.findNext(i)){
+		if (articulatedFigure != NULL && articulatedFigure != ABs[i]->getAFParent())
+			continue;
+		if (articulatedFigureName != NULL && strcmp(articulatedFigureName, ABs[i]->getAFParent()->getName()) != 0)
+			continue;
+		return ABs[i];
+	}
 	return NULL;
 }
 
@@ -119,10 +163,8 @@ ArticulatedRigidBody* World::getARBByName(char* name, const ArticulatedFigure* a
 RigidBody* World::getRBByName(char* name){
 	if (name == NULL)
 		return NULL;
-	for (uint i=0;i<this->objects.size();i++)
-		if (strcmp(name, objects[i]->name) == 0)
-			return objects[i];
-	return NULL;
+	int i = objectNames.findIn(objects, namesVersion, name);
+	return (i >= 0)?(objects[i]):(NULL);
 }
 
 /**
@@ -152,12 +194,16 @@ void World::loadRBsFromFile(char* fName){
 				//create a new rigid body and have it load its own info...
 				newBody = new RigidBody();
 				newBody->loadFromFile(f);
+				newBody->setBodyID(objects.size());
+				newBody->world = this;
 				objects.push_back(newBody);
 				break;
 			case RB_ARB:
 				//create a new articulated rigid body and have it load its own info...
 				newBody = new ArticulatedRigidBody();
 				newBody->loadFromFile(f);
+				newBody->setBodyID(objects.size());
+				newBody->world = this;
 				objects.push_back(newBody);
 				//remember it as an articulated rigid body to be able to link it with other ABs later on
 				ABs.push_back((ArticulatedRigidBody*)newBody);
@@ -192,6 +238,9 @@ void World::loadRBsFromFile(char* fName){
 	This method adds one rigid body (not articulated).
 */
 void World::addRigidBody(RigidBody* rigidBody){
+	//the id of a rigid body is its position in the world
+	rigidBody->setBodyID(objects.size());
+	rigidBody->world = this;
 	objects.push_back(rigidBody);
 	if( rigidBody->isArticulated() )
 		ABs.push_back((ArticulatedRigidBody*)rigidBody);
@@ -201,7 +250,7 @@ void World::addRigidBody(RigidBody* rigidBody){
 	This method adds one rigid body (not articulated).
 */
 void World::addArticulatedFigure(ArticulatedFigure* articulatedFigure){
-	articulatedFigure->loadIntoWorld();
+	articulatedFigure->loadIntoWorld(this);
 	AFs.push_back(articulatedFigure);
 	articulatedFigure->addJointsToList(&jts);
 	articulatedFigure->fixJointConstraints();
@@ -245,7 +294,93 @@ void World::setState(DynamicArray<double>* state, int start){
 		i+=3;
 		objects[j]->state.angularVelocity = Vector3d((*state)[i+0], (*state)[i+1], (*state)[i+2]);
 		i+=3;
+		objects[j]->state.markModified();
 //		objects[j]->updateToWorldTransformation();
 	}
 }
 
+/**
+	This method is used to append the complete state of the world to the binary buffer. Everything else that the physics engine
+	uses is rebuilt from the rigid body states at every step, so restoring this state and stepping reproduces the original simulation.
+*/
+void World::saveState(BinaryBuffer* buffer){
+	//the states are copied straight out of the arrays of the state store, one block per quantity
+	RBStateStore* store = getStateStore();
+	buffer->writeInt(objects.size());
+	buffer->write(store->getPositionData(), store->getDataSize());
+	buffer->write(store->getOrientationData(), store->getDataSize());
+	buffer->write(store->getVelocityData(), store->getDataSize());
+	buffer->write(store->getAngularVelocityData(), store->getDataSize());
+
+	//the rigid bodies in contact are stored by index
+	buffer->writeInt(contactPoints.size());
+	for (uint i=0;i<contactPoints.size();i++){
+		buffer->writeValue(contactPoints[i].cp);
+		buffer->writeValue(contactPoints[i].n);
+		buffer->writeValue(contactPoints[i].d);
+		buffer->writeValue(contactPoints[i].f);
+		buffer->writeInt(getRBIndex(contactPoints[i].rb1));
+		buffer->writeInt(getRBIndex(contactPoints[i].rb2));
+	}
+}
+
+/**
+	This method is used to restore the state of the world from the binary buffer, reading from its current position.
+*/
+void World::restoreState(BinaryBuffer* buffer){
+	int rbCount = buffer->readInt();
+	if (rbCount != (int)objects.size())
+		throwError("The saved state has %d rigid bodies, but the world has %d.", rbCount, objects.size());
+	if (stateStore.getBodyCount() != rbCount)
+		stateStore.resize(rbCount);
+	buffer->read(stateStore.getPositionData(), stateStore.getDataSize());
+	buffer->read(stateStore.getOrientationData(), stateStore.getDataSize());
+	buffer->read(stateStore.getVelocityData(), stateStore.getDataSize());
+	buffer->read(stateStore.getAngularVelocityData(), stateStore.getDataSize());
+	//now scatter the states to the rigid bodies
+	for (uint i=0;i<objects.size();i++){
+		stateStore.getState(i, &objects[i]->state);
+		objects[i]->state.markModified();
+	}
+
+	//resizing doesn't give back the memory, so this only allocates if there are more contacts than ever before
+	contactPoints.resize(buffer->readInt());
+	for (uint i=0;i<contactPoints.size();i++){
+		buffer->readValue(&contactPoints[i].cp);
+		buffer->readValue(&contactPoints[i].n);
+		buffer->readValue(&contactPoints[i].d);
+		buffer->readValue(&contactPoints[i].f);
+		int rb1Index = buffer->readInt();
+		int rb2Index = buffer->readInt();
+		contactPoints[i].rb1 = (rb1Index >= 0)?(objects[rb1Index]):(NULL);
+		contactPoints[i].rb2 = (rb2Index >= 0)?(objects[rb2Index]):(NULL);
+	}
+	updateContactIndex();
+}
+
+/**
+	This method returns the index of the rigid body in the list of objects of the world, or -1 if it is not in the world.
+*/
+int World::getRBIndex(RigidBody* rb){
+	if (rb == NULL)
+		return -1;
+	//the id of a body is its index in the world it was added to, so this only needs to check that it is this world
+	if (rb->id >= 0 && rb->id < (int)objects.size() && objects[rb->id] == rb)
+		return rb->id;
+	for (uint i=0;i<objects.size();i++)
+		if (objects[i] == rb)
+			return i;
+	return -1;
+}
+
+/**
+	This method returns the states of all the rigid bodies of the world, packed into contiguous arrays and indexed like the objects of the world.
+*/
+RBStateStore* World::getStateStore(){
+	if (stateStore.getBodyCount() != (int)objects.size())
+		stateStore.resize(objects.size());
+	for (uint i=0;i<objects.size();i++)
+		stateStore.setState(i, objects[i]->state);
+	return &stateStore;
+}
+
@@ -1,21 +1,40 @@
 #pragma once
 
 #include <Utils/Utils.h>
+#include <Utils/BinaryBuffer.h>
+#include <Utils/NameIndex.h>
 
 #include <Physics/PhysicsDll.h>
 #include <Physics/RigidBody.h>
 #include <Physics/ArticulatedRigidBody.h>
 #include <Physics/ArticulatedFigure.h>
+#include <Physics/RBStateStore.h>
+#include <Physics/ContactIndex.h>
 
 /*--------------------------------------------------------------------------------------------------------------------------------------------*
  * This class implements a container for rigid bodies (both stand alone and articulated). It reads a .rbs file and interprets it.             *
+ * Any number of worlds can coexist (see ODEWorld), each owning its own bodies, joints and contacts. The singleton returned by instance() is   *
+ * only the default world, kept for the code that does not care about which world it lives in. Every engine (ODEWorld, FeatherstoneWorld)     *
+ * derives from this class, and the engine of the default world is picked with setDefaultEngine.                                              *
  *--------------------------------------------------------------------------------------------------------------------------------------------*/
 class PHYSICS_DECLSPEC World{
 friend class RBSimulator;
 friend class ConCompositionFramework;
+friend class RolloutBatch;
+
+public:
+	//these are the physics engines a world can be simulated with
+	enum PhysicsEngine {
+		//maximal coordinates, with the joints and the contacts solved together by ODE
+		ENGINE_ODE = 0,
+		//reduced coordinates, with the articulated body algorithm and penalty contacts (see FeatherstoneWorld)
+		ENGINE_FEATHERSTONE
+	};
 
 private:
 	static World* _instance;
+	//the engine the default world is created with
+	static int defaultEngine;
 	static void create();
 	static void destroy();
 
@@ -30,8 +49,25 @@ protected:
 	//we'll keep a list of all the joints in the world as well, for quick access
 	DynamicArray<Joint*> jts;
 
+	//these are used to look the objects and the articulated rigid bodies up by name, and are built again when they are out of date
+	NameIndex objectNames;
+	NameIndex arbNames;
+	//this is incremented whenever an object of the world is renamed, so that the indices are built again
+	int namesVersion;
+
+	/**
+		This method returns the first articulated rigid body with the given name that belongs to the articulated figure, or to the articulated
+		figure with the given name. If both are NULL, any articulated figure will do.
+	*/
+	ArticulatedRigidBody* findARBByName(const char* name, const ArticulatedFigure* articulatedFigure, const char* articulatedFigureName);
+
 	//this is a list of all the contact points
 	DynamicArray<ContactPoint> contactPoints;
+	//and this is the same contact points, sorted by rigid body
+	ContactIndex contactIndex;
+
+	//this holds a copy of the states of all the objects, packed into contiguous arrays, in the same order as the objects
+	RBStateStore stateStore;
 
 protected:
 	//the constructor
@@ -43,11 +79,29 @@ protected:
 	virtual void destroyWorld();
 
 public:
+	/**
+		Returns the default world. Articulated figures that are loaded without specifying a world end up here.
+	*/
 	inline static World& instance() {
 		if( _instance == NULL ) create();	
 		return *_instance;
 	}
 
+	/**
+		This method is used to select the physics engine (one of the PhysicsEngine values) that the default world is simulated with. It has to be
+		called before anything asks for the default world, since the world can't change engine once it exists.
+	*/
+	static void setDefaultEngine(int engine);
+
+	inline static int getDefaultEngine(){
+		return defaultEngine;
+	}
+
+	/**
+		This method returns a new, empty world that is simulated with the given physics engine (one of the PhysicsEngine values).
+	*/
+	static World* createWorld(int engine);
+
 	// Destroy all the objects, but the world is still usable
 	virtual void destroyAllObjects();
 
@@ -75,6 +129,21 @@ public:
 		return &contactPoints;
 	}
 
+	/**
+		This method returns the contact points of the last step, sorted by rigid body. The index is rebuilt once the contact forces are known,
+		at the end of every step, and when the state of the world is restored.
+	*/
+	inline ContactIndex* getContactIndex(){
+		return &contactIndex;
+	}
+
+	/**
+		This method is used to rebuild the contact index from the current list of contact points.
+	*/
+	inline void updateContactIndex(){
+		contactIndex.build(&contactPoints, &objects);
+	}
+
 	/**
 		This method is used to integrate the forward simulation in time.
 	*/
@@ -95,6 +164,19 @@ public:
 	*/
 	virtual void addArticulatedFigure( ArticulatedFigure* articulatedFigure_disown );
 
+	/**
+		This method is called by a rigid body of this world when its collision bitmasks, or those of one of its primitives, change. The
+		worlds that keep their own copy of the bitmasks update it here; the others read them when they need them, and have nothing to do.
+	*/
+	virtual void updateCollisionBits(RigidBody* rb){}
+
+	/**
+		This method is called by a rigid body of this world when it is renamed, so that the world looks it up by its new name.
+	*/
+	inline void namesChanged(){
+		namesVersion++;
+	}
+
 	/**
 		This method returns the reference to the first articulated rigid body with 
 		its name and its articulared figure name, or NULL if it is not found
@@ -122,6 +204,54 @@ public:
 	*/
 	void setState(DynamicArray<double>* state, int start = 0);
 
+	/**
+		This method is used to append the complete state of the world (the state of every rigid body, as well as the contact points
+		of the last step, which the controllers use to compute the torques for the next one) to the binary buffer.
+	*/
+	virtual void saveState(BinaryBuffer* buffer);
+
+	/**
+		This method is used to restore the state of the world from the binary buffer, reading from its current position. The state
+		must have been saved from a world that has the same rigid bodies, in the same order.
+	*/
+	virtual void restoreState(BinaryBuffer* buffer);
+
+	/**
+		This method returns the index of the rigid body in the list of objects of the world, or -1 if it is not in the world.
+	*/
+	int getRBIndex(RigidBody* rb);
+
+	/**
+		This method returns a copy of the states of all the rigid bodies of the world, packed into contiguous arrays and indexed like
+		the objects of the world. All the states are copied every time, so the caller should ask once and keep the store for as long as the
+		world is not stepped.
+	*/
+	RBStateStore* getStateStore();
+
+	/**
+		This method returns a hash of the states of all the rigid bodies of the world. It only matches the hash of another run if the
+		states are identical, bit for bit, so it can be used to check that a simulation is repeatable.
+	*/
+	inline uint getStateHash(){
+		return getStateStore()->computeHash();
+	}
+
+	/**
+		This method returns the number of rigid bodies in the world.
+	*/
+	inline int getRBCount(){
+		return objects.size();
+	}
+
+	/**
+		This method returns the ith rigid body of the world.
+	*/
+	inline RigidBody* getRB(int i){
+		if (i<0 || (uint)i>=objects.size())
+			return NULL;
+		return objects[i];
+	}
+
 	/**
 		This method returns the number of articulated figures in this collection.
 	*/
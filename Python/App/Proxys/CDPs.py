@@ -13,6 +13,8 @@ SphereCDP = Proxy.create( cls, verbose = False, caster = Physics.castToSphereCDP
     members = [
         Member.Point3d( 'center', (0.0,0.0,0.0), cls.getCenter, cls.setCenter ),
         Member.Basic( float, 'radius', 1.0, cls.getRadius, cls.setRadius),
+        Member.Basic( long, 'categoryBits', 0xFFFFFFFFL, cls.getCategoryBits, cls.setCategoryBits ),
+        Member.Basic( long, 'collideBits', 0xFFFFFFFFL, cls.getCollideBits, cls.setCollideBits ),
     ] )
 
 cls = Physics.BoxCDP
@@ -20,6 +22,8 @@ BoxCDP = Proxy.create( cls, verbose = False, caster = Physics.castToBoxCDP,
     members = [
         Member.Point3d( 'point1', (-1.0,-1.0,-1.0), cls.getPoint1, cls.setPoint1 ),
         Member.Point3d( 'point2', (1.0,1.0,1.0), cls.getPoint2, cls.setPoint2),
+        Member.Basic( long, 'categoryBits', 0xFFFFFFFFL, cls.getCategoryBits, cls.setCategoryBits ),
+        Member.Basic( long, 'collideBits', 0xFFFFFFFFL, cls.getCollideBits, cls.setCollideBits ),
     ] )
 
 cls = Physics.PlaneCDP
@@ -27,6 +31,8 @@ PlaneCDP = Proxy.create( cls, verbose = False, caster = Physics.castToPlaneCDP,
     members = [
         Member.Vector3d( 'normal', (0.0,1.0,0.0), cls.getNormal, cls.setNormal ),
         Member.Point3d( 'origin', (0.0,0.0,0.0), cls.getOrigin, cls.setOrigin),
+        Member.Basic( long, 'categoryBits', 0xFFFFFFFFL, cls.getCategoryBits, cls.setCategoryBits ),
+        Member.Basic( long, 'collideBits', 0xFFFFFFFFL, cls.getCollideBits, cls.setCollideBits ),
     ] )
 
 cls = Physics.CapsuleCDP
@@ -35,5 +41,7 @@ CapsuleCDP = Proxy.create( cls, verbose = False, caster = Physics.castToCapsuleC
         Member.Point3d( 'point1', (-1.0,0.0,0.0), cls.getPoint1, cls.setPoint1 ),
         Member.Point3d( 'point2', (1.0,0.0,0.0), cls.getPoint2, cls.setPoint2 ),
         Member.Basic( float, 'radius', 1.0, cls.getRadius, cls.setRadius),
+        Member.Basic( long, 'categoryBits', 0xFFFFFFFFL, cls.getCategoryBits, cls.setCategoryBits ),
+        Member.Basic( long, 'collideBits', 0xFFFFFFFFL, cls.getCollideBits, cls.setCollideBits ),
     ] )
 
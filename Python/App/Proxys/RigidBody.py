@@ -80,7 +80,9 @@ RigidBody = Proxy.create( cls, loader = Physics.world().addRigidBody,
         Member.Basic( float, 'frictionCoeff', 0.8, cls.getFrictionCoefficient, cls.setFrictionCoefficient ),
         Member.Basic( float, 'restitutionCoeff', 0.35, cls.getRestitutionCoefficient, cls.setRestitutionCoefficient ),        
         Member.Basic( tuple, 'groundCoeffs', (0.00001,0.2), getGroundCoeffs, setGroundCoeffs ),
-        Member.Basic( bool, 'planar', False, cls.isPlanar, cls.setPlanar )
+        Member.Basic( bool, 'planar', False, cls.isPlanar, cls.setPlanar ),
+        Member.Basic( long, 'categoryBits', 0xFFFFFFFFL, cls.getCategoryBits, cls.setCategoryBits ),
+        Member.Basic( long, 'collideBits', 0xFFFFFFFFL, cls.getCollideBits, cls.setCollideBits )
     ] )
 
 cls = Physics.ArticulatedRigidBody
@@ -27,14 +27,21 @@ class SNMApp(wx.App):
                  dt = 1/2000.0,
                  glCanvasSize=wx.DefaultSize,
                  size=wx.DefaultSize, redirect=False, filename=None,
-                 useBestVisual=False, clearSigInt=True, showConsole=True):
+                 useBestVisual=False, clearSigInt=True, showConsole=True,
+                 engine=None):
         """
         appTitle is the window title
         fps is the desired number of frames per seconds
         dt is the desired simulation timestep
+        engine is the physics engine the world is simulated with (Physics.World.ENGINE_ODE or 
+            Physics.World.ENGINE_FEATHERSTONE), None to keep the default one. It must be chosen 
+            before anything is added to the world.
         :see: wx.BasicApp.__init__`
         """
         
+        if engine is not None :
+            Physics.setDefaultEngine( engine )
+
         wx.App.__init__(self, redirect, filename, useBestVisual, clearSigInt)
 
         # No annoying error logging window
@@ -96,6 +103,10 @@ class SNMApp(wx.App):
         self._worldOracle.initializeWorld( Physics.world() )
         self._kinematicMotion = False
         
+        # The clock runs the fixed simulation steps in C++, and interpolates the bodies for drawing
+        self._clock = Core.SimulationClock( Physics.world() )
+        self._clock.setTimeStep( self._dt )
+        
         # Set-up starting list of characters and controllers
         self._characters = []
     
@@ -113,19 +124,18 @@ class SNMApp(wx.App):
         
     def draw(self):
         """Draw the content of the world"""
-        world = Physics.world()
-                    
         glEnable(GL_LIGHTING)
         if self._drawCollisionVolumes:
-            world.drawRBs(Physics.SHOW_MESH|Physics.SHOW_CD_PRIMITIVES)
+            self._clock.drawRBs(Physics.SHOW_MESH|Physics.SHOW_CD_PRIMITIVES)
         else:
-            world.drawRBs(Physics.SHOW_MESH|Physics.SHOW_COLOURS)            
+            self._clock.drawRBs(Physics.SHOW_MESH|Physics.SHOW_COLOURS)            
+        self._worldOracle.draw()
 #        world.drawRBs(Physics.SHOW_MESH|Physics.SHOW_CD_PRIMITIVES)
         glDisable(GL_LIGHTING);
     
         if self._drawShadows:
             self._glCanvas.beginShadows()
-            world.drawRBs(Physics.SHOW_MESH)
+            self._clock.drawRBs(Physics.SHOW_MESH)
             self._glCanvas.endShadows()    
 
     def postDraw(self):
@@ -144,10 +154,17 @@ class SNMApp(wx.App):
         
         # Enough time elapsed perform simulation loop and render
         simulationSeconds = 1.0/self._glCanvas.getFps() * self._simulationSecondsPerSecond
-        nbSteps = int( math.ceil( simulationSeconds / self._dt ) )
- 
-        for i in range(0,nbSteps):
-            self.simulationStep()
+        
+        if self._kinematicMotion:
+            nbSteps = int( math.ceil( simulationSeconds / self._dt ) )
+            for i in range(0,nbSteps):
+                self.simulationStep()
+            return
+        
+        # All the steps that fit in the frame are taken in C++
+        self._updateClockControllers()
+        self._clock.advance( simulationSeconds )
+        self._printTransitions()
 
     def advanceAnimationUntilControllerEnds(self, controller):
         """Advances the animation until the specified controller reaches the end.
@@ -194,22 +211,30 @@ class SNMApp(wx.App):
 
 
         
-        world = Physics.world()
-        controllers = self._controllerList._objects
-        contactForces = world.getContactForces()
-        for controller in controllers :
-            controller.performPreTasks(self._dt, contactForces)
-        world.advanceInTime(self._dt)
+        self._updateClockControllers()
+        self._clock.advance( self._dt )
+        self._printTransitions()
         
-        contactForces = world.getContactForces()
+    def _updateClockControllers(self):
+        """Private! Makes sure the clock runs the controllers of the application."""
+        controllers = self._controllerList._objects
+        self._clock.setTimeStep( self._dt )
+        self._clock.clearControllers()
         for controller in controllers :
-            if controller.performPostTasks(self._dt, contactForces) :
+            self._clock.addController(controller)
+    
+    def _printTransitions(self):
+        """Private! Prints a step report for every controller that went through a transition during the last frame."""
+        if not self._printStepReport:
+            return
+        controllers = self._controllerList._objects
+        for i, controller in enumerate(controllers) :
+            if self._clock.hasTransitioned(i) :
                 step = Vector3d (controller.getStanceFootPos(), controller.getSwingFootPos())
                 step = controller.getCharacterFrame().inverseRotate(step);
                 v = controller.getV()
                 phi = controller.getPhase()
-                if self._printStepReport:
-                    print "step: %3.5f %3.5f %3.5f. Vel: %3.5f %3.5f %3.5f  phi = %f" % ( step.x, step.y, step.z, v.x, v.y, v.z, phi)
+                print "step: %3.5f %3.5f %3.5f. Vel: %3.5f %3.5f %3.5f  phi = %f" % ( step.x, step.y, step.z, v.x, v.y, v.z, phi)
 
         
     
@@ -111,7 +111,10 @@ class Staircase(Scenario.Scenario):
         
         self._loaded = True
         
-        # Create the rigid bodies for the main staircase        
+        # The whole staircase is a single static triangle mesh, made of one box per step and per ramp piece
+        triMesh = Physics.TriMeshCDP()
+        
+        # Create the boxes for the main staircase        
         orientation = PyUtils.angleAxisToQuaternion( (self._angle,(0,1,0)) )
         size = MathLib.Vector3d( self._staircaseWidth, self._riserHeight, self._threadDepth )
         pos = PyUtils.toPoint3d( self._position ) + MathLib.Vector3d( 0, -self._riserHeight/2.0, 0 )
@@ -119,10 +122,9 @@ class Staircase(Scenario.Scenario):
         delta.x = 0
         delta = orientation.rotate( delta )
         for i in range(self._stepCount):
-            box = PyUtils.RigidBody.createBox( size, pos = pos + delta * (i+1), locked = True, orientation=orientation )
-            Physics.world().addRigidBody(box)
+            triMesh.addBox( pos + delta * (i+1), size, orientation )
         
-        # Create the rigid bodies for both ramps
+        # Create the boxes for both ramps
         rampHeights = ( self._leftRampHeight, self._rightRampHeight )
         
         deltaRamp = MathLib.Vector3d(self._staircaseWidth/2.0,0,0)
@@ -131,15 +133,16 @@ class Staircase(Scenario.Scenario):
         for deltaRamp, rampHeight in zip( deltaRamps, rampHeights ):
             if rampHeight is None: continue
             deltaRamp.y = rampHeight/2.0
-            box = PyUtils.RigidBody.createBox( (0.02,rampHeight,0.02), pos = pos + deltaRamp + delta , locked = True, orientation=orientation )
-            Physics.world().addRigidBody(box)
-            box = PyUtils.RigidBody.createBox( (0.02,rampHeight,0.02), pos = pos + deltaRamp + (delta * self._stepCount) , locked = True, orientation=orientation )
-            Physics.world().addRigidBody(box)
+            postSize = MathLib.Vector3d( 0.02, rampHeight, 0.02 )
+            triMesh.addBox( pos + deltaRamp + delta, postSize, orientation )
+            triMesh.addBox( pos + deltaRamp + (delta * self._stepCount), postSize, orientation )
             deltaRamp.y = rampHeight
             rampOrientation = orientation * PyUtils.angleAxisToQuaternion( (math.atan2(self._riserHeight, self._threadDepth), (-1,0,0)) )
             rampLen = self._stepCount * math.sqrt( self._riserHeight*self._riserHeight + self._threadDepth*self._threadDepth )
-            box = PyUtils.RigidBody.createBox( (0.04,0.02,rampLen), pos = pos + deltaRamp + (delta * ((self._stepCount+1) * 0.5)) , locked = True, orientation=rampOrientation )
-            Physics.world().addRigidBody(box)
+            triMesh.addBox( pos + deltaRamp + (delta * ((self._stepCount+1) * 0.5)), MathLib.Vector3d( 0.04, 0.02, rampLen ), rampOrientation )
+        
+        staircase = PyUtils.RigidBody.createTriMesh( triMesh, name = self.getName() )
+        Physics.world().addRigidBody(staircase)
             
         
         
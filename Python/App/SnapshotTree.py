@@ -15,19 +15,18 @@ class Snapshot(PyUtils.Observable):
 
         self._time = time.localtime()
         
-        # Save the world
+        # Save the world and the state of the controllers, in that order
         world = Physics.world()
-        self._worldState = Utils.DynamicArrayDouble() 
-        world.getState( self._worldState )
+        self._state = Utils.BinaryBuffer() 
+        world.saveState( self._state )
         
         # Save the controllers
         app = wx.GetApp()        
         self._controllers = []
         for i in range(app.getControllerCount()):
             controller = app.getController(i)
-            controllerState = Core.SimBiControllerState()
-            controller.getControllerState( controllerState )
-            self._controllers.append( (controllerState, PyUtils.wrapCopy( controller )) )
+            controller.saveState( self._state )
+            self._controllers.append( PyUtils.wrapCopy( controller ) )
 
         self._parentBranch = parentBranch
         self._childBranches = []
@@ -79,7 +78,8 @@ class Snapshot(PyUtils.Observable):
 
         # Restore the world
         world = Physics.world()
-        world.setState( self._worldState )
+        self._state.rewind()
+        world.restoreState( self._state )
         
         # Restore the controllers
         app = wx.GetApp()        
@@ -87,12 +87,12 @@ class Snapshot(PyUtils.Observable):
         
         for i in range(app.getControllerCount()):
             controller = app.getController(i)
-            controllerState, wrappedController = self._controllers[i]
+            wrappedController = self._controllers[i]
             if restoreControllerParams :
                 controller.beginBatchChanges()
                 try: wrappedController.fillObject(controller)
                 finally: controller.endBatchChanges()
-            controller.setControllerState( controllerState )            
+            controller.restoreState( self._state )            
         self.notifyObservers()
 
         
@@ -8,13 +8,15 @@ Basic controller editor
 import sys
 sys.path += ['.']
 
-import wx, App, math
+import wx, App, math, Physics
 
 movieResolution = (1280,720)
 movieSetup = False # True if we want a movie
 glMovie = False    # True if we're only interested in recording the GL canvas
                    # False if we want a "screen cast"
 
+physicsEngine = Physics.World.ENGINE_ODE # Physics.World.ENGINE_FEATHERSTONE simulates the characters in reduced coordinates
+
 glCanvasSize = wx.DefaultSize
 size = wx.DefaultSize
 showConsole = True
@@ -26,7 +28,7 @@ if movieSetup:
         showConsole = False
 
 
-app = App.SNMApp("Style Editor", size = size, glCanvasSize=glCanvasSize, showConsole = showConsole)
+app = App.SNMApp("Style Editor", size = size, glCanvasSize=glCanvasSize, showConsole = showConsole, engine = physicsEngine)
 
 import UI, Utils, GLUtils, Physics, Core, MathLib, PyUtils
 from App import InstantChar, KeyframeEditor
@@ -0,0 +1,88 @@
+'''
+Created on 2026-10-17
+
+Compares the physics engines on the stock walking scenes of Bip and BipV3.
+Every scene is simulated for a few seconds with each engine, and the speed is reported in
+simulation steps per second. Since the engine of the world can't be changed once the world
+exists, every (engine, character) pair is simulated by a separate python process.
+
+Run from the Python directory: python EngineBenchmark.py [seconds]
+To simulate a single scene: python EngineBenchmark.py seconds engine character
+'''
+import sys, time, subprocess
+sys.path += ['.']
+
+import Physics
+
+# (name, engine)
+engines = [ ( "ODE",          Physics.World.ENGINE_ODE ),
+            ( "Featherstone", Physics.World.ENGINE_FEATHERSTONE ) ]
+
+# (name, character, reduced state, controller)
+scenes = [ ( "Bip",   "Characters.Bip",   "Data/Characters/Bip/Controllers/WalkingState.rs",   "Characters.Bip.Controllers.Walking" ),
+           ( "BipV3", "Characters.BipV3", "Data/Characters/BipV3/Controllers/WalkingState.rs", "Characters.BipV3.Controllers.EditableWalking" ) ]
+
+duration = 5.0
+if len(sys.argv) > 1 :
+    duration = float( sys.argv[1] )
+
+if len(sys.argv) <= 3 :
+    print "Simulating %g seconds of walking for every engine and character..." % duration
+    print "%-14s %-8s %12s %8s" % ( "engine", "scene", "steps/s", "fell" )
+    for engineName, engine in engines :
+        for scene in scenes :
+            output = subprocess.Popen( [ sys.executable, sys.argv[0], str(duration), str(engine), scene[0] ],
+                                       stdout = subprocess.PIPE ).communicate()[0]
+            result = output.strip().split("\n")[-1].split()
+            if len(result) != 2 :
+                result = [ "failed", "" ]
+            print "%-14s %-8s %12s %8s" % ( engineName, scene[0], result[0], result[1] )
+    sys.exit(0)
+
+import wx
+
+class BenchmarkApp(wx.App):
+    """The proxys load characters and controllers through the application, this one only keeps track of them."""
+
+    def OnInit(self):
+        self._controllers = []
+        return True
+
+    def addCharacter(self, character):
+        import Physics
+        Physics.world().addArticulatedFigure( character )
+
+    def addController(self, controller):
+        self._controllers.append( controller )
+
+    def getControllers(self):
+        return self._controllers
+
+# The engine has to be chosen before anything touches the world
+Physics.setDefaultEngine( int( sys.argv[2] ) )
+
+app = BenchmarkApp(False)
+
+import Core, PyUtils
+
+dt = 1/2000.0
+stepCount = int( duration / dt + 0.5 )
+sceneName, characterName, stateFile, controllerName = [ s for s in scenes if s[0] == sys.argv[3] ][0]
+
+PyUtils.load( "RigidBodies.FlatGround" )
+character = PyUtils.load( characterName )
+character.loadReducedStateFromFile( stateFile )
+controller = PyUtils.load( controllerName, character )
+controller.setStance( Core.LEFT_STANCE )
+
+world = Physics.world()
+start = time.clock()
+for i in range( stepCount ):
+    contactForces = world.getContactForces()
+    controller.performPreTasks( dt, contactForces )
+    world.advanceInTime( dt )
+    controller.performPostTasks( dt, world.getContactForces() )
+elapsed = time.clock() - start
+
+# The last line is what the parent process reads
+print "%.0f %s" % ( stepCount / elapsed, controller.isBodyInContactWithTheGround() )
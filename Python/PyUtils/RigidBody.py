@@ -165,6 +165,29 @@ def createArticulatedCone( axis=1, basePos=-1, tipPos=1, radius=1, colour=(0.6,0
     
     return _createCone( proxy, axis, basePos, tipPos, radius, colour, moiScale, withMesh )
 
+def createTriMesh( cdp, colour=(0.6,0.6,0.6), withMesh = True, **kwargs ):
+    """
+    Create a static rigid body whose collision primitive is the specified Physics.TriMeshCDP. The triangles must all be added to the 
+    primitive before the body is added to the world. Other rigid body parameters can be specified with keyword arguments, look at
+    App.Proxys.RigidBody for more details on available arguments. The following arguments will not be used:
+        meshes, cdps, locked.
+    """
+
+    from App import Proxys
+    proxy = Proxys.RigidBody( **kwargs )
+    proxy.meshes = None
+    proxy.cdps = None
+    proxy.locked = True
+    
+    body = proxy.createAndFillObject()
+    body.addCollisionDetectionPrimitive( cdp )
+    
+    if withMesh:
+        mesh = cdp.createMesh()
+        mesh.setColour( colour[0], colour[1], colour[2], 1 )
+        body.addMesh(mesh)
+    
+    return body
 
 
 def _fixMass( kwargs, volume ):
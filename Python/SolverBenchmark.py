@@ -0,0 +1,99 @@
+'''
+Created on 2026-10-17
+
+Compares the constraint solvers of ODEWorld on the stock Bip walking scene.
+For every solver setting, the same initial state is simulated for a few seconds. The speed
+is reported in simulation steps per second, and the accuracy as the distance between the
+pelvis and where it is when the scene is simulated with the direct solver.
+
+Run from the Python directory: python SolverBenchmark.py [seconds]
+'''
+import sys, time, math
+sys.path += ['.']
+
+import wx
+
+class BenchmarkApp(wx.App):
+    """The proxys load characters and controllers through the application, this one only keeps track of them."""
+
+    def OnInit(self):
+        self._controllers = []
+        return True
+
+    def addCharacter(self, character):
+        import Physics
+        Physics.world().addArticulatedFigure( character )
+
+    def addController(self, controller):
+        self._controllers.append( controller )
+
+    def getControllers(self):
+        return self._controllers
+
+app = BenchmarkApp(False)
+
+import Physics, Core, Utils, PyUtils
+
+dt = 1/2000.0
+duration = 5.0
+if len(sys.argv) > 1 :
+    duration = float( sys.argv[1] )
+stepCount = int( duration / dt + 0.5 )
+samplePeriod = 100
+
+# (name, solver mode, QuickStep iterations, QuickStep over-relaxation)
+settings = [ ( "direct",            Physics.ODEWorld.SOLVER_DIRECT,    20, 1.3 ),
+             ( "quickstep 10",      Physics.ODEWorld.SOLVER_QUICKSTEP, 10, 1.3 ),
+             ( "quickstep 20",      Physics.ODEWorld.SOLVER_QUICKSTEP, 20, 1.3 ),
+             ( "quickstep 40",      Physics.ODEWorld.SOLVER_QUICKSTEP, 40, 1.3 ),
+             ( "quickstep 40 w=1",  Physics.ODEWorld.SOLVER_QUICKSTEP, 40, 1.0 ),
+             ( "auto",              Physics.ODEWorld.SOLVER_AUTO,      20, 1.3 ) ]
+
+PyUtils.load( "RigidBodies.FlatGround" )
+character = PyUtils.load( "Characters.Bip" )
+character.loadReducedStateFromFile( "Data/Characters/Bip/Controllers/WalkingState.rs" )
+controller = PyUtils.load( "Characters.Bip.Controllers.Walking", character )
+controller.setStance( Core.LEFT_STANCE )
+
+world = Physics.castToODEWorld( Physics.world() )
+pelvis = character.getRoot()
+
+# Every run starts from exactly the same state
+initialState = Utils.BinaryBuffer()
+world.saveState( initialState )
+controller.saveState( initialState )
+
+def simulate():
+    """Simulates the scene, returns the time it took and the pelvis positions sampled along the way."""
+    initialState.rewind()
+    world.restoreState( initialState )
+    controller.restoreState( initialState )
+
+    positions = []
+    start = time.clock()
+    for i in range( stepCount ):
+        contactForces = world.getContactForces()
+        controller.performPreTasks( dt, contactForces )
+        world.advanceInTime( dt )
+        controller.performPostTasks( dt, world.getContactForces() )
+        if i % samplePeriod == 0 :
+            positions.append( pelvis.getCMPosition() )
+    return time.clock() - start, positions
+
+def distance( p1, p2 ):
+    return math.sqrt( (p1.x-p2.x)**2 + (p1.y-p2.y)**2 + (p1.z-p2.z)**2 )
+
+print "Simulating %d steps of Bip walking for every solver setting..." % stepCount
+print "%-18s %12s %14s %14s %8s" % ( "solver", "steps/s", "mean error", "max error", "fell" )
+
+reference = None
+for name, mode, iterations, sor in settings :
+    world.setSolverMode( mode )
+    world.setQuickStepIterations( iterations )
+    world.setQuickStepSOR( sor )
+    elapsed, positions = simulate()
+    if reference is None :
+        reference = positions
+    errors = [ distance(p, q) for p, q in zip(positions, reference) ]
+    print "%-18s %12.0f %14.6f %14.6f %8s" % ( name, stepCount / elapsed, sum(errors) / len(errors), max(errors),
+                                               controller.isBodyInContactWithTheGround() )
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Utils/UtilsDll.h>
+#include <Utils/Utils.h>
+
+/*--------------------------------------------------------------------------------------------------------------------------------------*
+ * This class implements a growable block of memory that raw values can be written to and then read back, in the same order. Clearing *
+ * the buffer does not release its memory, so a buffer that is reused for data of a similar size stops allocating after the first use.*
+ *--------------------------------------------------------------------------------------------------------------------------------------*/
+class UTILS_DECLSPEC BinaryBuffer {
+private:
+	//the memory of the buffer - its size is the capacity of the buffer
+	DynamicArray<char> data;
+	//the number of bytes that were written to the buffer
+	uint writePos;
+	//the position of the next byte that will be read
+	uint readPos;
+
+public:
+	BinaryBuffer(uint capacity = 0){
+		data.resize(capacity);
+		writePos = readPos = 0;
+	}
+
+	/**
+		This method is used to make sure that the buffer can hold at least capacity bytes without having to grow.
+	*/
+	inline void reserve(uint capacity){
+		if (capacity > data.size())
+			data.resize(capacity);
+	}
+
+	/**
+		This method discards the content of the buffer, but keeps its memory.
+	*/
+	inline void clear(){
+		writePos = readPos = 0;
+	}
+
+	/**
+		This method is used to start reading from the beginning of the buffer again.
+	*/
+	inline void rewind(){
+		readPos = 0;
+	}
+
+	/**
+		Returns the number of bytes that were written to the buffer.
+	*/
+	inline uint getSize(){
+		return writePos;
+	}
+
+	/**
+		Returns the number of bytes the buffer can hold before it has to grow.
+	*/
+	inline uint getCapacity(){
+		return data.size();
+	}
+
+	/**
+		This method appends size bytes to the buffer.
+	*/
+	inline void write(const void* src, uint size){
+		if (size == 0)
+			return;
+		if (writePos + size > data.size())
+			data.resize((writePos + size > 2 * data.size())?(writePos + size):(2 * data.size()));
+		memcpy(&data[0] + writePos, src, size);
+		writePos += size;
+	}
+
+	/**
+		This method reads the next size bytes from the buffer.
+	*/
+	inline void read(void* dest, uint size){
+		if (size == 0)
+			return;
+		if (readPos + size > writePos)
+			throwError("Attempting to read past the end of a binary buffer.");
+		memcpy(dest, &data[0] + readPos, size);
+		readPos += size;
+	}
+
+	/**
+		These methods are used to write and read values of plain types (no pointers and no virtual methods), such as ints, doubles or Vector3ds.
+	*/
+	template <class T> inline void writeValue(const T& val){
+		write(&val, sizeof(T));
+	}
+
+	template <class T> inline void readValue(T* val){
+		read(val, sizeof(T));
+	}
+
+	inline void writeInt(int val){
+		write(&val, sizeof(int));
+	}
+
+	inline int readInt(){
+		int val;
+		read(&val, sizeof(int));
+		return val;
+	}
+};
@@ -0,0 +1,94 @@
+#include "NameIndex.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+NameIndex::NameIndex(void){
+	builtAtNamesVersion = 0;
+}
+
+NameIndex::~NameIndex(void){
+	clear();
+}
+
+/**
+	This is the FNV-1a hash of the name.
+*/
+unsigned int NameIndex::hash(const char* name){
+	unsigned int h = 2166136261u;
+	for (const unsigned char* c = (const unsigned char*)name; *c != 0; c++){
+		h ^= *c;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/**
+	This method returns the bucket that holds the name, or the free bucket where it should go if it is not in the table.
+*/
+int NameIndex::findBucket(const char* name) const {
+	//the size of the table is a power of 2, and it is never more than half full
+	int mask = buckets.size() - 1;
+	int b = hash(name) & mask;
+	while (buckets[b] >= 0 && strcmp(names[buckets[b]], name) != 0)
+		b = (b + 1) & mask;
+	return b;
+}
+
+/**
+	This method makes the table twice as large, and puts the names back in it.
+*/
+void NameIndex::grow(){
+	int size = (buckets.size() == 0)?(16):(2 * buckets.size());
+	buckets.assign(size, -1);
+	for (uint i=0;i<names.size();i++){
+		int b = findBucket(names[i]);
+		//only the first of the names that are the same goes in the table
+		if (buckets[b] < 0)
+			buckets[b] = i;
+	}
+}
+
+/**
+	This method removes all the names.
+*/
+void NameIndex::clear(){
+	for (uint i=0;i<names.size();i++)
+		free(names[i]);
+	names.clear();
+	nextSameName.clear();
+	buckets.clear();
+}
+
+/**
+	This method adds a name to the index, and returns its index.
+*/
+int NameIndex::add(const char* name){
+	if (2 * (names.size() + 1) > buckets.size())
+		grow();
+
+	int index = names.size();
+	names.push_back(_strdup(name));
+	nextSameName.push_back(-1);
+
+	int b = findBucket(name);
+	if (buckets[b] < 0){
+		buckets[b] = index;
+	}else{
+		//the name is already there, so this one goes at the end of the list of the names that are the same
+		int last = buckets[b];
+		while (nextSameName[last] >= 0)
+			last = nextSameName[last];
+		nextSameName[last] = index;
+	}
+	return index;
+}
+
+/**
+	This method returns the index of the first name that matches the one passed in as a parameter, or -1 if there is none.
+*/
+int NameIndex::find(const char* name) const {
+	if (name == NULL || buckets.size() == 0)
+		return -1;
+	return buckets[findBucket(name)];
+}
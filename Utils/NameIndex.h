@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Utils/UtilsDll.h>
+#include <Utils/Utils.h>
+
+#pragma warning (push)
+#pragma warning (disable : 4275 4251)
+UTILS_TEMPLATE( std::vector<char*> )
+#pragma warning (pop)
+
+/**
+	This class is used to find the index of an object from its name in constant time, rather than by comparing the name with the names of all
+	the objects. The names are added in the order of the objects they belong to, so the index of a name is the number of names that were
+	added before it. Several objects can have the same name: find returns the first one, and findNext walks through the others, in order.
+
+	The index keeps its own copy of the names, so it has to be built again when objects are added, removed or renamed. The classes that use
+	it build it lazily, in findIn: the index is built again when the list does not have as many objects as the index has names, or when
+	the version of the names that the owner of the list passes in is not the one it was built with. The owners (the world and the
+	articulated figures) increment their version whenever one of their objects is renamed, so renaming an object in one world does not
+	cause the indices of the other worlds to be built again. A name that is not found does not cause the index to be built again.
+
+	The index is not synchronized: objects must not be renamed while the world they belong to is being stepped on another thread.
+*/
+class UTILS_DECLSPEC NameIndex{
+private:
+	//the names, in the order they were added
+	DynamicArray<char*> names;
+	//for every name, the index of the next one that is the same, or -1
+	DynamicArray<int> nextSameName;
+	//the hash table: every used bucket holds the index of the first name with a given value, and the free ones hold -1
+	DynamicArray<int> buckets;
+	//the version of the names when the index was last built
+	int builtAtNamesVersion;
+
+	static unsigned int hash(const char* name);
+
+	/**
+		This method returns the bucket that holds the name, or the free bucket where it should go if it is not in the table.
+	*/
+	int findBucket(const char* name) const;
+
+	/**
+		This method makes the table twice as large, and puts the names back in it.
+	*/
+	void grow();
+
+	//the names are owned by the index, so it cannot be copied
+	NameIndex(const NameIndex& other);
+	NameIndex& operator = (const NameIndex& other);
+
+public:
+	NameIndex(void);
+	~NameIndex(void);
+
+	/**
+		This method removes all the names.
+	*/
+	void clear();
+
+	/**
+		This method adds a name to the index, and returns its index.
+	*/
+	int add(const char* name);
+
+	/**
+		This method returns the index of the first name that matches the one passed in as a parameter, or -1 if there is none.
+	*/
+	int find(const char* name) const;
+
+	/**
+		This method returns the index of the next name that is the same as the one at the given index, or -1 if there is none.
+	*/
+	inline int findNext(int index) const {
+		return nextSameName[index];
+	}
+
+	/**
+		Returns the name with the given index.
+	*/
+	inline const char* getName(int index) const {
+		return names[index];
+	}
+
+	/**
+		Returns the number of names in the index.
+	*/
+	inline int getCount() const {
+		return names.size();
+	}
+
+	/**
+		This method is used to build the index from the names of the objects in the list, whose names have the given version.
+	*/
+	template <class T> void build(const DynamicArray<T*>& list, int namesVersion){
+		clear();
+		for (uint i=0;i<list.size();i++)
+			add(list[i]->getName());
+		builtAtNamesVersion = namesVersion;
+	}
+
+	/**
+		This method returns true if the index was built from the list, and neither the list nor the names changed since then. Objects
+		are only ever added to the lists that are indexed, or the lists are cleared along with their index, so comparing the sizes is enough
+		to tell whether objects were added.
+	*/
+	template <class T> bool isUpToDate(const DynamicArray<T*>& list, int namesVersion) const {
+		return (int)list.size() == getCount() && builtAtNamesVersion == namesVersion;
+	}
+
+	/**
+		This method returns the index of the first object of the list that has the given name, or -1 if there is none. The index is
+		built again from the list first if it is out of date, so the objects can be added or renamed at any time.
+	*/
+	template <class T> int findIn(const DynamicArray<T*>& list, int namesVersion, const char* name){
+		if (!isUpToDate(list, namesVersion))
+			build(list, namesVersion);
+		return find(name);
+	}
+};
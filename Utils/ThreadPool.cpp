@@ -0,0 +1,189 @@
+#include "ThreadPool.h"
+
+#include <windows.h>
+#include <process.h>
+
+/**
+	The queue of items that belongs to one of the threads of the pool. The owner takes items from the back, thieves take them from the front.
+*/
+struct ThreadPoolQueue {
+	CRITICAL_SECTION lock;
+	DynamicArray<int> items;
+	//this is the index of the first item that was not stolen yet
+	uint first;
+};
+
+/**
+	This is what the helper threads are started with.
+*/
+struct ThreadPoolWorker {
+	ThreadPool* pool;
+	int workerIndex;
+
+	static unsigned int __stdcall threadMain(void* param){
+		ThreadPoolWorker* worker = (ThreadPoolWorker*)param;
+		ThreadPool* pool = worker->pool;
+		int workerIndex = worker->workerIndex;
+		delete worker;
+		pool->workerMain(workerIndex);
+		return 0;
+	}
+};
+
+/**
+	Constructor. If threadCount is 0 or less, one thread per processor is used. The calling thread counts as one of the threads.
+*/
+ThreadPool::ThreadPool(int threadCount){
+	if (threadCount <= 0)
+		threadCount = getProcessorCount();
+	this->threadCount = threadCount;
+	currentJob = NULL;
+	quitting = false;
+	busyHelpers = 0;
+
+	for (int i=0;i<threadCount;i++){
+		ThreadPoolQueue* queue = new ThreadPoolQueue();
+		InitializeCriticalSection(&queue->lock);
+		queue->first = 0;
+		queues.push_back(queue);
+	}
+
+	doneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	//worker 0 is the thread that calls run, so we only need threadCount-1 helpers
+	for (int i=1;i<threadCount;i++){
+		wakeEvents.push_back(CreateEvent(NULL, FALSE, FALSE, NULL));
+		ThreadPoolWorker* worker = new ThreadPoolWorker();
+		worker->pool = this;
+		worker->workerIndex = i;
+		HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, ThreadPoolWorker::threadMain, worker, 0, NULL);
+		if (thread == 0)
+			throwError("Could not create thread %d of the thread pool.", i);
+		threads.push_back(thread);
+	}
+}
+
+/**
+	Destructor - the helper threads are stopped and joined.
+*/
+ThreadPool::~ThreadPool(void){
+	quitting = true;
+	for (uint i=0;i<threads.size();i++)
+		SetEvent(wakeEvents[i]);
+	for (uint i=0;i<threads.size();i++){
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+		CloseHandle(wakeEvents[i]);
+	}
+	CloseHandle(doneEvent);
+
+	for (uint i=0;i<queues.size();i++){
+		DeleteCriticalSection(&queues[i]->lock);
+		delete queues[i];
+	}
+}
+
+/**
+	Returns the number of processors of the machine.
+*/
+int ThreadPool::getProcessorCount(){
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0)?(int)info.dwNumberOfProcessors:1;
+}
+
+/**
+	This method is used to take an item from the back of the queue of the given worker. Returns false if the queue is empty.
+*/
+bool ThreadPool::popItem(int workerIndex, int* itemIndex){
+	ThreadPoolQueue* queue = queues[workerIndex];
+	bool found = false;
+	EnterCriticalSection(&queue->lock);
+	if (queue->items.size() > queue->first){
+		*itemIndex = queue->items.back();
+		queue->items.pop_back();
+		found = true;
+	}
+	LeaveCriticalSection(&queue->lock);
+	return found;
+}
+
+/**
+	This method is used to take an item from the front of the queue of any worker other than the given one. Returns false if all the queues are empty.
+*/
+bool ThreadPool::stealItem(int workerIndex, int* itemIndex){
+	//start with the next worker, so that the thieves don't all go after the same queue
+	for (int i=1;i<threadCount;i++){
+		ThreadPoolQueue* queue = queues[(workerIndex + i) % threadCount];
+		bool found = false;
+		EnterCriticalSection(&queue->lock);
+		if (queue->items.size() > queue->first){
+			*itemIndex = queue->items[queue->first];
+			queue->first++;
+			found = true;
+		}
+		LeaveCriticalSection(&queue->lock);
+		if (found)
+			return true;
+	}
+	return false;
+}
+
+/**
+	This method processes items until there is no more work to be found in any of the queues. No new items are added while
+	a job is running, so once all the queues are empty the only work left is the one that the other threads are busy with.
+*/
+void ThreadPool::processItems(int workerIndex){
+	int itemIndex;
+	while (popItem(workerIndex, &itemIndex) || stealItem(workerIndex, &itemIndex))
+		currentJob->execute(itemIndex, workerIndex);
+}
+
+/**
+	This is the main loop of the helper threads.
+*/
+void ThreadPool::workerMain(int workerIndex){
+	while (true){
+		WaitForSingleObject(wakeEvents[workerIndex-1], INFINITE);
+		if (quitting)
+			return;
+		processItems(workerIndex);
+		if (InterlockedDecrement(&busyHelpers) == 0)
+			SetEvent(doneEvent);
+	}
+}
+
+/**
+	This method is used to process items 0 to itemCount-1 of the job in parallel. It returns once all the items have been processed.
+*/
+void ThreadPool::run(int itemCount, ParallelJob* job){
+	if (itemCount <= 0 || job == NULL)
+		return;
+
+	//not worth waking anybody up for this...
+	if (threadCount == 1 || itemCount == 1){
+		for (int i=0;i<itemCount;i++)
+			job->execute(i, 0);
+		return;
+	}
+
+	//the helpers are all asleep at this point, so the queues can be filled without locking. Consecutive items go to different
+	//threads, and since the owners work from the back, the items with low indices are the ones that get stolen first
+	for (int i=0;i<threadCount;i++){
+		queues[i]->items.clear();
+		queues[i]->first = 0;
+	}
+	for (int i=0;i<itemCount;i++)
+		queues[i % threadCount]->items.push_back(i);
+
+	currentJob = job;
+	busyHelpers = threadCount - 1;
+	ResetEvent(doneEvent);
+	for (uint i=0;i<wakeEvents.size();i++)
+		SetEvent(wakeEvents[i]);
+
+	processItems(0);
+	WaitForSingleObject(doneEvent, INFINITE);
+
+	currentJob = NULL;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Utils/UtilsDll.h>
+#include <Utils/Utils.h>
+
+/**
+	This is the interface for a job that can be processed in parallel by a ThreadPool. The job is made up of a number of
+	independent items (indexed from 0), and execute is called exactly once for each one of them, from any of the threads of the pool.
+*/
+class UTILS_DECLSPEC ParallelJob {
+public:
+	virtual ~ParallelJob(void){}
+
+	/**
+		This method is called to process the item with index itemIndex. The workerIndex identifies the thread that does the work
+		(0 is always the thread that called ThreadPool::run), so it can be used to index per-thread scratch data. This method
+		must not throw - the pool has no way of reporting the exception back to the caller.
+	*/
+	virtual void execute(int itemIndex, int workerIndex) = 0;
+};
+
+struct ThreadPoolQueue;
+struct ThreadPoolWorker;
+
+/*-------------------------------------------------------------------------------------------------------------------------------------------*
+ * This class implements a simple work-stealing thread pool. The worker threads are created once and sleep between jobs. When a job is run, *
+ * its items are dealt to per-thread queues; every thread works from the back of its own queue and, once that is empty, steals items from   *
+ * the front of the other queues. This keeps all the cores busy even when the items take very different amounts of time to process.       *
+ *-------------------------------------------------------------------------------------------------------------------------------------------*/
+class UTILS_DECLSPEC ThreadPool {
+friend struct ThreadPoolWorker;
+private:
+	//this is the number of threads that do work, including the thread that calls run
+	int threadCount;
+	//one work queue per thread
+	DynamicArray<ThreadPoolQueue*> queues;
+	//the handles of the helper threads, and the events that are used to wake them up (both are Win32 HANDLEs)
+	DynamicArray<void*> threads;
+	DynamicArray<void*> wakeEvents;
+	//this event is signaled when the last helper thread runs out of work
+	void* doneEvent;
+	//the number of helper threads that are still working on the current job
+	volatile long busyHelpers;
+	//this is the job that is currently being processed
+	ParallelJob* currentJob;
+	//set to true when the helper threads should exit
+	volatile bool quitting;
+
+	/**
+		This method is used to take an item from the back of the queue of the given worker. Returns false if the queue is empty.
+	*/
+	bool popItem(int workerIndex, int* itemIndex);
+
+	/**
+		This method is used to take an item from the front of the queue of any worker other than the given one. Returns false if all the queues are empty.
+	*/
+	bool stealItem(int workerIndex, int* itemIndex);
+
+	/**
+		This method processes items until there is no more work to be found in any of the queues.
+	*/
+	void processItems(int workerIndex);
+
+	/**
+		This is the main loop of the helper threads.
+	*/
+	void workerMain(int workerIndex);
+
+public:
+	/**
+		Constructor. If threadCount is 0 or less, one thread per processor is used. The calling thread counts as one of the threads.
+	*/
+	ThreadPool(int threadCount = 0);
+
+	/**
+		Destructor - the helper threads are stopped and joined.
+	*/
+	~ThreadPool(void);
+
+	/**
+		Returns the number of threads that work on a job, including the calling thread.
+	*/
+	inline int getThreadCount(){
+		return threadCount;
+	}
+
+	/**
+		This method is used to process items 0 to itemCount-1 of the job in parallel. It returns once all the items have been processed.
+		Jobs must not be run concurrently on the same pool.
+	*/
+	void run(int itemCount, ParallelJob* job);
+
+	/**
+		Returns the number of processors of the machine.
+	*/
+	static int getProcessorCount();
+};
@@ -1,15 +1,21 @@
 #include "utils.h"
+#include <windows.h>
 
 
+#ifndef HEADLESS
 /**
  * Register an external printFunction
  */
 PyObject *printFunction = NULL;
+//the thread that registered the print function - it is the only one that is allowed to call into Python
+DWORD printFunctionThreadId = 0;
 void registerPrintFunction(PyObject *pF){
     Py_XINCREF(pF);             /* Add a reference to new callback */
     Py_XDECREF(printFunction);  /* Dispose of previous callback */
     printFunction = pF;         /* Remember new callback */
+    printFunctionThreadId = GetCurrentThreadId();
 }
+#endif
 
 /**
  * Output the message to a file...
@@ -27,11 +33,14 @@ int tprintf(const char *format, ...){
  * Output the message to a file...
  */
 int tvprintf(const char *format, va_list vl){
-    static char message[1024];
+    char message[1024];
 
 	vsprintf(message, format, vl);
 
-	if( printFunction == NULL )
+#ifdef HEADLESS
+	printf( "%s", message );
+#else
+	if( printFunction == NULL || GetCurrentThreadId() != printFunctionThreadId )
 		printf( "%s", message );
 	else {
 		PyObject *arglist;
@@ -46,6 +55,7 @@ int tvprintf(const char *format, va_list vl){
 		}
 		Py_DECREF(result);
 	}
+#endif
 
 	return 0;
 }
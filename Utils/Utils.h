@@ -1,5 +1,7 @@
 #pragma once
+#ifndef HEADLESS
 #include <Python.h>
+#endif
 
 #include <stdarg.h>
 #include <string.h>
@@ -26,8 +28,12 @@ UTILS_DECLSPEC
 int tvprintf(const char *format, va_list ap);
 
 // This makes it possible to redirect printing (tprintf) to a Python function
+// Only the thread that registers the function prints through it, the other threads (see ThreadPool) print to stdout
+// The headless build has no Python, and always prints to stdout
+#ifndef HEADLESS
 UTILS_DECLSPEC
 void registerPrintFunction(PyObject * printFunction);
+#endif
 
 /**
 	This method throws an error with a specified text and arguments 
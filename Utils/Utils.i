@@ -9,6 +9,7 @@
 #include "Utils.h"
 #include "Observer.h"
 #include "Observable.h"
+#include "BinaryBuffer.h"
 %}
 
 #define UTILS_DECLSPEC
@@ -19,6 +20,7 @@
 %include "Utils.h"
 %include "Observer.h"
 %include "Observable.h"
+%include "BinaryBuffer.h"
 
 namespace std {
 	%template(DynamicArrayDouble) DynamicArray<double>;
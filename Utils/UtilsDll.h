@@ -1,7 +1,11 @@
 #pragma once
 
 #ifndef UTILS_DECLSPEC
-	#ifdef UTILS_EXPORTS
+	#if defined(HEADLESS)
+		//the headless build links everything statically
+		#define UTILS_DECLSPEC
+		#define UTILS_TEMPLATE(x)
+	#elif defined(UTILS_EXPORTS)
 		#define UTILS_DECLSPEC    __declspec(dllexport) 
 		#define UTILS_TEMPLATE(x) template class __declspec(dllexport) x;
 	#else
@@ -295,6 +295,7 @@ ODE_API dSpaceID dGeomGetSpace (dGeomID);
  *  @li dSimpleSpaceClass
  *  @li dHashSpaceClass
  *  @li dQuadTreeSpaceClass
+ *  @li dSweepAndPruneSpaceClass
  *  @li dFirstUserClass
  *  @li dLastUserClass
  *
@@ -767,7 +768,8 @@ enum {
   dSimpleSpaceClass = dFirstSpaceClass,
   dHashSpaceClass,
   dQuadTreeSpaceClass,
-  dLastSpaceClass = dQuadTreeSpaceClass,
+  dSweepAndPruneSpaceClass,
+  dLastSpaceClass = dSweepAndPruneSpaceClass,
 
   dFirstUserClass,
   dLastUserClass = dFirstUserClass + dMaxUserClasses - 1,
@@ -50,6 +50,13 @@ ODE_API void dRandSetSeed (unsigned long s);
  */
 ODE_API int dRandInt (int n);
 
+/* same as dRand() and dRandInt(), but with a generator state that is owned by
+ * the caller rather than the global one. this is what lets several worlds be
+ * stepped at the same time, from different threads, with repeatable results.
+ */
+ODE_API unsigned long dRandWithSeed (unsigned long *seed);
+ODE_API int dRandIntWithSeed (unsigned long *seed, int n);
+
 /* return a random real number between 0..1 */
 ODE_API dReal dRandReal(void);
 
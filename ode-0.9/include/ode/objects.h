@@ -225,6 +225,46 @@ ODE_API void dWorldSetQuickStepW (dWorldID, dReal over_relaxation);
  */
 ODE_API dReal dWorldGetQuickStepW (dWorldID);
 
+/**
+ * @brief Set the state of the random number generator that the QuickStep
+ *        method uses to reorder the constraints.
+ * @ingroup world
+ * @param seed the new state of the generator
+ * @remarks Every world has a generator of its own, so worlds that are
+ * stepped from different threads do not affect each other.
+ */
+ODE_API void dWorldSetQuickStepRandomSeed (dWorldID, unsigned long seed);
+
+/**
+ * @brief Get the state of the random number generator that the QuickStep
+ *        method uses to reorder the constraints.
+ * @ingroup world
+ * @returns the current state of the generator
+ */
+ODE_API unsigned long dWorldGetQuickStepRandomSeed (dWorldID);
+
+/**
+ * @brief Set the number of threads that step the islands of the world.
+ * @ingroup world
+ * @param count the number of threads, including the one that steps the
+ * world. With 0 (the default), the islands are stepped one after the other
+ * as they are found.
+ * @remarks With a count of 1 or more, all the islands are found first, and
+ * each one gets its own QuickStep random generator state, derived from the
+ * one of the world. The islands are then handed out to the threads. Since
+ * the islands don't share any body or joint, the results are the same for
+ * any count of 1 or more, but they differ from those of a count of 0.
+ */
+ODE_API void dWorldSetIslandThreads (dWorldID, int count);
+
+/**
+ * @brief Get the number of threads that step the islands of the world.
+ * @ingroup world
+ * @returns the number of threads, 0 if the islands are stepped one after
+ * the other
+ */
+ODE_API int dWorldGetIslandThreads (dWorldID);
+
 /* World contact parameter functions */
 
 /**
@@ -560,6 +600,25 @@ ODE_API void dBodySetAutoDisableFlag (dBodyID, int do_auto_disable);
  */
 ODE_API void  dBodySetAutoDisableDefaults (dBodyID);
 
+/**
+ * @brief Get the idle timers of the auto-disable logic.
+ * @remarks LOCAL PATCH (cartwheel-3d). Along with the enabled flag, this is
+ * the state the auto-disable logic keeps for a body, so saving and setting it
+ * back lets a simulation be restored exactly. The velocity samples are not
+ * included: with a single sample, they are always taken again before they
+ * are used.
+ * @ingroup bodies
+ */
+ODE_API void dBodyGetAutoDisableTimers (dBodyID, dReal *time_left, int *steps_left, int *average_ready);
+
+/**
+ * @brief Set the idle timers of the auto-disable logic.
+ * @remarks LOCAL PATCH (cartwheel-3d). This should be called after the body
+ * is enabled or disabled, since dBodyEnable resets the timers.
+ * @ingroup bodies
+ */
+ODE_API void dBodySetAutoDisableTimers (dBodyID, dReal time_left, int steps_left, int average_ready);
+
 
 /**
  * @brief Retrives the world attached to te given body.
@@ -31,9 +31,11 @@
 #include "collision_space_internal.h"
 
 
-#define AXIS0 0
-#define AXIS1 1
-#define UP 2
+// LOCAL PATCH (cartwheel-3d): the up axis is no longer hard-coded here. Every block keeps the two axes
+// it splits, and the up axis is passed to dQuadTreeSpaceCreateUp (dQuadTreeSpaceCreate keeps z up).
+#define AXIS0 Axis0
+#define AXIS1 Axis1
+#define UP Up
 
 //#define DRAWBLOCKS
 
@@ -47,13 +49,16 @@ public:
 	dReal MinX, MaxX;
 	dReal MinZ, MaxZ;
 
+	// LOCAL PATCH (cartwheel-3d): the axes that MinX/MaxX and MinZ/MaxZ are measured along, and the up axis
+	int Axis0, Axis1, Up;
+
 	dGeomID First;
 	int GeomCount;
 
 	Block* Parent;
 	Block* Children;
 
-	void Create(const dVector3 Center, const dVector3 Extents, Block* Parent, int Depth, Block*& Blocks);
+	void Create(const dVector3 Center, const dVector3 Extents, Block* Parent, int Depth, Block*& Blocks, int UpAxis);
 
 	void Collide(void* UserData, dNearCallback* Callback);
 	void Collide(dGeomID Object, dGeomID g, void* UserData, dNearCallback* Callback);
@@ -75,6 +80,7 @@ public:
 #include "..\..\Include\drawstuff\\drawstuff.h"
 
 static void DrawBlock(Block* Block){
+	int Axis0 = Block->Axis0, Axis1 = Block->Axis1, Up = Block->Up;
 	dVector3 v[8];
 	v[0][AXIS0] = Block->MinX;
 	v[0][UP] = REAL(-1.0);
@@ -129,10 +135,14 @@ static void DrawBlock(Block* Block){
 #endif	//DRAWBLOCKS
 
 
-void Block::Create(const dVector3 Center, const dVector3 Extents, Block* Parent, int Depth, Block*& Blocks){
+void Block::Create(const dVector3 Center, const dVector3 Extents, Block* Parent, int Depth, Block*& Blocks, int UpAxis){
 	GeomCount = 0;
 	First = 0;
 
+	Up = UpAxis;
+	Axis0 = (UpAxis == 0) ? 1 : 0;
+	Axis1 = (UpAxis == 2) ? 1 : 2;
+
 	MinX = Center[AXIS0] - Extents[AXIS0];
 	MaxX = Center[AXIS0] + Extents[AXIS0];
 
@@ -158,7 +168,7 @@ void Block::Create(const dVector3 Center, const dVector3 Extents, Block* Parent,
 				ChildCenter[AXIS1] = Center[AXIS1] - Extents[AXIS1] + ChildExtents[AXIS1] + j * (ChildExtents[AXIS1] * 2);
 				ChildCenter[UP] = Center[UP];
 				
-				Children[Index].Create(ChildCenter, ChildExtents, this, Depth - 1, Blocks);
+				Children[Index].Create(ChildCenter, ChildExtents, this, Depth - 1, Blocks, UpAxis);
 			}
 		}
 	}
@@ -323,7 +333,7 @@ struct dxQuadTreeSpace : public dxSpace{
 
 	dArray<dxGeom*> DirtyList;
 
-	dxQuadTreeSpace(dSpaceID _space, dVector3 Center, dVector3 Extents, int Depth);
+	dxQuadTreeSpace(dSpaceID _space, dVector3 Center, dVector3 Extents, int Depth, int UpAxis);
 	~dxQuadTreeSpace();
 
 	dxGeom* getGeom(int i);
@@ -346,7 +356,7 @@ struct dxQuadTreeSpace : public dxSpace{
 	int CurrentIndex;
 };
 
-dxQuadTreeSpace::dxQuadTreeSpace(dSpaceID _space, dVector3 Center, dVector3 Extents, int Depth) : dxSpace(_space){
+dxQuadTreeSpace::dxQuadTreeSpace(dSpaceID _space, dVector3 Center, dVector3 Extents, int Depth, int UpAxis) : dxSpace(_space){
 	type = dQuadTreeSpaceClass;
 
 	int BlockCount = 0;
@@ -357,7 +367,7 @@ dxQuadTreeSpace::dxQuadTreeSpace(dSpaceID _space, dVector3 Center, dVector3 Exte
 	Blocks = (Block*)dAlloc(BlockCount * sizeof(Block));
 	Block* Blocks = this->Blocks + 1;	// This pointer gets modified!
 
-	this->Blocks[0].Create(Center, Extents, 0, Depth, Blocks);
+	this->Blocks[0].Create(Center, Extents, 0, Depth, Blocks, UpAxis);
 
 	CurrentBlock = 0;
 	CurrentChild = (int*)dAlloc((Depth + 1) * sizeof(int));
@@ -580,5 +590,11 @@ void dxQuadTreeSpace::collide2(void* UserData, dxGeom* g1, dNearCallback* Callba
 }
 
 dSpaceID dQuadTreeSpaceCreate(dxSpace* space, dVector3 Center, dVector3 Extents, int Depth){
-	return new dxQuadTreeSpace(space, Center, Extents, Depth);
+	return new dxQuadTreeSpace(space, Center, Extents, Depth, 2);
+}
+
+// LOCAL PATCH (cartwheel-3d): same as dQuadTreeSpaceCreate, but the tree splits the plane perpendicular to UpAxis (0, 1 or 2)
+dSpaceID dQuadTreeSpaceCreateUp(dxSpace* space, dVector3 Center, dVector3 Extents, int Depth, int UpAxis){
+	dUASSERT(UpAxis >= 0 && UpAxis <= 2, "bad up axis");
+	return new dxQuadTreeSpace(space, Center, Extents, Depth, UpAxis);
 }
@@ -0,0 +1,202 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001-2003 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+/*
+
+sweep and prune space
+
+the geoms are kept in an array that is sorted by the lower bound of their AABB
+along one axis. two geoms can only overlap if their intervals along that axis
+overlap, so for every geom only the ones that start before it ends need to be
+looked at. the order of the previous call is kept, and since most geoms only
+move a little from one call to the next, the insertion sort that restores the
+order is close to linear.
+
+*/
+
+#include <ode/common.h>
+#include <ode/matrix.h>
+#include <ode/collision_space.h>
+#include <ode/collision.h>
+#include "collision_kernel.h"
+#include "array.h"
+
+#include "collision_space_internal.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable:4291)  // for VC++, no complaints about "no matching operator delete found"
+#endif
+
+#define GEOM_ENABLED(g) ((g)->gflags & GEOM_ENABLED)
+
+//****************************************************************************
+// sweep and prune space
+
+struct dxSAPSpace : public dxSpace {
+  int axis;			// the axis the geoms are sorted along (0..2)
+  dArray<dxGeom*> sorted;	// the geoms, sorted by the lower bound of their AABB
+  int sorted_valid;		// 0 if geoms were added or removed since the
+				// sorted array was last built
+
+  dxSAPSpace (dSpaceID _space, int axisorder);
+  void add (dxGeom *);
+  void remove (dxGeom *);
+  void cleanGeoms();
+  void collide (void *data, dNearCallback *callback);
+  void collide2 (void *data, dxGeom *geom, dNearCallback *callback);
+
+  void sortGeoms();
+};
+
+
+dxSAPSpace::dxSAPSpace (dSpaceID _space, int axisorder) : dxSpace (_space)
+{
+  type = dSweepAndPruneSpaceClass;
+  // only the first axis of the order is used for sorting, the other two are
+  // tested by collideAABBs
+  axis = axisorder & 3;
+  dUASSERT (axis <= 2,"invalid axis order");
+  sorted_valid = 0;
+}
+
+
+void dxSAPSpace::add (dxGeom *geom)
+{
+  dxSpace::add (geom);
+  sorted_valid = 0;
+}
+
+
+void dxSAPSpace::remove (dxGeom *geom)
+{
+  dxSpace::remove (geom);
+  sorted_valid = 0;
+}
+
+
+void dxSAPSpace::cleanGeoms()
+{
+  // compute the AABBs of all dirty geoms, and clear the dirty flags
+  lock_count++;
+  for (dxGeom *g=first; g && (g->gflags & GEOM_DIRTY); g=g->next) {
+    if (IS_SPACE(g)) {
+      ((dxSpace*)g)->cleanGeoms();
+    }
+    g->recomputeAABB();
+    g->gflags &= (~(GEOM_DIRTY|GEOM_AABB_BAD));
+  }
+  lock_count--;
+}
+
+
+// bring the sorted array up to date. this assumes that the AABBs are valid.
+
+void dxSAPSpace::sortGeoms()
+{
+  if (!sorted_valid) {
+    sorted.setSize (0);
+    for (dxGeom *g=first; g; g=g->next) sorted.push (g);
+    sorted_valid = 1;
+  }
+
+  // insertion sort, starting from the order of the previous call
+  int lo = axis*2;
+  int n = sorted.size();
+  dxGeom **a = sorted.data();
+  for (int i=1; i<n; i++) {
+    dxGeom *g = a[i];
+    dReal key = g->aabb[lo];
+    int j = i-1;
+    while (j >= 0 && a[j]->aabb[lo] > key) {
+      a[j+1] = a[j];
+      j--;
+    }
+    a[j+1] = g;
+  }
+}
+
+
+void dxSAPSpace::collide (void *data, dNearCallback *callback)
+{
+  dAASSERT (callback);
+
+  lock_count++;
+  cleanGeoms();
+  sortGeoms();
+
+  // sweep along the axis. a geom with an infinite AABB (e.g. a plane) comes
+  // first and is tested against everything, as it should be
+  int lo = axis*2, hi = axis*2+1;
+  int n = sorted.size();
+  dxGeom **a = sorted.data();
+  for (int i=0; i<n; i++) {
+    dxGeom *g1 = a[i];
+    if (!GEOM_ENABLED(g1)) continue;
+    dReal end = g1->aabb[hi];
+    for (int j=i+1; j<n; j++) {
+      dxGeom *g2 = a[j];
+      // none of the geoms that follow start before g1 ends
+      if (g2->aabb[lo] > end) break;
+      if (GEOM_ENABLED(g2)) {
+	collideAABBs (g1,g2,data,callback);
+      }
+    }
+  }
+
+  lock_count--;
+}
+
+
+void dxSAPSpace::collide2 (void *data, dxGeom *geom,
+			   dNearCallback *callback)
+{
+  dAASSERT (geom && callback);
+
+  lock_count++;
+  cleanGeoms();
+  geom->recomputeAABB();
+  sortGeoms();
+
+  int lo = axis*2, hi = axis*2+1;
+  dReal start = geom->aabb[lo];
+  dReal end = geom->aabb[hi];
+  int n = sorted.size();
+  dxGeom **a = sorted.data();
+  for (int i=0; i<n; i++) {
+    dxGeom *g = a[i];
+    if (g->aabb[lo] > end) break;
+    if (g->aabb[hi] < start) continue;
+    if (GEOM_ENABLED(g)) {
+      collideAABBs (g,geom,data,callback);
+    }
+  }
+
+  lock_count--;
+}
+
+//****************************************************************************
+// space functions
+
+dxSpace *dSweepAndPruneSpaceCreate (dxSpace *space, int axisorder)
+{
+  return new dxSAPSpace (space, axisorder);
+}
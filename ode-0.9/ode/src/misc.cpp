@@ -31,8 +31,14 @@ static unsigned long seed = 0;
 
 unsigned long dRand()
 {
-  seed = (1664525L*seed + 1013904223L) & 0xffffffff;
-  return seed;
+  return dRandWithSeed (&seed);
+}
+
+
+unsigned long dRandWithSeed (unsigned long *s)
+{
+  *s = (1664525L*(*s) + 1013904223L) & 0xffffffff;
+  return *s;
 }
 
 
@@ -63,10 +69,16 @@ int dTestRand()
 
 // adam's all-int straightforward(?) dRandInt (0..n-1)
 int dRandInt (int n)
+{
+  return dRandIntWithSeed (&seed,n);
+}
+
+
+int dRandIntWithSeed (unsigned long *s, int n)
 {
   // seems good; xor-fold and modulus
   const unsigned long un = n;
-  unsigned long r = dRand();
+  unsigned long r = dRandWithSeed (s);
   
   // note: probably more aggressive than it needs to be -- might be
   //       able to get away without one or two of the innermost branches.
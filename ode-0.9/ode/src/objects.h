@@ -78,6 +78,7 @@ struct dxAutoDisable {
 struct dxQuickStepParameters {
   int num_iterations;		// number of SOR iterations to perform
   dReal w;			// the SOR over-relaxation parameter
+  unsigned long random_seed;	// state of the generator used to reorder the constraints
 };
 
 
@@ -132,6 +133,9 @@ struct dxWorld : public dBase {
   int adis_flag;		// auto-disable flag for new bodies
   dxQuickStepParameters qs;
   dxContactParameters contactp;
+  int island_threads;		// number of threads that step the islands, 0 to step them one after the other
+  struct dxThreadPool *island_pool;	// the worker threads, created when they are first needed
+  int defer_geom_moves;		// set while the islands are stepped in parallel
 };
 
 
@@ -35,6 +35,7 @@
 #include "step.h"
 #include "quickstep.h"
 #include "util.h"
+#include "threadpool.h"
 #include <ode/memory.h>
 #include <ode/error.h>
 
@@ -995,6 +996,26 @@ void dBodySetAutoDisableDefaults (dBodyID b)
 	dBodySetAutoDisableFlag (b, w->adis_flag);
 }
 
+
+// LOCAL PATCH (cartwheel-3d): access to the idle timers, for exact save/restore
+void dBodyGetAutoDisableTimers (dBodyID b, dReal *time_left, int *steps_left, int *average_ready)
+{
+	dAASSERT(b && time_left && steps_left && average_ready);
+	*time_left = b->adis_timeleft;
+	*steps_left = b->adis_stepsleft;
+	*average_ready = b->average_ready;
+}
+
+
+void dBodySetAutoDisableTimers (dBodyID b, dReal time_left, int steps_left, int average_ready)
+{
+	dAASSERT(b);
+	b->adis_timeleft = time_left;
+	b->adis_stepsleft = steps_left;
+	b->average_ready = average_ready;
+	b->average_counter = 0;
+}
+
 //****************************************************************************
 // joints
 
@@ -1372,10 +1393,15 @@ dxWorld * dWorldCreate()
 
   w->qs.num_iterations = 20;
   w->qs.w = REAL(1.3);
+  w->qs.random_seed = 0;
 
   w->contactp.max_vel = dInfinity;
   w->contactp.min_depth = 0;
 
+  w->island_threads = 0;
+  w->island_pool = 0;
+  w->defer_geom_moves = 0;
+
   return w;
 }
 
@@ -1417,6 +1443,7 @@ void dWorldDestroy (dxWorld *w)
     }
     j = nextj;
   }
+  dxThreadPoolDestroy (w->island_pool);
   delete w;
 }
 
@@ -1467,7 +1494,8 @@ dReal dWorldGetCFM (dWorldID w)
 }
 
 void runTest (dxWorld *world, dxBody * const *body, int nb,
-			  dxJoint * const *joint, int nj, dReal stepsize);
+			  dxJoint * const *joint, int nj, dReal stepsize,
+			  unsigned long *random_seed);
 
 void runTestStep(dWorldID w, dReal stepsize){
   dUASSERT (w,"bad world argument");
@@ -1618,6 +1646,35 @@ dReal dWorldGetQuickStepW (dWorldID w)
 }
 
 
+void dWorldSetQuickStepRandomSeed (dWorldID w, unsigned long seed)
+{
+	dAASSERT(w);
+	w->qs.random_seed = seed;
+}
+
+
+unsigned long dWorldGetQuickStepRandomSeed (dWorldID w)
+{
+	dAASSERT(w);
+	return w->qs.random_seed;
+}
+
+
+void dWorldSetIslandThreads (dWorldID w, int count)
+{
+	dAASSERT(w);
+	dUASSERT (count >= 0,"the thread count must be >= 0");
+	w->island_threads = count;
+}
+
+
+int dWorldGetIslandThreads (dWorldID w)
+{
+	dAASSERT(w);
+	return w->island_threads;
+}
+
+
 void dWorldSetContactMaxCorrectingVel (dWorldID w, dReal vel)
 {
 	dAASSERT(w);
@@ -465,7 +465,7 @@ static void SOR_LCP (int m, int nb, dRealMutablePtr J, int *jb, dxBody * const *
 		if ((iteration & 7) == 0) {
 			for (i=1; i<m; ++i) {
 				IndexError tmp = order[i];
-				int swapi = dRandInt(i+1);
+				int swapi = dRandIntWithSeed(&qs->random_seed,i+1);
 				order[i] = order[swapi];
 				order[swapi] = tmp;
 			}
@@ -558,7 +558,8 @@ static void SOR_LCP (int m, int nb, dRealMutablePtr J, int *jb, dxBody * const *
 
 
 void dxQuickStepper (dxWorld *world, dxBody * const *body, int nb,
-		     dxJoint * const *_joint, int nj, dReal stepsize)
+		     dxJoint * const *_joint, int nj, dReal stepsize,
+		     unsigned long *random_seed)
 {
 	int i,j;
 	IFTIMING(dTimerStart("preprocessing");)
@@ -749,7 +750,13 @@ void dxQuickStepper (dxWorld *world, dxBody * const *body, int nb,
 		// solve the LCP problem and get lambda and invM*constraint_force
 		IFTIMING (dTimerNow ("solving LCP problem");)
 		dRealAllocaArray (cforce,nb*6);
-		SOR_LCP (m,nb,J,jb,body,invI,lambda,cforce,rhs,lo,hi,cfm,findex,&world->qs);
+		// the constraints are reordered with the generator state of the
+		// island, which is not the one of the world when the islands are
+		// stepped in parallel
+		dxQuickStepParameters qs = world->qs;
+		qs.random_seed = *random_seed;
+		SOR_LCP (m,nb,J,jb,body,invI,lambda,cforce,rhs,lo,hi,cfm,findex,&qs);
+		*random_seed = qs.random_seed;
 
 #ifdef WARM_STARTING
 		// save lambda for the next iteration
@@ -27,7 +27,8 @@
 
 
 void dxQuickStepper (dxWorld *world, dxBody * const *body, int nb,
-		     dxJoint * const *_joint, int nj, dReal stepsize);
+		     dxJoint * const *_joint, int nj, dReal stepsize,
+		     unsigned long *random_seed);
 
 
 #endif
@@ -1725,7 +1725,8 @@ void dInternalStepIsland_x2 (dxWorld *world, dxBody * const *body, int nb,
 }
 
 void dInternalStepIsland (dxWorld *world, dxBody * const *body, int nb,
-			  dxJoint * const *joint, int nj, dReal stepsize)
+			  dxJoint * const *joint, int nj, dReal stepsize,
+			  unsigned long *random_seed)
 {
 
 #ifdef dUSE_MALLOC_FOR_ALLOCA
@@ -2614,7 +2615,8 @@ void testODESpeed (dxWorld *world, dxBody * const *body, int nb,
 
 
 void runTest (dxWorld *world, dxBody * const *body, int nb,
-			  dxJoint * const *joint, int nj, dReal stepsize){
+			  dxJoint * const *joint, int nj, dReal stepsize,
+			  unsigned long *random_seed){
 	testODESpeed(world,body,nb,joint,nj,stepsize);
 }
 
@@ -29,7 +29,7 @@
 void dInternalStepIsland (dxWorld *world,
 			  dxBody * const *body, int nb,
 			  dxJoint * const *joint, int nj,
-			  dReal stepsize);
+			  dReal stepsize, unsigned long *random_seed);
 
 
 
@@ -0,0 +1,276 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#include <ode/common.h>
+#include <ode/error.h>
+#include <ode/memory.h>
+#include "threadpool.h"
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+//****************************************************************************
+// the pool
+
+struct dxThreadPool {
+  int thread_count;		// number of worker threads
+  int thread_alloc;		// size of the threads array
+  volatile int quit;		// set when the workers must exit
+
+  // the job that is currently run
+  dthreadjob_fn_t job;
+  void *context;
+  int count;
+
+#if defined(WIN32) || defined(_WIN32)
+  HANDLE *threads;
+  HANDLE start;			// semaphore, released once per worker for every job
+  HANDLE done;			// event, set by the last worker to finish the job
+  volatile LONG next;		// the next index to hand out
+  volatile LONG running;	// number of workers that haven't finished the job
+#else
+  pthread_t *threads;
+  pthread_mutex_t mutex;
+  pthread_cond_t start;		// signaled when a new job is started
+  pthread_cond_t done;		// signaled by the last worker to finish the job
+  unsigned long generation;	// number of jobs started so far
+  int next;			// the next index to hand out
+  int running;			// number of workers that haven't finished the job
+#endif
+};
+
+
+// hand out the next index of the current job, or -1 if there are none left
+
+static int nextIndex (dxThreadPool *pool)
+{
+#if defined(WIN32) || defined(_WIN32)
+  int i = (int) InterlockedIncrement (&pool->next) - 1;
+#else
+  pthread_mutex_lock (&pool->mutex);
+  int i = pool->next++;
+  pthread_mutex_unlock (&pool->mutex);
+#endif
+  return (i < pool->count) ? i : -1;
+}
+
+
+static void runJob (dxThreadPool *pool)
+{
+  for (int i = nextIndex (pool); i >= 0; i = nextIndex (pool))
+    pool->job (pool->context,i);
+}
+
+//****************************************************************************
+// windows threads
+
+#if defined(WIN32) || defined(_WIN32)
+
+static DWORD WINAPI workerMain (LPVOID param)
+{
+  dxThreadPool *pool = (dxThreadPool*) param;
+  for (;;) {
+    WaitForSingleObject (pool->start,INFINITE);
+    if (pool->quit) break;
+    runJob (pool);
+    if (InterlockedDecrement (&pool->running) == 0) SetEvent (pool->done);
+  }
+  return 0;
+}
+
+
+static int startThreads (dxThreadPool *pool, int stack_size)
+{
+  pool->next = 0;
+  pool->running = 0;
+  pool->start = CreateSemaphore (NULL,0,pool->thread_count,NULL);
+  pool->done = CreateEvent (NULL,FALSE,FALSE,NULL);
+  if (!pool->start || !pool->done) return 0;
+  pool->thread_alloc = pool->thread_count;
+  pool->threads = (HANDLE*) dAlloc (pool->thread_alloc * sizeof(HANDLE));
+  for (int i=0; i<pool->thread_count; i++) {
+    pool->threads[i] = CreateThread (NULL,stack_size,&workerMain,pool,
+				     STACK_SIZE_PARAM_IS_A_RESERVATION,NULL);
+    if (!pool->threads[i]) {
+      // only keep the threads that could be started
+      pool->thread_count = i;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+
+static void stopThreads (dxThreadPool *pool)
+{
+  pool->quit = 1;
+  if (pool->thread_count > 0)
+    ReleaseSemaphore (pool->start,pool->thread_count,NULL);
+  for (int i=0; i<pool->thread_count; i++) {
+    WaitForSingleObject (pool->threads[i],INFINITE);
+    CloseHandle (pool->threads[i]);
+  }
+  if (pool->threads) dFree (pool->threads,pool->thread_alloc * sizeof(HANDLE));
+  if (pool->start) CloseHandle (pool->start);
+  if (pool->done) CloseHandle (pool->done);
+}
+
+
+static void runOnThreads (dxThreadPool *pool)
+{
+  pool->next = 0;
+  pool->running = pool->thread_count;
+  ReleaseSemaphore (pool->start,pool->thread_count,NULL);
+  runJob (pool);
+  WaitForSingleObject (pool->done,INFINITE);
+}
+
+//****************************************************************************
+// posix threads
+
+#else
+
+static void *workerMain (void *param)
+{
+  dxThreadPool *pool = (dxThreadPool*) param;
+  unsigned long seen = 0;
+  pthread_mutex_lock (&pool->mutex);
+  for (;;) {
+    while (pool->generation == seen && !pool->quit)
+      pthread_cond_wait (&pool->start,&pool->mutex);
+    if (pool->quit) break;
+    seen = pool->generation;
+    pthread_mutex_unlock (&pool->mutex);
+    runJob (pool);
+    pthread_mutex_lock (&pool->mutex);
+    if (--pool->running == 0) pthread_cond_signal (&pool->done);
+  }
+  pthread_mutex_unlock (&pool->mutex);
+  return 0;
+}
+
+
+static int startThreads (dxThreadPool *pool, int stack_size)
+{
+  pool->generation = 0;
+  pool->next = 0;
+  pool->running = 0;
+  pthread_mutex_init (&pool->mutex,NULL);
+  pthread_cond_init (&pool->start,NULL);
+  pthread_cond_init (&pool->done,NULL);
+  pool->thread_alloc = pool->thread_count;
+  pool->threads = (pthread_t*) dAlloc (pool->thread_alloc * sizeof(pthread_t));
+  pthread_attr_t attr;
+  pthread_attr_init (&attr);
+  pthread_attr_setstacksize (&attr,stack_size);
+  for (int i=0; i<pool->thread_count; i++) {
+    if (pthread_create (pool->threads+i,&attr,&workerMain,pool) != 0) {
+      // only keep the threads that could be started
+      pool->thread_count = i;
+      pthread_attr_destroy (&attr);
+      return 0;
+    }
+  }
+  pthread_attr_destroy (&attr);
+  return 1;
+}
+
+
+static void stopThreads (dxThreadPool *pool)
+{
+  pthread_mutex_lock (&pool->mutex);
+  pool->quit = 1;
+  pthread_cond_broadcast (&pool->start);
+  pthread_mutex_unlock (&pool->mutex);
+  for (int i=0; i<pool->thread_count; i++)
+    pthread_join (pool->threads[i],NULL);
+  if (pool->threads) dFree (pool->threads,pool->thread_alloc * sizeof(pthread_t));
+  pthread_cond_destroy (&pool->done);
+  pthread_cond_destroy (&pool->start);
+  pthread_mutex_destroy (&pool->mutex);
+}
+
+
+static void runOnThreads (dxThreadPool *pool)
+{
+  pthread_mutex_lock (&pool->mutex);
+  pool->next = 0;
+  pool->running = pool->thread_count;
+  pool->generation++;
+  pthread_cond_broadcast (&pool->start);
+  pthread_mutex_unlock (&pool->mutex);
+  runJob (pool);
+  pthread_mutex_lock (&pool->mutex);
+  while (pool->running > 0)
+    pthread_cond_wait (&pool->done,&pool->mutex);
+  pthread_mutex_unlock (&pool->mutex);
+}
+
+#endif
+
+//****************************************************************************
+// public functions
+
+dxThreadPool *dxThreadPoolCreate (int thread_count, int stack_size)
+{
+  dIASSERT (thread_count > 0);
+  dxThreadPool *pool = (dxThreadPool*) dAlloc (sizeof(dxThreadPool));
+  memset (pool,0,sizeof(dxThreadPool));
+  pool->thread_count = thread_count;
+  if (!startThreads (pool,stack_size)) {
+    dxThreadPoolDestroy (pool);
+    return 0;
+  }
+  return pool;
+}
+
+
+void dxThreadPoolDestroy (dxThreadPool *pool)
+{
+  if (!pool) return;
+  stopThreads (pool);
+  dFree (pool,sizeof(dxThreadPool));
+}
+
+
+int dxThreadPoolGetThreadCount (dxThreadPool *pool)
+{
+  return pool ? pool->thread_count : 0;
+}
+
+
+void dxThreadPoolRun (dxThreadPool *pool, int count, dthreadjob_fn_t job,
+		      void *context)
+{
+  if (count <= 0) return;
+  if (!pool || pool->thread_count == 0 || count == 1) {
+    for (int i=0; i<count; i++) job (context,i);
+    return;
+  }
+  pool->job = job;
+  pool->context = context;
+  pool->count = count;
+  runOnThreads (pool);
+}
@@ -0,0 +1,59 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+/*
+
+a small pool of worker threads, used to step the islands of a world at the
+same time.
+
+a job is a function that is called once for every index in 0..count-1. the
+indices are handed out to the workers and to the calling thread as they
+become free, and dxThreadPoolRun() only returns once all of them have been
+processed. the job must not care which thread processes which index.
+
+*/
+
+#ifndef _ODE_THREADPOOL_H_
+#define _ODE_THREADPOOL_H_
+
+
+struct dxThreadPool;
+
+typedef void (*dthreadjob_fn_t) (void *context, int index);
+
+
+// create a pool with the given number of worker threads, in addition to the
+// thread that runs the jobs. every worker gets a stack of stack_size bytes:
+// the steppers allocate all their temporary matrices on the stack. returns 0
+// if the threads can't be created.
+
+dxThreadPool *dxThreadPoolCreate (int thread_count, int stack_size);
+
+void dxThreadPoolDestroy (dxThreadPool *pool);
+
+int dxThreadPoolGetThreadCount (dxThreadPool *pool);
+
+void dxThreadPoolRun (dxThreadPool *pool, int count, dthreadjob_fn_t job,
+		      void *context);
+
+
+#endif
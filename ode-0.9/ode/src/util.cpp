@@ -24,6 +24,7 @@
 #include "objects.h"
 #include "joint.h"
 #include "util.h"
+#include "threadpool.h"
 
 #define ALLOCA dALLOCA16
 
@@ -255,14 +256,66 @@ void dxStepBody (dxBody *b, dReal h)
   dNormalize4 (b->q);
   dQtoR (b->q,b->posr.R);
 
-  // notify all attached geoms that this body has moved
-  for (dxGeom *geom = b->geom; geom; geom = dGeomGetBodyNext (geom))
-    dGeomMoved (geom);
+  // notify all attached geoms that this body has moved, unless the islands
+  // are stepped in parallel: dxProcessIslands() then does it once they are
+  // all done
+  if (!b->world->defer_geom_moves)
+    for (dxGeom *geom = b->geom; geom; geom = dGeomGetBodyNext (geom))
+      dGeomMoved (geom);
 }
 
 //****************************************************************************
 // island processing
 
+// the worker threads get large stacks, since the steppers allocate all their
+// temporary matrices with alloca
+#define ISLAND_THREAD_STACK_SIZE (16*1024*1024)
+
+// what the threads need to step the islands that are handed out to them
+
+struct dxIslandJob {
+  dxWorld *world;
+  dReal stepsize;
+  dstepper_fn_t stepper;
+  dxBody **body;		// the bodies of all the islands
+  dxJoint **joint;		// the joints of all the islands
+  int *bstart;			// island i is body[bstart[i]..bstart[i+1]-1]
+  int *jstart;			// and joint[jstart[i]..jstart[i+1]-1]
+  unsigned long *seed;		// the random generator state of every island
+};
+
+
+static void stepIsland (void *context, int i)
+{
+  dxIslandJob *job = (dxIslandJob*) context;
+  job->stepper (job->world,job->body + job->bstart[i],
+		job->bstart[i+1] - job->bstart[i],job->joint + job->jstart[i],
+		job->jstart[i+1] - job->jstart[i],job->stepsize,job->seed + i);
+}
+
+
+// get the threads that step the islands of the world, (re)starting them if
+// the thread count was changed. the calling thread is one of them.
+
+static dxThreadPool *getIslandPool (dxWorld *world)
+{
+  int workers = world->island_threads - 1;
+  if (dxThreadPoolGetThreadCount (world->island_pool) != workers) {
+    dxThreadPoolDestroy (world->island_pool);
+    world->island_pool = 0;
+    if (workers > 0) {
+      world->island_pool = dxThreadPoolCreate (workers,ISLAND_THREAD_STACK_SIZE);
+      if (!world->island_pool) {
+	dMessage (0,"could not start the island threads, stepping the "
+		  "islands on one thread");
+	world->island_threads = 1;
+      }
+    }
+  }
+  return world->island_pool;
+}
+
+
 // this groups all joints and bodies in a world into islands. all objects
 // in an island are reachable by going through connected bodies and joints.
 // each island can be simulated separately.
@@ -273,11 +326,18 @@ void dxStepBody (dxBody *b, dReal h)
 // never start a new islands from a disabled body. thus islands of disabled
 // bodies will not be included in the simulation. disabled bodies are
 // re-enabled if they are found to be part of an active island.
+//
+// all the islands are found before any of them is stepped. if the world
+// has island threads, the islands are then handed out to the threads, and
+// every island gets a random generator state of its own. these states are
+// drawn from the one of the world in the order the islands were found, so
+// the results don't depend on which thread steps which island.
 
 void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
 {
   dxBody *b,*bb,**body;
   dxJoint *j,**joint;
+  int i;
 
   // nothing to do if no bodies
   if (world->nb <= 0) return;
@@ -285,11 +345,15 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
   // handle auto-disabling of bodies
   dInternalHandleAutoDisabling (world,stepsize);
 
-  // make arrays for body and joint lists (for a single island) to go into
+  // make arrays for the body and joint lists of all the islands to go into.
+  // the lists of island i start at bstart[i] and jstart[i].
   body = (dxBody**) ALLOCA (world->nb * sizeof(dxBody*));
   joint = (dxJoint**) ALLOCA (world->nj * sizeof(dxJoint*));
+  int *bstart = (int*) ALLOCA ((world->nb + 1) * sizeof(int));
+  int *jstart = (int*) ALLOCA ((world->nb + 1) * sizeof(int));
   int bcount = 0;	// number of bodies in `body'
   int jcount = 0;	// number of joints in `joint'
+  int icount = 0;	// number of islands
 
   // set all body/joint tags to 0
   for (b=world->firstbody; b; b=(dxBody*)b->next) b->tag = 0;
@@ -310,9 +374,10 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
     // tag all bodies and joints starting from bb.
     int stacksize = 0;
     b = bb;
-    body[0] = bb;
-    bcount = 1;
-    jcount = 0;
+    bstart[icount] = bcount;
+    jstart[icount] = jcount;
+    icount++;
+    body[bcount++] = bb;
     goto quickstart;
     while (stacksize > 0) {
       b = stack[--stacksize];	// pop body off stack
@@ -334,20 +399,47 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
       dIASSERT(stacksize <= world->nb);
       dIASSERT(stacksize <= world->nj);
     }
+  }
+  bstart[icount] = bcount;
+  jstart[icount] = jcount;
+
+  // now do something with body and joint lists
+  if (world->island_threads == 0) {
+    for (i=0; i<icount; i++)
+      stepper (world,body + bstart[i],bstart[i+1] - bstart[i],
+	       joint + jstart[i],jstart[i+1] - jstart[i],stepsize,
+	       &world->qs.random_seed);
+  }
+  else {
+    dxIslandJob job;
+    job.world = world;
+    job.stepsize = stepsize;
+    job.stepper = stepper;
+    job.body = body;
+    job.joint = joint;
+    job.bstart = bstart;
+    job.jstart = jstart;
+    job.seed = (unsigned long*) ALLOCA (icount * sizeof(unsigned long));
+    for (i=0; i<icount; i++) job.seed[i] = dRandWithSeed (&world->qs.random_seed);
+
+    // the islands share the spaces of their geoms, so the geoms are only
+    // told that their bodies moved once all the islands are stepped
+    world->defer_geom_moves = 1;
+    dxThreadPoolRun (getIslandPool (world),icount,&stepIsland,&job);
+    world->defer_geom_moves = 0;
+    for (i=0; i<bcount; i++)
+      for (dxGeom *geom = body[i]->geom; geom; geom = dGeomGetBodyNext (geom))
+	dGeomMoved (geom);
+  }
 
-    // now do something with body and joint lists
-    stepper (world,body,bcount,joint,jcount,stepsize);
-
-    // what we've just done may have altered the body/joint tag values.
-    // we must make sure that these tags are nonzero.
-    // also make sure all bodies are in the enabled state.
-    int i;
-    for (i=0; i<bcount; i++) {
-      body[i]->tag = 1;
-      body[i]->flags &= ~dxBodyDisabled;
-    }
-    for (i=0; i<jcount; i++) joint[i]->tag = 1;
+  // what we've just done may have altered the body/joint tag values.
+  // we must make sure that these tags are nonzero.
+  // also make sure all bodies are in the enabled state.
+  for (i=0; i<bcount; i++) {
+    body[i]->tag = 1;
+    body[i]->flags &= ~dxBodyDisabled;
   }
+  for (i=0; i<jcount; i++) joint[i]->tag = 1;
 
   // if debugging, check that all objects (except for disabled bodies,
   // unconnected joints, and joints that are connected to disabled bodies)
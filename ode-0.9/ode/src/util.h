@@ -29,8 +29,13 @@
 void dInternalHandleAutoDisabling (dxWorld *world, dReal stepsize);
 void dxStepBody (dxBody *b, dReal h);
 
+// a stepper steps one island. it may use the random generator state that is
+// passed in, which is the one of the world unless the islands are stepped in
+// parallel. steppers only touch the bodies and joints of their island, so
+// several islands can be stepped at the same time.
 typedef void (*dstepper_fn_t) (dxWorld *world, dxBody * const *body, int nb,
-        dxJoint * const *_joint, int nj, dReal stepsize);
+        dxJoint * const *_joint, int nj, dReal stepsize,
+        unsigned long *random_seed);
 
 void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper);
 